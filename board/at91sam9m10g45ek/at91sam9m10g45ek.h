@@ -96,6 +96,9 @@
  * MCI Settings
  */
 #define CONFIG_SYS_BASE_MCI     AT91C_BASE_MCI0
+#define CONFIG_SYS_BASE_MCI_DMAC	AT91C_BASE_DMAC
+#define CONFIG_SYS_ID_MCI_DMAC		AT91C_ID_DMAC
+#define CONFIG_SYS_MCI_DMAC_PER		0	/* DMAC hardware interface */
 
 /*
  * Recovery
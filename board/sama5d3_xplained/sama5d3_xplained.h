@@ -209,5 +209,8 @@
  * MCI Settings
  */
 #define CONFIG_SYS_BASE_MCI	AT91C_BASE_HSMCI0
+#define CONFIG_SYS_BASE_MCI_DMAC	AT91C_BASE_DMAC0
+#define CONFIG_SYS_ID_MCI_DMAC		AT91C_ID_DMAC0
+#define CONFIG_SYS_MCI_DMAC_PER		0	/* DMAC hardware interface */
 
 #endif /* __SAMA5D3_XPLAINED_H__ */
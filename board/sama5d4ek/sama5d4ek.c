@@ -737,14 +737,16 @@ void at91_spi0_hw_init(void)
 }
 #endif /* #ifdef CONFIG_DATAFLASH */
 
-#ifdef CONFIG_SDCARD
+#if defined(CONFIG_SDCARD) || defined(CONFIG_FIT)
 #ifdef CONFIG_OF_LIBFDT
 void at91_board_set_dtb_name(char *of_name)
 {
 	strcpy(of_name, "sama5d4ek.dtb");
 }
 #endif
+#endif
 
+#ifdef CONFIG_SDCARD
 void at91_mci0_hw_init(void)
 {
 	const struct pio_desc mci_pins[] = {
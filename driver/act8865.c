@@ -285,8 +285,7 @@ void act8865_workaround(void)
 	/* Disable ACT8865 I2C interface, if failed, don't go on */
 	if (act8865_workaround_disable_i2c()) {
 		dbg_info("ACT8865: Failed to disable I2C interface\n");
-		while (1)
-			;
+		hang();
 	}
 #endif
 }
@@ -31,6 +31,10 @@
 
 #define	EK_AT24XX_ADDR		0x54
 
+/* The AT24MAC402 EUI-48 address, in its serial number area */
+#define	AT24MAC_ADDR		0x5c
+#define	AT24MAC_EUI48_OFFSET	0x9a
+
 #define	MAX_AT24XX_BYTES	256
 #define EK_INFO_OFFSET		(MAX_AT24XX_BYTES - HW_INFO_TOTAL_SIZE)
 
@@ -87,3 +91,25 @@ int load_ek_at24xx(unsigned char *buff, unsigned int length)
 
 	return ret;
 }
+
+#if defined(CONFIG_OF_MAC_ADDRESS)
+int load_at24mac_address(unsigned char *mac)
+{
+	unsigned char any_one = 0;
+	int i;
+
+	if (at24_read(AT24MAC_ADDR, AT24MAC_EUI48_OFFSET, mac, 6))
+		return -1;
+
+	for (i = 0; i < 6; i++)
+		any_one |= mac[i];
+
+	/* a zero, blank (all ones) or multicast address is not used */
+	if (!any_one || (mac[0] & 0x01)) {
+		dbg_info("EEPROM: No valid MAC address\n");
+		return -1;
+	}
+
+	return 0;
+}
+#endif
@@ -33,6 +33,28 @@
 #include "board.h"
 #include "string.h"
 
+#ifdef CONFIG_AES_DMA
+#include "arch/at91_xdmac.h"
+
+/*
+ * The long runs of 128-bit blocks go to AES_IDATAR0 and come back from
+ * AES_ODATAR0 through two XDMAC channels. A MAC only has the input one,
+ * its result is read from the output registers at the end.
+ */
+#define AES_XDMAC_BASE		AT91C_BASE_XDMAC0
+#define AES_XDMAC_ID		AT91C_ID_XDMAC0
+#define AES_XDMAC_TX_CHANNEL	0
+#define AES_XDMAC_RX_CHANNEL	1
+
+/* below, the registers are faster */
+#define AES_DMA_MIN_LENGTH	256
+/* in words, whole blocks */
+#define AES_DMA_MAX_WORDS	(AT91C_XDMAC_UBLEN_MAX & ~3)
+
+/* a decryption left running by at91_aes_cbc_start() */
+static int aes_dma_pending;
+#endif
+
 
 static inline unsigned int aes_readl(unsigned int reg)
 {
@@ -64,11 +86,26 @@ static inline void aes_writeb(unsigned int reg, unsigned char value)
 	writeb(value, AT91C_BASE_AES + reg);
 }
 
+#ifdef CONFIG_AES_DMA
+static inline unsigned int xdmac_readl(unsigned int reg)
+{
+	return readl(AES_XDMAC_BASE + reg);
+}
+
+static inline void xdmac_writel(unsigned int reg, unsigned int value)
+{
+	writel(value, AES_XDMAC_BASE + reg);
+}
+#endif
+
 
 void at91_aes_init(void)
 {
 	/* Enable peripheral clock */
 	pmc_enable_periph_clock(AT91C_ID_AES);
+#ifdef CONFIG_AES_DMA
+	pmc_enable_periph_clock(AES_XDMAC_ID);
+#endif
 
 	/* Reset AES */
 	aes_writel(AES_CR, AES_CR_SWRST);
@@ -76,11 +113,16 @@ void at91_aes_init(void)
 
 void at91_aes_cleanup(void)
 {
+	at91_aes_wait();
+
 	/* Reset AES */
 	aes_writel(AES_CR, AES_CR_SWRST);
 
 	/* Disable peripheral clock */
 	pmc_disable_periph_clock(AT91C_ID_AES);
+#ifdef CONFIG_AES_DMA
+	pmc_disable_periph_clock(AES_XDMAC_ID);
+#endif
 }
 
 static inline void at91_aes_set_iv(const unsigned int *iv)
@@ -94,10 +136,19 @@ static inline void at91_aes_set_iv(const unsigned int *iv)
 static inline int at91_aes_set_opmode(at91_aes_operation_t operation,
 				      at91_aes_mode_t mode,
 				      at91_aes_key_size_t key_size,
+				      int dma,
 				      unsigned int *data_width,
 				      unsigned int *chunk_size)
 {
-	unsigned int mr = AES_MR_CKEY_PASSWD | AES_MR_SMOD_AUTO_START;
+	unsigned int mr = AES_MR_CKEY_PASSWD;
+
+	if (!dma)
+		mr |= AES_MR_SMOD_AUTO_START;
+	else if (operation == AT91_AES_OP_MAC)
+		/* DATRDY of the next to last block would end the MAC */
+		mr |= AES_MR_SMOD_IDATAR0_START;
+	else
+		mr |= AES_MR_SMOD_IDATAR0_START | AES_MR_DUALBUFF;
 
 	switch (operation) {
 	case AT91_AES_OP_DECRYPT:
@@ -172,7 +223,8 @@ static inline int at91_aes_set_opmode(at91_aes_operation_t operation,
 		break;
 
 	case AT91_AES_MODE_GCM:
-		mr |= AES_MR_OPMOD_GCM;
+		/* the tag is computed once CLENR bytes are processed */
+		mr |= AES_MR_OPMOD_GCM | AES_MR_GTAGEN;
 		*chunk_size = 4;
 		*data_width = 4;
 		break;
@@ -325,6 +377,144 @@ static void at91_aes_compute_pio(unsigned int data_width,
 	}
 }
 
+#ifdef CONFIG_AES_DMA
+static int at91_aes_use_dma(const at91_aes_params_t *params)
+{
+	return (params->mode == AT91_AES_MODE_CBC)
+		&& (params->data_length >= AES_DMA_MIN_LENGTH)
+		&& !(params->data_length & 0xf)
+		&& !((unsigned int)params->input & 3)
+		&& !((unsigned int)params->output & 3);
+}
+
+static void at91_aes_xdmac_start(unsigned int ch,
+				 unsigned int src,
+				 unsigned int dst,
+				 unsigned int words,
+				 unsigned int cc)
+{
+	/* clear the status */
+	xdmac_readl(XDMAC_CIS(ch));
+
+	xdmac_writel(XDMAC_CSA(ch), src);
+	xdmac_writel(XDMAC_CDA(ch), dst);
+	xdmac_writel(XDMAC_CNDC(ch), 0);
+	xdmac_writel(XDMAC_CUBC(ch), AT91C_XDMAC_UBLEN(words));
+	xdmac_writel(XDMAC_CBC(ch), 0);
+	xdmac_writel(XDMAC_CDS_MSP(ch), 0);
+	xdmac_writel(XDMAC_CSUS(ch), 0);
+	xdmac_writel(XDMAC_CDUS(ch), 0);
+	xdmac_writel(XDMAC_CC(ch), cc);
+	xdmac_writel(XDMAC_GE, AT91C_XDMAC_CH(ch));
+}
+
+static int at91_aes_xdmac_wait(unsigned int ch)
+{
+	while (xdmac_readl(XDMAC_GS) & AT91C_XDMAC_CH(ch));
+
+	if (xdmac_readl(XDMAC_CIS(ch)) & AT91C_XDMAC_CIS_ERRORS) {
+		dbg_loud("AES: XDMAC bus error\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int at91_aes_dma_wait(unsigned int is_mac)
+{
+	int rc = 0;
+
+	if (at91_aes_xdmac_wait(AES_XDMAC_TX_CHANNEL))
+		rc = -1;
+	if (!is_mac && at91_aes_xdmac_wait(AES_XDMAC_RX_CHANNEL))
+		rc = -1;
+	if (rc) {
+		xdmac_writel(XDMAC_GD, AT91C_XDMAC_CH(AES_XDMAC_TX_CHANNEL)
+				| AT91C_XDMAC_CH(AES_XDMAC_RX_CHANNEL));
+		return -1;
+	}
+
+	/* the last block of a MAC is still being processed */
+	if (is_mac)
+		while (!(aes_readl(AES_ISR) & AES_INT_DATRDY));
+
+	return 0;
+}
+
+/* Unless "wait", the last run is left to at91_aes_wait() */
+static int at91_aes_compute_dma(unsigned int num_blocks,
+				unsigned int is_mac,
+				const unsigned int *input,
+				unsigned int *output,
+				int wait)
+{
+	unsigned int words = num_blocks * AT91_AES_BLOCK_SIZE_WORD;
+	unsigned int count;
+
+	while (words) {
+		count = (words > AES_DMA_MAX_WORDS) ? AES_DMA_MAX_WORDS : words;
+
+		/* the output channel first, it waits for the first block */
+		if (!is_mac)
+			at91_aes_xdmac_start(AES_XDMAC_RX_CHANNEL,
+					AT91C_BASE_AES + AES_ODATAR0,
+					(unsigned int)output,
+					count,
+					AT91C_XDMAC_CC_TYPE_PER_TRAN
+					| AT91C_XDMAC_CC_MBSIZE_FOUR
+					| AT91C_XDMAC_CC_DSYNC_PER2MEM
+					| AT91C_XDMAC_CC_CSIZE_4
+					| AT91C_XDMAC_CC_DWIDTH_WORD
+					| AT91C_XDMAC_CC_SIF_AHB_IF1
+					| AT91C_XDMAC_CC_DIF_AHB_IF0
+					| AT91C_XDMAC_CC_SAM_FIXED
+					| AT91C_XDMAC_CC_DAM_INCR
+					| AT91C_XDMAC_CC_PERID(AT91C_XDMAC0_PER_AES_RX));
+
+		at91_aes_xdmac_start(AES_XDMAC_TX_CHANNEL,
+				(unsigned int)input,
+				AT91C_BASE_AES + AES_IDATAR0,
+				count,
+				AT91C_XDMAC_CC_TYPE_PER_TRAN
+				| AT91C_XDMAC_CC_MBSIZE_FOUR
+				| AT91C_XDMAC_CC_DSYNC_MEM2PER
+				| AT91C_XDMAC_CC_CSIZE_4
+				| AT91C_XDMAC_CC_DWIDTH_WORD
+				| AT91C_XDMAC_CC_SIF_AHB_IF0
+				| AT91C_XDMAC_CC_DIF_AHB_IF1
+				| AT91C_XDMAC_CC_SAM_INCR
+				| AT91C_XDMAC_CC_DAM_FIXED
+				| AT91C_XDMAC_CC_PERID(AT91C_XDMAC0_PER_AES_TX));
+
+		input += count;
+		if (!is_mac)
+			output += count;
+		words -= count;
+
+		if (!words && !wait) {
+			aes_dma_pending = 1;
+			break;
+		}
+
+		if (at91_aes_dma_wait(is_mac))
+			return -1;
+	}
+
+	return 0;
+}
+#endif
+
+int at91_aes_wait(void)
+{
+#ifdef CONFIG_AES_DMA
+	if (aes_dma_pending) {
+		aes_dma_pending = 0;
+		return at91_aes_dma_wait(0);
+	}
+#endif
+	return 0;
+}
+
 static inline unsigned int at91_aes_length2blocks(unsigned int data_length,
 						  unsigned int block_size)
 {
@@ -360,17 +550,26 @@ static inline unsigned int at91_aes_length2blocks(unsigned int data_length,
 	return (data_length >> shift) + ((data_length & mask) ? 1 : 0);
 }
 
-static int at91_aes_process(const at91_aes_params_t *params)
+static int at91_aes_process(const at91_aes_params_t *params, int wait)
 {
 	unsigned int data_width, chunk_size;
 	unsigned int block_size, num_blocks;
 	unsigned int is_mac = (params->operation == AT91_AES_OP_MAC);
+	int dma = 0;
+
+	if (at91_aes_wait())
+		return -1;
+
+#ifdef CONFIG_AES_DMA
+	dma = at91_aes_use_dma(params);
+#endif
 
 	/* Reset AES */
 	aes_writel(AES_CR, AES_CR_SWRST);
 
 	if (at91_aes_set_opmode(params->operation, params->mode,
-				params->key_size, &data_width, &chunk_size))
+				params->key_size, dma,
+				&data_width, &chunk_size))
 		return -1;
 
 	if (at91_aes_set_key(params->key_size, params->key))
@@ -384,6 +583,13 @@ static int at91_aes_process(const at91_aes_params_t *params)
 
 	block_size = data_width * chunk_size;
 	num_blocks = at91_aes_length2blocks(params->data_length, block_size);
+#ifdef CONFIG_AES_DMA
+	if (dma) {
+		if (at91_aes_compute_dma(num_blocks, is_mac,
+					 params->input, params->output, wait))
+			return -1;
+	} else
+#endif
 	at91_aes_compute_pio(data_width, chunk_size, num_blocks,
 			     is_mac, params->input, params->output);
 
@@ -398,6 +604,33 @@ static int at91_aes_process(const at91_aes_params_t *params)
 	return 0;
 }
 
+static int at91_aes_do_cbc(unsigned int data_length,
+			   const void *input,
+			   void *output,
+			   int encrypt,
+			   at91_aes_key_size_t key_size,
+			   const unsigned int *key,
+			   const unsigned int *iv,
+			   int wait)
+{
+	at91_aes_params_t params;
+
+	if (!data_length || !input || !output || !key || !iv)
+		return -1;
+
+	memset(&params, 0, sizeof(params));
+	params.operation = (encrypt) ? AT91_AES_OP_ENCRYPT : AT91_AES_OP_DECRYPT;
+	params.mode = AT91_AES_MODE_CBC;
+	params.data_length = data_length;
+	params.input = input;
+	params.output = output;
+	params.key_size = key_size;
+	params.key = key;
+	params.iv = iv;
+
+	return at91_aes_process(&params, wait);
+}
+
 int at91_aes_cbc(unsigned int data_length,
 		 const void *input,
 		 void *output,
@@ -405,42 +638,61 @@ int at91_aes_cbc(unsigned int data_length,
 		 at91_aes_key_size_t key_size,
 		 const unsigned int *key,
 		 const unsigned int *iv)
+{
+	return at91_aes_do_cbc(data_length, input, output, encrypt,
+			       key_size, key, iv, 1);
+}
+
+int at91_aes_cbc_start(unsigned int data_length,
+		       const void *input,
+		       void *output,
+		       int encrypt,
+		       at91_aes_key_size_t key_size,
+		       const unsigned int *key,
+		       const unsigned int *iv)
+{
+	return at91_aes_do_cbc(data_length, input, output, encrypt,
+			       key_size, key, iv, 0);
+}
+
+int at91_aes_cbc_mac(unsigned int data_length,
+		     const void *data,
+		     unsigned int *mac,
+		     at91_aes_key_size_t key_size,
+		     const unsigned int *key)
 {
 	at91_aes_params_t params;
 
-	if (!data_length || !input || !output || !key || !iv)
+	if (!data_length || !data || !mac || !key)
 		return -1;
 
 	memset(&params, 0, sizeof(params));
-	params.operation = (encrypt) ? AT91_AES_OP_ENCRYPT : AT91_AES_OP_DECRYPT;
+	params.operation = AT91_AES_OP_MAC;
 	params.mode = AT91_AES_MODE_CBC;
 	params.data_length = data_length;
-	params.input = input;
-	params.output = output;
+	params.input = data;
+	params.output = mac;
 	params.key_size = key_size;
 	params.key = key;
-	params.iv = iv;
+	params.iv = mac;
 
-	return at91_aes_process(&params);
+	return at91_aes_process(&params, 1);
 }
 
-int at91_aes_cmac(unsigned int data_length,
-		  const void *data,
-		  unsigned int *cmac,
-		  at91_aes_key_size_t key_size,
-		  const unsigned int *key)
+int at91_aes_cmac_finish(const void *last_block,
+			 unsigned int *mac,
+			 at91_aes_key_size_t key_size,
+			 const unsigned int *key)
 {
 	static const unsigned int null_block[AT91_AES_BLOCK_SIZE_WORD];
-	static const unsigned int null_iv[AT91_AES_IV_SIZE_WORD];
 	unsigned int last_input[AT91_AES_BLOCK_SIZE_WORD];
 	unsigned int subkey[AT91_AES_BLOCK_SIZE_WORD];
-	const unsigned int *input = (const unsigned int *)data;
-	unsigned int num_blocks, offset;
+	const unsigned int *input = (const unsigned int *)last_block;
 	at91_aes_params_t params;
 	unsigned char carry;
 	int i; /* MUST be signed for the subkey loop */
 
-	if (!data_length || !data || !cmac || !key)
+	if (!last_block || !mac || !key)
 		return -1;
 
 	/* Set common parameters once for all */
@@ -454,7 +706,7 @@ int at91_aes_cmac(unsigned int data_length,
 	params.data_length = AT91_AES_BLOCK_SIZE_BYTE;
 	params.input = null_block;
 	params.output = subkey;
-	if (at91_aes_process(&params))
+	if (at91_aes_process(&params, 1))
 		return -1;
 
 	carry = 0;
@@ -469,31 +721,123 @@ int at91_aes_cmac(unsigned int data_length,
 	carry = (0 - carry) & 0x87;
 	((unsigned char *)subkey)[AT91_AES_BLOCK_SIZE_BYTE-1] ^= carry;
 
-	/* Process the n-1 first blocks */
-	num_blocks = at91_aes_length2blocks(data_length,
-					    AT91_AES_BLOCK_SIZE_BYTE);
-	if (num_blocks > 1) {
-		params.operation = AT91_AES_OP_MAC;
-		params.mode = AT91_AES_MODE_CBC;
-		params.iv = null_iv;
-		params.data_length = data_length - AT91_AES_BLOCK_SIZE_BYTE;
-		params.input = data;
-		params.output = cmac;
-		if (at91_aes_process(&params))
-			return -1;
-	} else {
-		memset(cmac, 0, AT91_AES_BLOCK_SIZE_BYTE);
-	}
-
 	/* Process the last block */
-	offset = (num_blocks-1) * AT91_AES_BLOCK_SIZE_WORD;
 	for (i = 0; i < AT91_AES_BLOCK_SIZE_WORD; ++i)
-		last_input[i] = input[offset + i] ^ cmac[i] ^ subkey[i];
+		last_input[i] = input[i] ^ mac[i] ^ subkey[i];
 
 	params.operation = AT91_AES_OP_ENCRYPT;
 	params.mode = AT91_AES_MODE_ECB;
 	params.data_length = AT91_AES_BLOCK_SIZE_BYTE;
 	params.input = last_input;
-	params.output = cmac;
-	return at91_aes_process(&params);
+	params.output = mac;
+	return at91_aes_process(&params, 1);
+}
+
+int at91_aes_cmac(unsigned int data_length,
+		  const void *data,
+		  unsigned int *cmac,
+		  at91_aes_key_size_t key_size,
+		  const unsigned int *key)
+{
+	const unsigned int *input = (const unsigned int *)data;
+	unsigned int num_blocks;
+
+	if (!data_length || !data || !cmac || !key)
+		return -1;
+
+	/* Process the n-1 first blocks */
+	memset(cmac, 0, AT91_AES_BLOCK_SIZE_BYTE);
+	num_blocks = at91_aes_length2blocks(data_length,
+					    AT91_AES_BLOCK_SIZE_BYTE);
+	if ((num_blocks > 1)
+	    && at91_aes_cbc_mac(data_length - AT91_AES_BLOCK_SIZE_BYTE,
+				data, cmac, key_size, key))
+		return -1;
+
+	/* Process the last block */
+	return at91_aes_cmac_finish(input
+				+ (num_blocks-1) * AT91_AES_BLOCK_SIZE_WORD,
+				cmac, key_size, key);
+}
+
+int at91_aes_gcm_start(int encrypt,
+		       at91_aes_key_size_t key_size,
+		       const unsigned int *key,
+		       const unsigned int *iv,
+		       unsigned int aad_length,
+		       const void *aad,
+		       unsigned int data_length)
+{
+	unsigned int data_width, chunk_size;
+	unsigned int j0[AT91_AES_IV_SIZE_WORD];
+	unsigned int i;
+
+	if (!key || !iv || (aad_length && !aad))
+		return -1;
+
+	if (at91_aes_wait())
+		return -1;
+
+	/* Reset AES */
+	aes_writel(AES_CR, AES_CR_SWRST);
+
+	if (at91_aes_set_opmode(encrypt ? AT91_AES_OP_ENCRYPT
+					: AT91_AES_OP_DECRYPT,
+				AT91_AES_MODE_GCM, key_size, 0,
+				&data_width, &chunk_size))
+		return -1;
+
+	/* the hash subkey H is computed from the key */
+	if (at91_aes_set_key(key_size, key))
+		return -1;
+	while (!(aes_readl(AES_ISR) & AES_INT_DATRDY));
+
+	/* J0 is IV || 0^31 || 1: the text starts at inc32(J0) */
+	for (i = 0; i < AT91_AES_GCM_IV_SIZE_WORD; ++i)
+		j0[i] = iv[i];
+	j0[3] = 0x02000000;	/* big endian */
+	at91_aes_set_iv(j0);
+
+	aes_writel(AES_AADLENR, aad_length);
+	aes_writel(AES_CLENR, data_length);
+
+	/* the last block is padded by the AES, it knows the lengths */
+	if (aad_length)
+		at91_aes_compute_pio_long(AT91_AES_BLOCK_SIZE_WORD,
+				at91_aes_length2blocks(aad_length,
+						AT91_AES_BLOCK_SIZE_BYTE),
+				1, aad, 0);
+
+	return 0;
+}
+
+int at91_aes_gcm_update(unsigned int data_length,
+			const void *input,
+			void *output)
+{
+	if (!data_length || !input || !output)
+		return -1;
+
+	at91_aes_compute_pio_long(AT91_AES_BLOCK_SIZE_WORD,
+			at91_aes_length2blocks(data_length,
+					AT91_AES_BLOCK_SIZE_BYTE),
+			0, input, output);
+
+	return 0;
+}
+
+int at91_aes_gcm_finish(unsigned int *tag)
+{
+	unsigned int reg, i;
+
+	if (!tag)
+		return -1;
+
+	while (!(aes_readl(AES_ISR) & AES_INT_TAGRDY));
+
+	reg = AES_TAGR0;
+	for (i = 0; i < AT91_AES_BLOCK_SIZE_WORD; ++i, reg += 4)
+		tag[i] = aes_readl(reg);
+
+	return 0;
 }
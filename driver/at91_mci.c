@@ -31,12 +31,32 @@
 #include "arch/at91_mci.h"
 #include "mci_media.h"
 #include "div.h"
+#include "timer.h"
 #include "debug.h"
+#include "usart.h"
 #include "pmc.h"
 
 #define DEFAULT_SD_BLOCK_LEN		512
 #define CONFIG_SYS_DEFAULT_CLK		400000
 
+/*
+ * The MCI of the AT91SAM9260 family moves its data through the PDC, the
+ * HSMCI of the later parts through a channel of the central DMAC, whose
+ * base, peripheral ID and handshaking interface the board provides.
+ */
+#ifdef CONFIG_AT91_MCI_DMA
+#if !defined(CPU_HAS_HSMCI0)
+#define AT91_MCI_PDC
+#include "arch/at91_pdc.h"
+#elif defined(CONFIG_SYS_BASE_MCI_DMAC)
+#define AT91_MCI_DMAC
+#include "arch/at91_dmac.h"
+#define MCI_DMAC_CHANNEL		0
+#endif
+
+#define MCI_DMA_TIMEOUT			1000000	/* us, per buffer */
+#endif
+
 static inline unsigned int mci_readl(unsigned int reg)
 {
 	return readl((void *)CONFIG_SYS_BASE_MCI + reg);
@@ -117,6 +137,11 @@ static int at91_mci_init(struct sd_card *sdcard)
 	if (ret)
 		return ret;
 
+#ifdef AT91_MCI_DMAC
+	pmc_enable_periph_clock(CONFIG_SYS_ID_MCI_DMAC);
+	writel(AT91C_DMAC_ENABLE, (void *)CONFIG_SYS_BASE_MCI_DMAC + DMAC_EN);
+#endif
+
 	/* enable mci */
 	mci_writel(MCI_CR, AT91C_MCI_MCIEN);
 
@@ -196,10 +221,208 @@ static int at91_mci_read_data(unsigned int *data)
 	return 0;
 }
 
+#if defined(AT91_MCI_PDC)
+static void at91_mci_dma_start(unsigned int *data, unsigned int words)
+{
+	mci_writel(PDC_RPR, (unsigned int)data);
+	mci_writel(PDC_RCR, words);
+}
+
+static int at91_mci_dma_done(void)
+{
+	return mci_readl(MCI_SR) & AT91C_MCI_ENDRX;
+}
+
+static void at91_mci_dma_enable(void)
+{
+	mci_writel(PDC_PTCR, AT91C_PDC_RXTDIS | AT91C_PDC_TXTDIS);
+	mci_writel(MCI_MR, mci_readl(MCI_MR) | AT91C_MCI_PDCMODE);
+	mci_writel(PDC_PTCR, AT91C_PDC_RXTEN);
+}
+
+static void at91_mci_dma_disable(void)
+{
+	mci_writel(PDC_PTCR, AT91C_PDC_RXTDIS);
+	mci_writel(MCI_MR, mci_readl(MCI_MR) & ~AT91C_MCI_PDCMODE);
+}
+
+#define MCI_DMA_MAX_WORDS	AT91C_PDC_MAX_COUNT
+
+#elif defined(AT91_MCI_DMAC)
+static inline unsigned int dmac_readl(unsigned int reg)
+{
+	return readl((void *)CONFIG_SYS_BASE_MCI_DMAC + reg);
+}
+
+static inline void dmac_writel(unsigned int reg, unsigned int value)
+{
+	writel((value), (void *)CONFIG_SYS_BASE_MCI_DMAC + reg);
+}
+
+static void at91_mci_dma_start(unsigned int *data, unsigned int words)
+{
+	unsigned int ch = MCI_DMAC_CHANNEL;
+
+	/* clear the stale status of the channel */
+	dmac_readl(DMAC_EBCISR);
+
+	dmac_writel(DMAC_SADDR(ch), CONFIG_SYS_BASE_MCI + MCI_RDR);
+	dmac_writel(DMAC_DADDR(ch), (unsigned int)data);
+	dmac_writel(DMAC_DSCR(ch), 0);
+	dmac_writel(DMAC_CTRLA(ch), AT91C_DMAC_BTSIZE(words)
+				| AT91C_DMAC_SCSIZE_1
+				| AT91C_DMAC_DCSIZE_1
+				| AT91C_DMAC_SRC_WIDTH_WORD
+				| AT91C_DMAC_DST_WIDTH_WORD);
+	dmac_writel(DMAC_CTRLB(ch), AT91C_DMAC_SRC_DSCR_FETCH_DISABLE
+				| AT91C_DMAC_DST_DSCR_FETCH_DISABLE
+				| AT91C_DMAC_FC_PER2MEM
+				| AT91C_DMAC_SRC_INCR_FIXED
+				| AT91C_DMAC_DST_INCR_INCREMENTING);
+	dmac_writel(DMAC_CFG(ch), AT91C_DMAC_SRC_PER(CONFIG_SYS_MCI_DMAC_PER)
+				| AT91C_DMAC_SRC_H2SEL_HW
+				| AT91C_DMAC_SOD
+				| AT91C_DMAC_FIFOCFG_ALAP);
+	dmac_writel(DMAC_CHER, AT91C_DMAC_ENA(ch));
+}
+
+static int at91_mci_dma_done(void)
+{
+	unsigned int ch = MCI_DMAC_CHANNEL;
+	unsigned int status = dmac_readl(DMAC_EBCISR);
+
+	if (status & AT91C_DMAC_ERR(ch)) {
+		dbg_loud("MCI: DMAC access error\n");
+		return -1;
+	}
+
+	return !(dmac_readl(DMAC_CHSR) & AT91C_DMAC_ENA(ch));
+}
+
+static void at91_mci_dma_enable(void)
+{
+	mci_writel(MCI_DMA, AT91C_MCI_DMAEN_ENABLE | AT91C_MCI_CHKSIZE_1);
+}
+
+static void at91_mci_dma_disable(void)
+{
+	dmac_writel(DMAC_CHDR, AT91C_DMAC_ENA(MCI_DMAC_CHANNEL));
+	mci_writel(MCI_DMA, AT91C_MCI_DMAEN_DISABLE);
+}
+
+#define MCI_DMA_MAX_WORDS	AT91C_DMAC_BTSIZE_MAX
+#endif
+
+#if defined(AT91_MCI_PDC) || defined(AT91_MCI_DMAC)
+/*
+ * Let the DMA move the whole multi-block read into the buffer, in
+ * pieces of at most MCI_DMA_MAX_WORDS words. Read Proof is enabled, so
+ * the card clock is stopped while a piece is being rearmed.
+ * at91_mci_dma_read_start() queues the first piece and returns, the
+ * pieces left are queued by at91_mci_dma_read_wait().
+ */
+static struct {
+	unsigned int	*data;
+	unsigned int	words;		/* not queued yet */
+	unsigned int	count;		/* words of the running piece */
+	int		pending;
+} mci_dma;
+
+static void at91_mci_dma_next(void)
+{
+	mci_dma.count = (mci_dma.words > MCI_DMA_MAX_WORDS) ?
+					MCI_DMA_MAX_WORDS : mci_dma.words;
+
+	at91_mci_dma_start(mci_dma.data, mci_dma.count);
+
+	mci_dma.data += mci_dma.count;
+	mci_dma.words -= mci_dma.count;
+}
+
+static void at91_mci_dma_read_start(unsigned int *data, unsigned int words)
+{
+	at91_mci_dma_enable();
+
+	mci_dma.data = data;
+	mci_dma.words = words;
+	mci_dma.pending = 1;
+
+	at91_mci_dma_next();
+}
+
+static int at91_mci_dma_read_wait(void)
+{
+	unsigned int error_check = (AT91C_MCI_DCRCE
+					| AT91C_MCI_DTOE
+					| AT91C_MCI_OVRE);
+	unsigned int status;
+	int timeout;
+	int done;
+	int ret = 0;
+
+	if (!mci_dma.pending)
+		return 0;
+
+	mci_dma.pending = 0;
+
+	for (;;) {
+		timeout = MCI_DMA_TIMEOUT;
+		do {
+			status = mci_readl(MCI_SR);
+			if (status & error_check) {
+				dbg_loud("Error to read data, sr: %d\n", status);
+				ret = -1;
+				goto out;
+			}
+
+			done = at91_mci_dma_done();
+			if (done < 0) {
+				ret = -1;
+				goto out;
+			}
+
+			if (!done)
+				udelay(1);
+		} while (!done && --timeout);
+
+		if (!timeout) {
+			dbg_loud("MCI: DMA transfer timeout\n");
+			ret = -1;
+			goto out;
+		}
+
+		if (!mci_dma.words)
+			break;
+
+		at91_mci_dma_next();
+	}
+
+	timeout = 10000;
+	while ((mci_readl(MCI_SR) & AT91C_MCI_DTIP) && (--timeout))
+		;
+
+	if (!timeout) {
+		dbg_loud("Data Transfer in Progress.\n");
+		ret = -1;
+	}
+
+out:
+	at91_mci_dma_disable();
+
+	return ret;
+}
+
+static int at91_mci_wait_data(struct sd_data *data)
+{
+	return at91_mci_dma_read_wait();
+}
+#endif
+
 static int at91_mci_read_block_data(unsigned int *data,
 			unsigned int blocks,
 			unsigned int bytes_to_read,
-			unsigned int block_len)
+			unsigned int block_len,
+			unsigned int nowait)
 {
 	unsigned int block;
 	unsigned int count;
@@ -209,6 +432,21 @@ static int at91_mci_read_block_data(unsigned int *data,
 	int timeout = 10000;
 	int ret;
 
+#if defined(AT91_MCI_PDC) || defined(AT91_MCI_DMAC)
+	/*
+	 * Whole blocks into a word aligned buffer go through the DMA,
+	 * anything else (SCR, switch status) is polled. The caller which
+	 * asks not to wait completes the read with at91_mci_wait_data().
+	 */
+	if ((bytes_to_read == block_len) && !((unsigned int)data & 0x03)) {
+		at91_mci_dma_read_start(data, blocks * words_of_block);
+		if (nowait)
+			return 0;
+
+		return at91_mci_dma_read_wait();
+	}
+#endif
+
 	for (block = 0; block < blocks; block++) {
 		for (count = 0; count < words_to_read; count++, data++) {
 			ret = at91_mci_read_data((unsigned int *)data);
@@ -222,6 +460,8 @@ static int at91_mci_read_block_data(unsigned int *data,
 			if (ret)
 				return ret;
 		}
+
+		usart_poll();
 	}
 
 	while ((mci_readl(MCI_SR) & AT91C_MCI_DTIP) && (--timeout))
@@ -370,7 +610,7 @@ static int at91_mci_send_command(struct sd_command *command, struct sd_data *dat
 	if (data) {
 		if (data->direction == SD_DATA_DIR_RD)
 			ret = at91_mci_read_block_data((unsigned int *)data->buff, data->blocks,
-						data->blocksize, block_len);
+						data->blocksize, block_len, data->nowait);
 		else
 			ret = at91_mci_write_block_data((unsigned int *)data->buff, data->blocks,
 						data->blocksize, block_len);
@@ -386,6 +626,9 @@ static struct host_ops at91_mci_ops = {
 	.send_command = at91_mci_send_command,
 	.set_clock = at91_mci_set_clock,
 	.set_bus_width = at91_mci_set_bus_width,
+#if defined(AT91_MCI_PDC) || defined(AT91_MCI_DMAC)
+	.wait_data = at91_mci_wait_data,
+#endif
 };
 
 int sdcard_register_at91_mci(struct sd_card *sdcard)
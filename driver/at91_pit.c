@@ -29,6 +29,7 @@
 #include "board.h"
 #include "debug.h"
 #include "pmc.h"
+#include "usart.h"
 
 #include "arch/at91_pit.h"
 #include "arch/at91_pmc.h"
@@ -67,6 +68,20 @@ static unsigned int at91_get_pit_value(void)
 	return(pit_readl(PIT_PIIR));
 }
 
+/* Free-running count of MCK / 16 periods, wraps after 2^32 ticks */
+unsigned int timer_get_ticks(void)
+{
+	return at91_get_pit_value();
+}
+
+unsigned int timer_ticks_to_ms(unsigned int ticks)
+{
+	if (pmc_check_mck_h32mxdiv())
+		return ticks / (((MASTER_CLOCK / 2) / 1000) / 16);
+	else
+		return ticks / ((MASTER_CLOCK / 1000) / 16);
+}
+
 /* Because the below statement is used in the function:
  *	((MASTER_CLOCK >> 10) * usec) is used,
  * to our 32-bit system. the argu "usec" maximum value is:
@@ -94,6 +109,7 @@ void udelay(unsigned int usec)
 		delay = ((MASTER_CLOCK >> 10) * usec) >> 14;
 
 	do {
+		usart_poll();
 		current = at91_get_pit_value();
 		current -= base;
 	} while (current < delay);
@@ -111,6 +127,7 @@ void mdelay(unsigned int msec)
 		delay = ((MASTER_CLOCK / 1000) * msec) / 16;
 
 	do {
+		usart_poll();
 		current = at91_get_pit_value();
 		current -= base;
 	} while (current < delay);
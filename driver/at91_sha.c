@@ -0,0 +1,307 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hardware.h"
+#include "pmc.h"
+#include "arch/at91_sha.h"
+#include "sha256.h"
+#include "debug.h"
+#include "string.h"
+
+/*
+ * The SHA peripheral hashes the blocks written to its input registers,
+ * the padding is done here. Where there is a DMAC handshaking interface
+ * for it, the whole blocks in the data are fed by a chain of DMAC
+ * transfers, which runs on while the next data is read from the media.
+ */
+#ifdef AT91C_DMAC1_PER_SHA_TX
+#define SHA_DMAC
+#include "arch/at91_dmac.h"
+#define SHA_DMAC_BASE		AT91C_BASE_DMAC1
+#define SHA_DMAC_ID		AT91C_ID_DMAC1
+#define SHA_DMAC_PER		AT91C_DMAC1_PER_SHA_TX
+#define SHA_DMAC_CHANNEL	0
+
+#define SHA_DMA_DESC_COUNT	16
+/* in words, whole blocks */
+#define SHA_DMA_MAX_WORDS	(AT91C_DMAC_BTSIZE_MAX & ~15)
+
+/* DMAC linked list item */
+struct sha_dma_desc {
+	unsigned int	saddr;
+	unsigned int	daddr;
+	unsigned int	ctrla;
+	unsigned int	ctrlb;
+	unsigned int	dscr;
+};
+
+static struct sha_dma_desc sha_dma_desc[SHA_DMA_DESC_COUNT];
+static int sha_dma_running;
+#define SHA_MR_SMOD		SHA_MR_SMOD_IDATAR0_START
+#else
+#define SHA_MR_SMOD		SHA_MR_SMOD_AUTO_START
+#endif
+
+/* a block is being hashed */
+static int sha_busy;
+
+static inline unsigned int sha_readl(unsigned int reg)
+{
+	return readl(AT91C_BASE_SHA + reg);
+}
+
+static inline void sha_writel(unsigned int reg, unsigned int value)
+{
+	writel(value, AT91C_BASE_SHA + reg);
+}
+
+#ifdef SHA_DMAC
+static inline unsigned int dmac_readl(unsigned int reg)
+{
+	return readl(SHA_DMAC_BASE + reg);
+}
+
+static inline void dmac_writel(unsigned int reg, unsigned int value)
+{
+	writel(value, SHA_DMAC_BASE + reg);
+}
+
+static void sha_dma_wait(struct sha256_ctx *ctx)
+{
+	unsigned int ch = SHA_DMAC_CHANNEL;
+
+	if (!sha_dma_running)
+		return;
+
+	while (dmac_readl(DMAC_CHSR) & AT91C_DMAC_ENA(ch)) {
+		if (dmac_readl(DMAC_EBCISR) & AT91C_DMAC_ERR(ch)) {
+			dbg_loud("SHA: DMAC access error\n");
+			dmac_writel(DMAC_CHDR, AT91C_DMAC_ENA(ch));
+			ctx->error = 1;
+			break;
+		}
+	}
+
+	sha_dma_running = 0;
+}
+#endif
+
+static void sha_wait(struct sha256_ctx *ctx)
+{
+#ifdef SHA_DMAC
+	sha_dma_wait(ctx);
+#endif
+	if (sha_busy && !ctx->error)
+		while (!(sha_readl(SHA_ISR) & SHA_INT_DATRDY));
+
+	sha_busy = 0;
+}
+
+static void sha_write_block(struct sha256_ctx *ctx, const unsigned int *p)
+{
+	unsigned int i;
+
+	sha_wait(ctx);
+	if (ctx->error)
+		return;
+
+	for (i = 0; i < SHA256_BLOCK_SIZE / 4; i++)
+#ifdef SHA_DMAC
+		sha_writel(SHA_IDATAR(0), p[i]);
+#else
+		sha_writel(SHA_IDATAR(i), p[i]);
+#endif
+
+	sha_busy = 1;
+}
+
+#ifdef SHA_DMAC
+/*
+ * Starts the transfer of up to "blocks" blocks at "p", returns the count
+ * of the blocks, which the DMAC reads after the return.
+ */
+static unsigned int sha_dma_start(struct sha256_ctx *ctx,
+				const unsigned int *p,
+				unsigned int blocks)
+{
+	unsigned int ch = SHA_DMAC_CHANNEL;
+	unsigned int words = blocks * (SHA256_BLOCK_SIZE / 4);
+	unsigned int count = 0;
+	unsigned int size;
+	unsigned int i;
+
+	sha_wait(ctx);
+	if (ctx->error)
+		return blocks;
+
+	for (i = 0; (i < SHA_DMA_DESC_COUNT) && words; i++) {
+		size = (words > SHA_DMA_MAX_WORDS) ? SHA_DMA_MAX_WORDS : words;
+
+		sha_dma_desc[i].saddr = (unsigned int)p;
+		sha_dma_desc[i].daddr = AT91C_BASE_SHA + SHA_IDATAR(0);
+		sha_dma_desc[i].ctrla = AT91C_DMAC_BTSIZE(size)
+					| AT91C_DMAC_SCSIZE_16
+					| AT91C_DMAC_DCSIZE_16
+					| AT91C_DMAC_SRC_WIDTH_WORD
+					| AT91C_DMAC_DST_WIDTH_WORD;
+		sha_dma_desc[i].ctrlb = AT91C_DMAC_FC_MEM2PER
+					| AT91C_DMAC_SRC_INCR_INCREMENTING
+					| AT91C_DMAC_DST_INCR_FIXED;
+		sha_dma_desc[i].dscr = (unsigned int)&sha_dma_desc[i + 1];
+
+		p += size;
+		words -= size;
+		count += size;
+	}
+	sha_dma_desc[i - 1].dscr = 0;
+
+	/* clear the status */
+	dmac_readl(DMAC_EBCISR);
+
+	dmac_writel(DMAC_SADDR(ch), 0);
+	dmac_writel(DMAC_DADDR(ch), 0);
+	dmac_writel(DMAC_CTRLA(ch), 0);
+	dmac_writel(DMAC_CTRLB(ch), 0);
+	dmac_writel(DMAC_CFG(ch), AT91C_DMAC_DST_PER(SHA_DMAC_PER)
+				| AT91C_DMAC_DST_PER_MSB(SHA_DMAC_PER)
+				| AT91C_DMAC_DST_H2SEL_HW
+				| AT91C_DMAC_FIFOCFG_ALAP);
+	dmac_writel(DMAC_DSCR(ch), (unsigned int)&sha_dma_desc[0]);
+	dmac_writel(DMAC_CHER, AT91C_DMAC_ENA(ch));
+
+	sha_dma_running = 1;
+	sha_busy = 1;
+
+	return count / (SHA256_BLOCK_SIZE / 4);
+}
+#endif
+
+void sha256_starts(struct sha256_ctx *ctx)
+{
+	pmc_enable_periph_clock(AT91C_ID_SHA);
+#ifdef SHA_DMAC
+	pmc_enable_periph_clock(SHA_DMAC_ID);
+	dmac_writel(DMAC_EN, AT91C_DMAC_ENABLE);
+#endif
+
+	sha_writel(SHA_CR, SHA_CR_SWRST);
+	sha_writel(SHA_MR, SHA_MR_SMOD | SHA_MR_ALGO_SHA256);
+	sha_writel(SHA_CR, SHA_CR_FIRST);
+	sha_busy = 0;
+
+	ctx->count = 0;
+	ctx->used = 0;
+	ctx->error = 0;
+}
+
+void sha256_update(struct sha256_ctx *ctx, const void *data, unsigned int len)
+{
+	unsigned char *block = (unsigned char *)ctx->block;
+	const unsigned char *p = data;
+	unsigned int n;
+
+	ctx->count += len;
+
+	if (ctx->used) {
+		n = SHA256_BLOCK_SIZE - ctx->used;
+		if (n > len)
+			n = len;
+		memcpy(block + ctx->used, p, n);
+		ctx->used += n;
+		p += n;
+		len -= n;
+
+		if (ctx->used < SHA256_BLOCK_SIZE)
+			return;
+
+		sha_write_block(ctx, ctx->block);
+		ctx->used = 0;
+	}
+
+	if ((unsigned int)p & 3) {
+		for (; len >= SHA256_BLOCK_SIZE; len -= SHA256_BLOCK_SIZE) {
+			memcpy(block, p, SHA256_BLOCK_SIZE);
+			sha_write_block(ctx, ctx->block);
+			p += SHA256_BLOCK_SIZE;
+		}
+	}
+
+	while (len >= SHA256_BLOCK_SIZE) {
+#ifdef SHA_DMAC
+		n = sha_dma_start(ctx, (const unsigned int *)p,
+					len / SHA256_BLOCK_SIZE);
+		n *= SHA256_BLOCK_SIZE;
+#else
+		sha_write_block(ctx, (const unsigned int *)p);
+		n = SHA256_BLOCK_SIZE;
+#endif
+		p += n;
+		len -= n;
+	}
+
+	memcpy(block, p, len);
+	ctx->used = len;
+}
+
+int sha256_finish(struct sha256_ctx *ctx, unsigned char *digest)
+{
+	unsigned char *block = (unsigned char *)ctx->block;
+	unsigned int bits_hi = ctx->count >> 29;
+	unsigned int bits_lo = ctx->count << 3;
+	unsigned int value;
+	unsigned int i;
+
+	/* 0x80, zeroes, then the big endian bit count */
+	block[ctx->used++] = 0x80;
+	if (ctx->used > SHA256_BLOCK_SIZE - 8) {
+		memset(block + ctx->used, 0, SHA256_BLOCK_SIZE - ctx->used);
+		sha_write_block(ctx, ctx->block);
+		ctx->used = 0;
+	}
+	memset(block + ctx->used, 0, SHA256_BLOCK_SIZE - 8 - ctx->used);
+
+	for (i = 0; i < 4; i++) {
+		block[56 + i] = bits_hi >> (24 - i * 8);
+		block[60 + i] = bits_lo >> (24 - i * 8);
+	}
+	sha_write_block(ctx, ctx->block);
+	sha_wait(ctx);
+
+	/* the digest words are in the byte order of the memory */
+	for (i = 0; i < SHA256_DIGEST_SIZE / 4; i++) {
+		value = sha_readl(SHA_IODATAR(i));
+		memcpy(digest + i * 4, &value, 4);
+	}
+
+	sha_writel(SHA_CR, SHA_CR_SWRST);
+	pmc_disable_periph_clock(AT91C_ID_SHA);
+#ifdef SHA_DMAC
+	pmc_disable_periph_clock(SHA_DMAC_ID);
+#endif
+
+	return ctx->error ? -1 : 0;
+}
@@ -28,6 +28,7 @@
 #include "hardware.h"
 #include "board.h"
 #include "arch/at91_dbgu.h"
+#include "usart.h"
 
 #ifndef USART_BASE
 #define USART_BASE	AT91C_BASE_DBGU
@@ -67,6 +68,54 @@ void usart_init(unsigned int baudrate)
 	write_usart(DBGU_CR, AT91C_DBGU_RXEN | AT91C_DBGU_TXEN);
 }
 
+#ifdef CONFIG_USART_BUFFERED
+/*
+ * The characters wait in a ring buffer, the DBGU takes them one at a
+ * time from usart_poll(), which never waits.
+ */
+static char usart_buf[USART_BUFFER_SIZE];
+static unsigned int usart_head;
+static unsigned int usart_tail;
+static unsigned int usart_sent;
+
+static inline unsigned int usart_next(unsigned int index)
+{
+	return (index + 1 == USART_BUFFER_SIZE) ? 0 : index + 1;
+}
+
+void usart_poll(void)
+{
+	while ((usart_tail != usart_head)
+		&& (read_usart(DBGU_CSR) & AT91C_DBGU_TXRDY)) {
+		write_usart(DBGU_THR, usart_buf[usart_tail]);
+		usart_tail = usart_next(usart_tail);
+		usart_sent = 1;
+	}
+}
+
+void usart_flush(void)
+{
+	while (usart_tail != usart_head)
+		usart_poll();
+
+	/* the DBGU may not be enabled if nothing was sent */
+	if (usart_sent)
+		while (!(read_usart(DBGU_CSR) & AT91C_DBGU_TXEMPTY))
+			;
+}
+
+static void usart_putc(const char c)
+{
+	unsigned int next = usart_next(usart_head);
+
+	/* full, wait for the oldest character to go */
+	while (next == usart_tail)
+		usart_poll();
+
+	usart_buf[usart_head] = c;
+	usart_head = next;
+}
+#else
 static void usart_putc(const char c)
 {
 	while (!(read_usart(DBGU_CSR) & AT91C_DBGU_TXRDY))
@@ -74,6 +123,7 @@ static void usart_putc(const char c)
 
 	write_usart(DBGU_THR, c);
 }
+#endif
 
 void usart_puts(const char *ptr)
 {
@@ -85,10 +135,15 @@ void usart_puts(const char *ptr)
 		usart_putc(ptr[i]);
 		i++;
 	}
+
+	usart_poll();
 }
 
 char usart_getc(void)
 {
+	/* the prompt goes out first */
+	usart_flush();
+
 	while (!(read_usart(DBGU_CSR) & AT91C_DBGU_RXRDY))
 		;
 
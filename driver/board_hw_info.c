@@ -73,6 +73,9 @@ typedef struct board_hw_info {
 
 static unsigned int sn;
 static unsigned int rev;
+static char *cm_name;
+static char *dm_name;
+static char *ek_name;
 static unsigned char buffer[HW_INFO_TOTAL_SIZE];
 
 static struct {
@@ -300,6 +303,7 @@ static int construct_sn_rev(board_info_t *bd_info,
 	switch (bd_info->board_type) {
 	case BOARD_TYPE_CPU:
 		*missing &= (BOARD_TYPE_MASK & ~BOARD_TYPE_CPU_MASK);
+		cm_name = bd_info->board_name;
 		*psn |= (bd_info->board_id & SN_MASK);
 		*psn |= ((bd_info->vendor_id & VENDOR_MASK)
 							<< CM_VENDOR_OFFSET);
@@ -310,6 +314,7 @@ static int construct_sn_rev(board_info_t *bd_info,
 
 	case BOARD_TYPE_DM:
 		*missing &= (BOARD_TYPE_MASK & ~BOARD_TYPE_DM_MASK);
+		dm_name = bd_info->board_name;
 		*psn |= ((bd_info->board_id & SN_MASK) << DM_SN_OFFSET);
 		*psn |= ((bd_info->vendor_id & VENDOR_MASK)
 							<< DM_VENDOR_OFFSET);
@@ -321,6 +326,7 @@ static int construct_sn_rev(board_info_t *bd_info,
 
 	case BOARD_TYPE_EK:
 		*missing &= (BOARD_TYPE_MASK & ~BOARD_TYPE_EK_MASK);
+		ek_name = bd_info->board_name;
 		*psn |= ((bd_info->board_id & SN_MASK) << EK_SN_OFFSET);
 		*psn |= ((bd_info->vendor_id & VENDOR_MASK)
 							<< EK_VENDOR_OFFSET);
@@ -495,6 +501,22 @@ unsigned int get_ek_sn(void)
 	return (sn  >> EK_SN_OFFSET) & SN_MASK;
 }
 
+/* The names of the detected boards, as "SAMA5D3x-DM", NULL if none */
+char *get_cm_name(void)
+{
+	return cm_name;
+}
+
+char *get_dm_name(void)
+{
+	return dm_name;
+}
+
+char *get_ek_name(void)
+{
+	return ek_name;
+}
+
 #if defined(CONFIG_LOAD_ONE_WIRE)
 static unsigned int load_1wire_info(unsigned char *buff, unsigned int size,
 				unsigned int *psn, unsigned int *prev,
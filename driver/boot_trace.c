@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "common.h"
+#include "hardware.h"
+#include "board.h"
+#include "string.h"
+#include "crc32.h"
+#include "profile.h"
+#include "boot_trace.h"
+#include "debug.h"
+
+struct boot_trace_counters {
+	const char	*name;
+	unsigned int	bytes;
+	unsigned int	ecc_corrected;
+	unsigned int	retries;
+};
+
+static struct boot_trace_counters counters[BOOT_TRACE_MAX_MEDIA];
+static unsigned int num_counters;
+
+/* The counters of the media, NULL once all of them are taken */
+static struct boot_trace_counters *boot_trace_media(const char *media)
+{
+	unsigned int i;
+
+	for (i = 0; i < num_counters; i++)
+		if (!strcmp(counters[i].name, media))
+			return &counters[i];
+
+	if (num_counters >= BOOT_TRACE_MAX_MEDIA)
+		return NULL;
+
+	counters[num_counters].name = media;
+
+	return &counters[num_counters++];
+}
+
+void boot_trace_read(const char *media, unsigned int bytes)
+{
+	struct boot_trace_counters *counter = boot_trace_media(media);
+
+	if (counter)
+		counter->bytes += bytes;
+}
+
+void boot_trace_ecc(const char *media, unsigned int corrected)
+{
+	struct boot_trace_counters *counter = boot_trace_media(media);
+
+	if (counter)
+		counter->ecc_corrected += corrected;
+}
+
+void boot_trace_retry(const char *media)
+{
+	struct boot_trace_counters *counter = boot_trace_media(media);
+
+	if (counter)
+		counter->retries++;
+}
+
+static void boot_trace_set_name(char *dest, const char *name)
+{
+	unsigned int len = strlen(name);
+
+	if (len > BOOT_TRACE_NAME_SIZE - 1)
+		len = BOOT_TRACE_NAME_SIZE - 1;
+
+	memcpy(dest, name, len);
+}
+
+/*
+ * Written last, just before the jump, so that it has the stages up to
+ * the jump. The device tree only needs its address, it is fixed up
+ * before.
+ */
+void boot_trace_save(void)
+{
+	struct boot_trace *trace = (struct boot_trace *)BOOT_TRACE_ADDR;
+	const char *name;
+	unsigned int usec;
+	unsigned int i;
+
+	memset(trace, 0, sizeof(*trace));
+
+	trace->magic = BOOT_TRACE_MAGIC;
+	trace->version = BOOT_TRACE_VERSION;
+	trace->length = sizeof(*trace);
+
+	for (i = 0; i < BOOT_TRACE_MAX_STAGES; i++) {
+		if (profile_get(i, &name, &usec))
+			break;
+
+		boot_trace_set_name(trace->stages[i].name, name);
+		trace->stages[i].usec = usec;
+	}
+	trace->num_stages = i;
+
+	for (i = 0; i < num_counters; i++) {
+		boot_trace_set_name(trace->media[i].name, counters[i].name);
+		trace->media[i].bytes = counters[i].bytes;
+		trace->media[i].ecc_corrected = counters[i].ecc_corrected;
+		trace->media[i].retries = counters[i].retries;
+	}
+	trace->num_media = num_counters;
+
+	trace->crc32 = crc32(0, (const unsigned char *)trace, sizeof(*trace));
+
+	dbg_info("TRACE: %d stages, %d media at %d\n",
+		trace->num_stages, trace->num_media, (unsigned int)trace);
+}
@@ -32,6 +32,15 @@
 #include "flash.h"
 #include "string.h"
 #include "usart.h"
+#include "debug.h"
+
+#ifdef CONFIG_LOAD_MANIFEST
+#include "manifest.h"
+#endif
+
+#ifdef CONFIG_OF_LIBFDT
+#include "fdt.h"
+#endif
 
 load_function load_image;
 
@@ -40,6 +49,9 @@ char filename[FILENAME_BUF_LEN];
 #ifdef CONFIG_OF_LIBFDT
 char of_filename[FILENAME_BUF_LEN];
 #endif
+#ifdef CONFIG_LOAD_INITRD
+char initrd_filename[FILENAME_BUF_LEN];
+#endif
 #endif
 
 void init_load_image(struct image_info *image)
@@ -50,12 +62,18 @@ void init_load_image(struct image_info *image)
 #ifdef CONFIG_OF_LIBFDT
 	memset(of_filename,	0, FILENAME_BUF_LEN);
 #endif
+#ifdef CONFIG_LOAD_INITRD
+	memset(initrd_filename,	0, FILENAME_BUF_LEN);
+#endif
 #endif
 
 	image->dest = (unsigned char *)JUMP_ADDR;
 #ifdef CONFIG_OF_LIBFDT
 	image->of_dest = (unsigned char *)OF_ADDRESS;
 #endif
+#ifdef CONFIG_LOAD_INITRD
+	image->initrd_dest = (unsigned char *)INITRD_ADDRESS;
+#endif
 
 #ifdef CONFIG_FLASH
 	image->offset = IMG_ADDRESS | 0x10000000;
@@ -65,6 +83,9 @@ void init_load_image(struct image_info *image)
 #ifdef CONFIG_OF_LIBFDT
 	image->of_offset = OF_OFFSET | 0x10000000;
 #endif
+#ifdef CONFIG_LOAD_INITRD
+	image->initrd_offset = INITRD_OFFSET | 0x10000000;
+#endif
 #endif
 
 #ifdef CONFIG_NANDFLASH
@@ -75,6 +96,9 @@ void init_load_image(struct image_info *image)
 #ifdef CONFIG_OF_LIBFDT
 	image->of_offset = OF_OFFSET;
 #endif
+#ifdef CONFIG_LOAD_INITRD
+	image->initrd_offset = INITRD_OFFSET;
+#endif
 #endif
 
 #ifdef CONFIG_DATAFLASH
@@ -85,6 +109,22 @@ void init_load_image(struct image_info *image)
 #ifdef CONFIG_OF_LIBFDT
 	image->of_offset = OF_OFFSET;
 #endif
+#ifdef CONFIG_LOAD_INITRD
+	image->initrd_offset = INITRD_OFFSET;
+#endif
+#endif
+
+#ifdef CONFIG_SDCARD_RAW
+	image->offset = IMG_ADDRESS;
+#if !defined(CONFIG_LOAD_LINUX) && !defined(CONFIG_LOAD_ANDROID)
+	image->length = IMG_SIZE;
+#endif
+#ifdef CONFIG_OF_LIBFDT
+	image->of_offset = OF_OFFSET;
+#endif
+#ifdef CONFIG_LOAD_INITRD
+	image->initrd_offset = INITRD_OFFSET;
+#endif
 #endif
 
 #ifdef CONFIG_SDCARD
@@ -93,6 +133,10 @@ void init_load_image(struct image_info *image)
 #ifdef CONFIG_OF_LIBFDT
 	image->of_filename = of_filename;
 #endif
+#if defined(CONFIG_LOAD_INITRD) && !defined(CONFIG_SDCARD_RAW)
+	image->initrd_filename = initrd_filename;
+	strcpy(image->initrd_filename, INITRD_NAME);
+#endif
 #endif
 
 #if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
@@ -112,6 +156,15 @@ void init_load_image(struct image_info *image)
 #endif
 }
 
+/* Stops the boot, once the console output buffered so far is sent */
+void hang(void)
+{
+	usart_flush();
+
+	while (1)
+		;
+}
+
 void load_image_done(int retval)
 {
 	char *media;
@@ -136,10 +189,48 @@ void load_image_done(int retval)
 	}
 	if (retval == -1) {
 		usart_puts("Failed to load image\n");
-		while(1);
+		hang();
 	}
 	if (retval == -2) {
 		usart_puts("Success to recovery\n");
-		while (1);
+		hang();
 	}
 }
+
+#if defined(CONFIG_LOAD_MANIFEST) \
+	&& (defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID))
+#ifdef CONFIG_OF_LIBFDT
+static int of_blob_length(unsigned char *header)
+{
+	if (check_dt_blob_valid(header)) {
+		dbg_info("DT: the blob is not a valid fdt\n");
+		return -1;
+	}
+
+	return of_get_dt_total_size(header);
+}
+#endif
+
+int image_manifest_add(struct image_info *image,
+			struct load_manifest *manifest)
+{
+#ifdef CONFIG_LOAD_INITRD
+	struct load_entry *entry;
+#endif
+
+#ifdef CONFIG_OF_LIBFDT
+	manifest_add(manifest, DT_BLOB, image->of_offset, image->of_dest,
+					&image->of_length, of_blob_length);
+#endif
+
+#ifdef CONFIG_LOAD_INITRD
+	entry = manifest_add(manifest, INITRD_IMAGE, image->initrd_offset,
+				image->initrd_dest, &image->initrd_length,
+				initrd_size);
+	if (entry)
+		entry->verify = initrd_verify;
+#endif
+
+	return manifest->overflow ? -1 : 0;
+}
+#endif
@@ -31,6 +31,7 @@
 #include "debug.h"
 #include "ddramc.h"
 #include "timer.h"
+#include "profile.h"
 
 /* write DDRC register */
 static void write_ddramc(unsigned int address,
@@ -281,6 +282,8 @@ int ddram_initialize(unsigned int base_address,
 	 */
 	udelay(10);
 
+	profile_mark("ddr init");
+
 	return 0;
 }
 
@@ -434,6 +437,8 @@ int lpddr2_sdram_initialize(unsigned int base_address,
 	write_ddramc(base_address, MPDDRC_LPDDR2_TIM_CAL,
 						ddramc_config->tim_calr);
 
+	profile_mark("ddr init");
+
 	return 0;
 }
 
@@ -579,6 +584,8 @@ int ddr3_sdram_initialize(unsigned int base_address,
 	 */
 	write_ddramc(base_address, HDDRSDRC2_RTR, ddramc_config->rtr);
 
+	profile_mark("ddr init");
+
 	return 0;
 }
 
@@ -707,6 +714,8 @@ int lpddr1_sdram_initialize(unsigned int base_address,
 	 */
 	write_ddramc(base_address, HDDRSDRC2_RTR, ddramc_config->rtr);
 
+	profile_mark("ddr init");
+
 	return 0;
 }
 
@@ -5,6 +5,8 @@ DRIVERS:=
 DRIVERS_SRC:=$(TOPDIR)/driver
 
 COBJS-$(CONFIG_DEBUG)		+= $(DRIVERS_SRC)/debug.o
+COBJS-$(CONFIG_BOOT_PROFILE)	+= $(DRIVERS_SRC)/profile.o
+COBJS-$(CONFIG_BOOT_TRACE)	+= $(DRIVERS_SRC)/boot_trace.o
 
 COBJS-$(CONFIG_SCLK)		+= $(DRIVERS_SRC)/at91_slowclk.o
 
@@ -62,7 +64,8 @@ COBJS-$(CONFIG_MACB)	+= $(DRIVERS_SRC)/macb.o
 COBJS-$(CONFIG_HDMI)	+= $(DRIVERS_SRC)/hdmi_SiI9022.o
 COBJS-$(CONFIG_WM8904)	+= $(DRIVERS_SRC)/wm8904.o
 
-COBJS-$(CONFIG_AES)		+= $(DRIVERS_SRC)/at91_aes.o
+COBJS-$(CONFIG_AT91_AES)	+= $(DRIVERS_SRC)/at91_aes.o
+COBJS-$(CONFIG_AT91_SHA)	+= $(DRIVERS_SRC)/at91_sha.o
 COBJS-$(CONFIG_SECURE)		+= $(DRIVERS_SRC)/secure.o
 
 COBJS-$(CONFIG_REDIRECT_ALL_INTS_AIC)	+= $(DRIVERS_SRC)/at91_aicredir.o
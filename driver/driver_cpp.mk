@@ -99,6 +99,84 @@ ifeq ($(CONFIG_OF_LIBFDT),y)
 CPPFLAGS += -DCONFIG_OF_LIBFDT
 endif
 
+ifeq ($(CONFIG_FIT),y)
+CPPFLAGS += -DCONFIG_FIT
+endif
+
+ifeq ($(CONFIG_FIT_VERIFY),y)
+CPPFLAGS += -DCONFIG_FIT_VERIFY
+endif
+
+ifeq ($(CONFIG_OF_OVERLAY),y)
+CPPFLAGS += -DCONFIG_OF_OVERLAY
+endif
+
+ifeq ($(CONFIG_OF_HW_INFO),y)
+CPPFLAGS += -DCONFIG_OF_HW_INFO
+endif
+
+OF_MAC_NODE := $(strip $(subst ",,$(CONFIG_OF_MAC_NODE)))
+ifeq ($(CONFIG_OF_MAC_ADDRESS),y)
+CPPFLAGS += -DCONFIG_OF_MAC_ADDRESS
+CPPFLAGS += -DOF_MAC_NODE="\"$(OF_MAC_NODE)\""
+endif
+
+OF_RESERVED_MEMORY_NAME := $(strip $(subst ",,$(CONFIG_OF_RESERVED_MEMORY_NAME)))
+OF_RESERVED_MEMORY_ADDR := $(strip $(subst ",,$(CONFIG_OF_RESERVED_MEMORY_ADDR)))
+OF_RESERVED_MEMORY_SIZE := $(strip $(subst ",,$(CONFIG_OF_RESERVED_MEMORY_SIZE)))
+ifeq ($(CONFIG_OF_RESERVED_MEMORY),y)
+CPPFLAGS += -DCONFIG_OF_RESERVED_MEMORY
+CPPFLAGS += -DOF_RESERVED_MEMORY_NAME="\"$(OF_RESERVED_MEMORY_NAME)\""
+CPPFLAGS += -DOF_RESERVED_MEMORY_SIZE=$(OF_RESERVED_MEMORY_SIZE)
+ifneq ($(OF_RESERVED_MEMORY_ADDR),)
+CPPFLAGS += -DOF_RESERVED_MEMORY_ADDR=$(OF_RESERVED_MEMORY_ADDR)
+endif
+endif
+
+ifeq ($(CONFIG_UIMAGE_VERIFY),y)
+CPPFLAGS += -DCONFIG_UIMAGE_VERIFY
+endif
+
+ifeq ($(CONFIG_CRC32_SLICE8),y)
+CPPFLAGS += -DCONFIG_CRC32_SLICE8
+endif
+
+ifeq ($(CONFIG_KERNEL_LZ4),y)
+CPPFLAGS += -DCONFIG_KERNEL_LZ4
+endif
+
+ifeq ($(CONFIG_KERNEL_GZIP),y)
+CPPFLAGS += -DCONFIG_KERNEL_GZIP
+endif
+
+KERNEL_RAW_COMP_SIZE := $(strip $(subst ",,$(CONFIG_KERNEL_RAW_COMP_SIZE)))
+ifneq ($(KERNEL_RAW_COMP_SIZE),)
+CPPFLAGS += -DKERNEL_RAW_COMP_SIZE=$(KERNEL_RAW_COMP_SIZE)
+endif
+
+INITRD_OFFSET := $(strip $(subst ",,$(CONFIG_INITRD_OFFSET)))
+INITRD_NAME := $(strip $(subst ",,$(CONFIG_INITRD_NAME)))
+INITRD_ADDRESS := $(strip $(subst ",,$(CONFIG_INITRD_ADDRESS)))
+ifeq ($(CONFIG_LOAD_INITRD),y)
+CPPFLAGS += -DCONFIG_LOAD_INITRD
+CPPFLAGS += -DINITRD_ADDRESS=$(INITRD_ADDRESS)
+ifneq ($(INITRD_OFFSET),)
+CPPFLAGS += -DINITRD_OFFSET=$(INITRD_OFFSET)
+endif
+ifneq ($(INITRD_NAME),)
+CPPFLAGS += -DINITRD_NAME="\"$(INITRD_NAME)\""
+endif
+endif
+
+ifeq ($(CONFIG_KERNEL_STREAM),y)
+CPPFLAGS += -DCONFIG_KERNEL_STREAM
+endif
+
+KERNEL_STREAM_BUFSIZE := $(strip $(subst ",,$(CONFIG_KERNEL_STREAM_BUFSIZE)))
+ifneq ($(KERNEL_STREAM_BUFSIZE),)
+CPPFLAGS += -DKERNEL_STREAM_BUFSIZE=$(KERNEL_STREAM_BUFSIZE)
+endif
+
 # Dataflash support
 ifeq ($(CONFIG_DATAFLASH_RECOVERY),y)
 CPPFLAGS += -DCONFIG_DATAFLASH_RECOVERY
@@ -329,6 +407,22 @@ ifeq ($(CONFIG_SECURE), y)
 CPPFLAGS += -DCONFIG_SECURE
 endif
 
+ifeq ($(CONFIG_AES_DMA), y)
+CPPFLAGS += -DCONFIG_AES_DMA
+endif
+
+ifeq ($(CONFIG_SECURE_DIGEST), y)
+CPPFLAGS += -DCONFIG_SECURE_DIGEST
+endif
+
+ifeq ($(CONFIG_SECURE_GCM), y)
+CPPFLAGS += -DCONFIG_SECURE_GCM
+endif
+
+ifeq ($(CONFIG_SECURE_STREAM), y)
+CPPFLAGS += -DCONFIG_SECURE_STREAM
+endif
+
 ifeq ($(CPU_HAS_PIO4), y)
 CPPFLAGS += -DCPU_HAS_PIO4
 endif
@@ -349,6 +443,10 @@ ifeq ($(CONFIG_AT91_MCI1), y)
 CPPFLAGS += -DCONFIG_AT91_MCI1
 endif
 
+ifeq ($(CONFIG_AT91_MCI_DMA), y)
+CPPFLAGS += -DCONFIG_AT91_MCI_DMA
+endif
+
 ifeq ($(CONFIG_SDHC), y)
 CPPFLAGS += -DCONFIG_SDHC
 endif
@@ -361,6 +459,54 @@ ifeq ($(CONFIG_SDHC1), y)
 CPPFLAGS += -DCONFIG_SDHC1
 endif
 
+ifeq ($(CONFIG_SDHC_ADMA), y)
+CPPFLAGS += -DCONFIG_SDHC_ADMA
+endif
+
+ifeq ($(CONFIG_FATFS), y)
+CPPFLAGS += -DCONFIG_FATFS_CACHE_SECTORS=$(CONFIG_FATFS_CACHE_SECTORS)
+endif
+
+ifeq ($(CONFIG_LOAD_MANIFEST), y)
+CPPFLAGS += -DCONFIG_LOAD_MANIFEST
+endif
+
+ifeq ($(CONFIG_SDCARD_WARM_INIT), y)
+CPPFLAGS += -DCONFIG_SDCARD_WARM_INIT
+CPPFLAGS += -DCONFIG_SDCARD_WARM_STATE_ADDR=$(CONFIG_SDCARD_WARM_STATE_ADDR)
+endif
+
+ifeq ($(CONFIG_SDCARD_RAW), y)
+CPPFLAGS += -DCONFIG_SDCARD_RAW
+endif
+
+ifeq ($(CONFIG_SDCARD_RAW_BOOTPART), y)
+CPPFLAGS += -DCONFIG_SDCARD_RAW_BOOTPART
+CPPFLAGS += -DCONFIG_SDCARD_BOOTPART=$(CONFIG_SDCARD_BOOTPART)
+endif
+
+ifeq ($(CONFIG_SDCARD_RAW_GPT), y)
+CPPFLAGS += -DCONFIG_SDCARD_RAW_GPT
+SDCARD_GPT_IMG_PART := $(strip $(subst ",,$(CONFIG_SDCARD_GPT_IMG_PART)))
+CPPFLAGS += -DCONFIG_SDCARD_GPT_IMG_PART="\"$(SDCARD_GPT_IMG_PART)\""
+ifeq ($(CONFIG_OF_LIBFDT), y)
+SDCARD_GPT_OF_PART := $(strip $(subst ",,$(CONFIG_SDCARD_GPT_OF_PART)))
+CPPFLAGS += -DCONFIG_SDCARD_GPT_OF_PART="\"$(SDCARD_GPT_OF_PART)\""
+endif
+ifeq ($(CONFIG_LOAD_INITRD), y)
+SDCARD_GPT_INITRD_PART := $(strip $(subst ",,$(CONFIG_SDCARD_GPT_INITRD_PART)))
+CPPFLAGS += -DCONFIG_SDCARD_GPT_INITRD_PART="\"$(SDCARD_GPT_INITRD_PART)\""
+endif
+endif
+
+ifeq ($(CONFIG_SDHC_UHS), y)
+CPPFLAGS += -DCONFIG_SDHC_UHS
+endif
+
+ifeq ($(CONFIG_SDHC_HS200), y)
+CPPFLAGS += -DCONFIG_SDHC_HS200
+endif
+
 ifeq ($(CONFIG_SPI_BUS0), y)
 CPPFLAGS += -DCONFIG_SPI_BUS0
 endif
@@ -31,64 +31,138 @@
 #include "string.h"
 #include "debug.h"
 #include "fdt.h"
+#include "fit.h"
+#include "secure.h"
+#include "manifest.h"
+#include "profile.h"
+#include "boot_trace.h"
 
 #include "debug.h"
 
+/* The flash is memory mapped, every read of the images is a copy */
+static void norflash_copy(unsigned char *dest, unsigned int offset,
+			  unsigned int len)
+{
+	memcpy(dest, (const char *)offset, len);
+
+	boot_trace_read("FLASH", len);
+}
+
 #if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
 
 static int update_image_length(unsigned int offset,
-			       unsigned char *dest,
-			       unsigned char flag)
+			       unsigned char *dest)
 {
 	unsigned int length = 512;
 
 	dbg_info("FLASH: update image length from image\n");
 
-	memcpy(dest, (const char *)offset, length);
+	norflash_copy(dest, offset, length);
 
-	if (flag == KERNEL_IMAGE)
-		return kernel_size(dest);
-#ifdef CONFIG_OF_LIBFDT
-	else
-		return of_get_dt_total_size((void *)dest);
-#else
-	return -1;
+	return kernel_size(dest);
+}
 #endif
+
+static int norflash_read(void *priv, unsigned int offset,
+			 unsigned int len, unsigned char *dest)
+{
+	norflash_copy(dest, offset, len);
+
+	return 0;
+}
+
+#ifdef CONFIG_FIT
+static int norflash_read_fit(void *priv, unsigned int offset,
+				unsigned int len, unsigned char *dest)
+{
+	unsigned int *fit_offset = priv;
+
+	norflash_copy(dest, *fit_offset + offset, len);
+
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_KERNEL_STREAM) || defined(CONFIG_SECURE_STREAM)
+static int norflash_read_stream(void *priv, unsigned char *buf,
+				unsigned int len)
+{
+	unsigned int *offset = priv;
+
+	norflash_copy(buf, *offset, len);
+	*offset += len;
+
+	return len;
 }
 #endif
 
 int load_norflash(struct image_info *image)
 {
+	struct load_manifest manifest;
 	int length = 0;
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	struct kernel_payload payload;
+#endif
 
 	norflash_hw_init();
 
+	profile_mark("media probe");
+
+	manifest_init(&manifest, "FLASH");
+
 #if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
-	length = update_image_length(image->offset, image->dest, KERNEL_IMAGE);
+	length = update_image_length(image->offset, image->dest);
 	if (length == -1)
 		return -1;
 
 	image->length = length;
 #endif
 
-	dbg_info("FLASH: copy %d bytes from %x to %x\n",
-		 image->length, image->offset, image->dest);
+#ifdef CONFIG_FIT
+	if (fit_check_header(image->dest) == 0)
+		return fit_load(image, norflash_read_fit, &image->offset);
+#endif
 
-	memcpy(image->dest, (const char *)image->offset, image->length);
+#ifdef CONFIG_KERNEL_STREAM
+	if (kernel_is_compressed(image->dest)) {
+		unsigned int offset = image->offset;
 
-#ifdef CONFIG_OF_LIBFDT
-	length = update_image_length(image->of_offset,
-				     image->of_dest, DT_BLOB);
-	if (length == -1)
-		return -1;
+		dbg_info("FLASH: stream %d bytes from %x\n",
+			 image->length, image->offset);
 
-	image->of_length = length;
+		if (load_kernel_stream(image, image->length,
+					norflash_read_stream, NULL, &offset))
+			return -1;
+	} else
+#endif
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (kernel_get_payload(image, 512, &payload) == 0) {
+		manifest_add(&manifest, KERNEL_IMAGE,
+			     image->offset + payload.offset, payload.dest,
+			     &payload.size, NULL);
+	} else
+#endif
+#ifdef CONFIG_SECURE_STREAM
+	{
+		unsigned int offset = image->offset;
 
-	dbg_info("FLASH: dt blob: Copy %d bytes from %d to %d\n",
-		image->of_length, image->of_offset, image->of_dest);
+		dbg_info("FLASH: stream from %x to %x\n",
+			 image->offset, image->dest);
 
-	memcpy(image->of_dest,
-	       (const char *)image->of_offset, image->of_length);
+		if (secure_load_stream(image, norflash_read_stream, &offset))
+			return -1;
+	}
+#else
+	{
+		manifest_add(&manifest, KERNEL_IMAGE, image->offset,
+			     image->dest, &image->length, NULL);
+	}
 #endif
-	return 0;
+
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (image_manifest_add(image, &manifest))
+		return -1;
+#endif
+
+	return manifest_load(&manifest, norflash_read, NULL, 512);
 }
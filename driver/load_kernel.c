@@ -39,17 +39,57 @@
 #include "board_hw_info.h"
 #include "mon.h"
 #include "tz_utils.h"
+#include "profile.h"
+#include "boot_trace.h"
+#include "usart.h"
 
 #include "debug.h"
 
+#ifdef CONFIG_KERNEL_STREAM
+#include "timer.h"
+#endif
+
+#ifdef CONFIG_FIT
+#include "fit.h"
+#endif
+
+#ifdef CONFIG_UIMAGE_VERIFY
+#include "crc32.h"
+#endif
+
+#ifdef CONFIG_OF_MAC_ADDRESS
+#include "at24xx.h"
+#endif
+
+#if defined(CONFIG_OF_RESERVED_MEMORY) && !defined(OF_RESERVED_MEMORY_ADDR)
+#define OF_RESERVED_MEMORY_ADDR	(MEM_BANK + MEM_SIZE - OF_RESERVED_MEMORY_SIZE)
+#endif
+
+#if defined(CONFIG_KERNEL_GZIP) || defined(CONFIG_KERNEL_LZ4)
+#define KERNEL_DECOMPRESS
+#include "decompress.h"
+#endif
+
 static char *bootargs = CMDLINE;
 
+#ifdef CONFIG_LOAD_INITRD
+/* The ramdisk data passed to Linux, none if initrd_end is 0 */
+static unsigned int initrd_start;
+static unsigned int initrd_end;
+#endif
+
 #ifdef CONFIG_OF_LIBFDT
 
 static int setup_dt_blob(void *blob)
 {
 	unsigned int mem_bank = MEM_BANK;
 	unsigned int mem_size = MEM_SIZE;
+#ifdef CONFIG_OF_MAC_ADDRESS
+	unsigned char mac[6];
+#endif
+#ifdef CONFIG_FIT
+	struct fit_image *ramdisk;
+#endif
 	int ret;
 
 	if (check_dt_blob_valid(blob)) {
@@ -70,16 +110,68 @@ static int setup_dt_blob(void *blob)
 		if (*p == '\0')
 			return -1;
 
-		ret = fixup_chosen_node(blob, p);
+		ret = fixup_chosen_node(p);
 		if (ret)
 			return ret;
 	}
 
-	ret = fixup_memory_node(blob, &mem_bank, &mem_size);
+	ret = fixup_memory_node(&mem_bank, &mem_size);
 	if (ret)
 		return ret;
 
-	return 0;
+#ifdef CONFIG_OF_HW_INFO
+	ret = fixup_board_info(get_sys_sn(), get_sys_rev());
+	if (ret)
+		return ret;
+#endif
+
+#ifdef CONFIG_OF_MAC_ADDRESS
+	/* without an address, the one of the blob is kept */
+	if (load_at24mac_address(mac) == 0) {
+		ret = fixup_mac_address(OF_MAC_NODE, mac);
+		if (ret)
+			return ret;
+	}
+#endif
+
+#ifdef CONFIG_OF_RESERVED_MEMORY
+	ret = fixup_reserved_memory(blob, OF_RESERVED_MEMORY_NAME,
+				OF_RESERVED_MEMORY_ADDR,
+				OF_RESERVED_MEMORY_SIZE);
+	if (ret)
+		return ret;
+#endif
+
+#ifdef CONFIG_BOOT_TRACE
+	ret = fixup_reserved_memory(blob, "boot-trace",
+				BOOT_TRACE_ADDR, BOOT_TRACE_SIZE);
+	if (ret)
+		return ret;
+
+	ret = fixup_chosen_boot_trace(BOOT_TRACE_ADDR, BOOT_TRACE_SIZE);
+	if (ret)
+		return ret;
+#endif
+
+#ifdef CONFIG_LOAD_INITRD
+	if (initrd_end) {
+		ret = fixup_chosen_initrd(initrd_start, initrd_end);
+		if (ret)
+			return ret;
+	}
+#endif
+
+#ifdef CONFIG_FIT
+	ramdisk = fit_get_ramdisk();
+	if (ramdisk) {
+		ret = fixup_chosen_initrd(ramdisk->data,
+					ramdisk->data + ramdisk->size);
+		if (ret)
+			return ret;
+	}
+#endif
+
+	return of_fixup_apply(blob);
 }
 #else
 #define TAG_FLAG_NONE		0x00000000
@@ -88,12 +180,14 @@ static int setup_dt_blob(void *blob)
 #define TAG_FLAG_SERIAL		0x54410006
 #define TAG_FLAG_REVISION	0x54410007
 #define TAG_FLAG_CMDLINE	0x54410009
+#define TAG_FLAG_INITRD2	0x54420005
 
 #define	TAG_SIZE_HEADER		8
 #define TAG_SIZE_CORE		5
 #define TAG_SIZE_MEM32		4
 #define TAG_SIZE_SERIAL		4
 #define TAG_SIZE_REVISION	3
+#define TAG_SIZE_INITRD		4
 
 struct tag_header {
 	unsigned int	size;
@@ -124,6 +218,12 @@ struct tag_revision {
 	unsigned int		version;
 };
 
+struct tag_initrd {
+	struct tag_header	header;
+	unsigned int		start;
+	unsigned int		size;
+};
+
 struct tag_cmdline {
 	struct tag_header	header;
 	char			cmdline[1];
@@ -153,6 +253,21 @@ static void setup_commandline_tag(struct tag_cmdline *params,
 	strcpy(params->cmdline, p);
 }
 
+static unsigned int *setup_mem_tag(unsigned int *params,
+				unsigned int start,
+				unsigned int size)
+{
+	struct tag_mem32 *memparam = (struct tag_mem32 *)params;
+
+	memparam->header.tag = TAG_FLAG_MEM;
+	memparam->header.size = TAG_SIZE_MEM32;
+
+	memparam->start = start;
+	memparam->size = size;
+
+	return params + TAG_SIZE_MEM32;
+}
+
 static void setup_boot_params(void)
 {
 	unsigned int *params = (unsigned int *)(MEM_BANK + 0x100);
@@ -167,14 +282,20 @@ static void setup_boot_params(void)
 
 	params = (unsigned int *)params + TAG_SIZE_CORE;
 
-	struct tag_mem32 *memparam = (struct tag_mem32 *)params;
-	memparam->header.tag = TAG_FLAG_MEM;
-	memparam->header.size = TAG_SIZE_MEM32;
-
-	memparam->start = MEM_BANK;
-	memparam->size = MEM_SIZE;
-
-	params = (unsigned int *)params + TAG_SIZE_MEM32;
+#ifdef CONFIG_BOOT_TRACE
+	/* without a device tree to reserve it, the trace is left out */
+	if (BOOT_TRACE_ADDR > MEM_BANK)
+		params = setup_mem_tag(params, MEM_BANK,
+				BOOT_TRACE_ADDR - MEM_BANK);
+
+	if (BOOT_TRACE_ADDR + BOOT_TRACE_SIZE < MEM_BANK + MEM_SIZE)
+		params = setup_mem_tag(params,
+				BOOT_TRACE_ADDR + BOOT_TRACE_SIZE,
+				MEM_BANK + MEM_SIZE
+				- BOOT_TRACE_ADDR - BOOT_TRACE_SIZE);
+#else
+	params = setup_mem_tag(params, MEM_BANK, MEM_SIZE);
+#endif
 
 	struct tag_cmdline *cmdparam = (struct tag_cmdline *)params;
 	setup_commandline_tag(cmdparam, bootargs);
@@ -198,6 +319,18 @@ static void setup_boot_params(void)
 	params = (unsigned int *)params + TAG_SIZE_SERIAL;
 #endif
 
+#ifdef CONFIG_LOAD_INITRD
+	if (initrd_end) {
+		struct tag_initrd *initrdparam = (struct tag_initrd *)params;
+		initrdparam->header.tag = TAG_FLAG_INITRD2;
+		initrdparam->header.size = TAG_SIZE_INITRD;
+		initrdparam->start = initrd_start;
+		initrdparam->size = initrd_end - initrd_start;
+
+		params = (unsigned int *)params + TAG_SIZE_INITRD;
+	}
+#endif
+
 	/* end tag */
 	struct tag_none * noneparam = (struct tag_none *)params;
 	noneparam->header.tag = TAG_FLAG_NONE;
@@ -223,6 +356,43 @@ struct linux_uimage_header {
 	unsigned char	name[32];
 };
 
+/* uImage compression types */
+#define IH_COMP_NONE		0
+#define IH_COMP_GZIP		1
+#define IH_COMP_LZ4		5
+
+#ifdef CONFIG_UIMAGE_VERIFY
+/* The header CRC is computed with the header_crc field cleared */
+static int uimage_check_header(struct linux_uimage_header *uimage_header)
+{
+	struct linux_uimage_header header;
+	unsigned int crc;
+
+	memcpy(&header, uimage_header, sizeof(header));
+	header.header_crc = 0;
+
+	crc = crc32(0, (unsigned char *)&header, sizeof(header));
+	if (crc != swap_uint32(uimage_header->header_crc)) {
+		dbg_info("Bad uImage header crc32: %d, expected: %d\n",
+			crc, swap_uint32(uimage_header->header_crc));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int uimage_check_data(unsigned int data_crc, unsigned int crc)
+{
+	if (crc != data_crc) {
+		dbg_info("Bad uImage data crc32: %d, expected: %d\n",
+							crc, data_crc);
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
 /* Linux zImage Header */
 #define	LINUX_ZIMAGE_MAGIC	0x016f2818
 struct linux_zimage_header {
@@ -232,6 +402,405 @@ struct linux_zimage_header {
 	unsigned int	end;
 };
 
+#ifdef KERNEL_DECOMPRESS
+/*
+ * A raw compressed kernel is an Image, which runs where it is
+ * decompressed: at the start of the RAM plus the ARM TEXT_OFFSET.
+ */
+#define KERNEL_TEXT_OFFSET	0x8000
+
+static unsigned int raw_comp_type(unsigned char *addr)
+{
+	unsigned int magic = addr[0] | (addr[1] << 8)
+				| (addr[2] << 16) | (addr[3] << 24);
+
+#ifdef CONFIG_KERNEL_GZIP
+	if ((magic & 0xffff) == GZIP_MAGIC)
+		return IH_COMP_GZIP;
+#endif
+#ifdef CONFIG_KERNEL_LZ4
+	if ((magic == LZ4_FRAME_MAGIC) || (magic == LZ4_LEGACY_MAGIC))
+		return IH_COMP_LZ4;
+#endif
+	return IH_COMP_NONE;
+}
+
+/*
+ * The output must stop before the compressed image, at "src", and the
+ * DT blob when they are loaded above the destination. A streamed image
+ * is not in the RAM, its "src" is 0.
+ */
+static unsigned int decompress_limit(struct image_info *image,
+					unsigned int src,
+					unsigned int dest)
+{
+	unsigned int limit = MEM_BANK + MEM_SIZE;
+#ifdef CONFIG_FIT
+	struct fit_image *ramdisk;
+#endif
+
+	if ((src > dest) && (src < limit))
+		limit = src;
+#ifdef CONFIG_OF_LIBFDT
+	if (((unsigned int)image->of_dest > dest)
+		&& ((unsigned int)image->of_dest < limit))
+		limit = (unsigned int)image->of_dest;
+#endif
+#ifdef CONFIG_LOAD_INITRD
+	/* a streamed kernel is decompressed before the ramdisk is read */
+	if (((unsigned int)image->initrd_dest > dest)
+		&& ((unsigned int)image->initrd_dest < limit))
+		limit = (unsigned int)image->initrd_dest;
+#endif
+#ifdef CONFIG_FIT
+	ramdisk = fit_get_ramdisk();
+	if (ramdisk && (ramdisk->data > dest) && (ramdisk->data < limit))
+		limit = ramdisk->data;
+#endif
+
+	return limit;
+}
+
+static int decompress_kernel(unsigned int comp_type,
+				struct decomp_stream *stream,
+				unsigned int dest,
+				unsigned int limit)
+{
+	int ret;
+
+	if (limit <= dest) {
+		dbg_info("No room to decompress kernel image at %d\n", dest);
+		return -1;
+	}
+
+	switch (comp_type) {
+#ifdef CONFIG_KERNEL_GZIP
+	case IH_COMP_GZIP:
+		ret = gunzip_stream(stream,
+				(unsigned char *)dest, limit - dest);
+		break;
+#endif
+#ifdef CONFIG_KERNEL_LZ4
+	case IH_COMP_LZ4:
+		ret = lz4_stream(stream,
+				(unsigned char *)dest, limit - dest);
+		break;
+#endif
+	default:
+		dbg_info("The uImage compress type not supported\n");
+		return -1;
+	}
+
+	if (ret < 0) {
+		dbg_info("Failed to decompress kernel image: %d\n", -ret);
+		return -1;
+	}
+
+	dbg_info(" ...... %d bytes data decompressed\n", ret);
+
+	return 0;
+}
+
+static int decompress_image(struct image_info *image,
+				unsigned int comp_type,
+				unsigned char *src,
+				unsigned int size,
+				unsigned int dest)
+{
+	struct decomp_stream stream;
+
+	dbg_info("Decompressing kernel image, dest: %d, src: %d\n",
+			dest, (unsigned int)src);
+
+	memset(&stream, 0, sizeof(stream));
+	stream.buf = src;
+	stream.len = size;
+
+	return decompress_kernel(comp_type, &stream, dest,
+			decompress_limit(image, (unsigned int)src, dest));
+}
+#endif
+
+#ifdef CONFIG_KERNEL_STREAM
+#ifndef KERNEL_STREAM_BUFSIZE
+#define KERNEL_STREAM_BUFSIZE	4096
+#endif
+
+/*
+ * With a media able to read by DMA, the next buffer is read while the
+ * last one is decompressed.
+ */
+#if defined(CONFIG_SDCARD_RAW) \
+	&& (defined(CONFIG_AT91_MCI_DMA) || defined(CONFIG_SDHC_ADMA))
+#define KERNEL_STREAM_BUFS	2
+#else
+#define KERNEL_STREAM_BUFS	1
+#endif
+
+struct kernel_stream {
+	image_read_function	read;
+	struct image_read_async	*async;
+	void			*priv;
+	unsigned int		left;	/* image bytes not read yet */
+	unsigned int		next;	/* buffer read next */
+	int			pending; /* its read is started */
+	unsigned int		ticks;	/* time spent waiting for the media */
+#ifdef CONFIG_UIMAGE_VERIFY
+	int			verify;
+	unsigned int		crc;	/* of the uImage data read */
+#endif
+};
+
+static unsigned int stream_buf[KERNEL_STREAM_BUFS][KERNEL_STREAM_BUFSIZE / 4];
+
+/* The entry point of the kernel decompressed by load_kernel_stream() */
+static unsigned int stream_entry;
+
+static int kernel_stream_read(struct kernel_stream *kstream,
+				unsigned char *buf)
+{
+	if (!kstream->async)
+		return kstream->read(kstream->priv, buf, KERNEL_STREAM_BUFSIZE);
+
+	if (!kstream->pending) {
+		if (kstream->async->start(kstream->priv,
+					buf, KERNEL_STREAM_BUFSIZE))
+			return -1;
+	}
+
+	kstream->pending = 0;
+
+	return kstream->async->wait(kstream->priv);
+}
+
+/* The read started for the data after the end of the kernel */
+static void kernel_stream_drain(struct kernel_stream *kstream)
+{
+	if (kstream->pending) {
+		kstream->pending = 0;
+		kstream->async->wait(kstream->priv);
+	}
+}
+
+static int kernel_stream_fill(struct decomp_stream *stream)
+{
+	struct kernel_stream *kstream = stream->priv;
+	unsigned char *buf = (unsigned char *)stream_buf[kstream->next];
+	unsigned int start;
+	int ret;
+
+	if (kstream->left == 0)
+		return 0;
+
+	start = timer_get_ticks();
+	ret = kernel_stream_read(kstream, buf);
+	if (ret <= 0)
+		return ret;
+
+	/* the media reads in its own units, maybe past the image end */
+	if ((unsigned int)ret > kstream->left)
+		ret = kstream->left;
+
+	kstream->left -= ret;
+	stream->buf = buf;
+
+	if (++kstream->next == KERNEL_STREAM_BUFS)
+		kstream->next = 0;
+
+	/* the other buffer is read while this one is decompressed */
+	if (kstream->async && kstream->left) {
+		if (kstream->async->start(kstream->priv,
+				(unsigned char *)stream_buf[kstream->next],
+				KERNEL_STREAM_BUFSIZE))
+			return -1;
+
+		kstream->pending = 1;
+	}
+
+	kstream->ticks += timer_get_ticks() - start;
+
+#ifdef CONFIG_UIMAGE_VERIFY
+	if (kstream->verify)
+		kstream->crc = crc32(kstream->crc, buf, ret);
+#endif
+
+	return ret;
+}
+
+int kernel_is_compressed(unsigned char *addr)
+{
+	struct linux_uimage_header *uimage_header
+			= (struct linux_uimage_header *)addr;
+
+	if (swap_uint32(uimage_header->magic) == LINUX_UIMAGE_MAGIC)
+		return uimage_header->comp_type != IH_COMP_NONE;
+
+	return raw_comp_type(addr) != IH_COMP_NONE;
+}
+
+/*
+ * Decompress the kernel image of "length" bytes while it is read, one
+ * buffer at a time, from the media. The media calls it instead of
+ * loading the image when kernel_is_compressed() finds its header. A
+ * media which gives "async" has the next buffer read meanwhile.
+ */
+int load_kernel_stream(struct image_info *image, unsigned int length,
+			image_read_function read,
+			struct image_read_async *async, void *priv)
+{
+	struct linux_uimage_header *uimage_header
+			= (struct linux_uimage_header *)stream_buf[0];
+	struct kernel_stream kstream;
+	struct decomp_stream stream;
+	unsigned int comp_type;
+	unsigned int dest, entry;
+	unsigned int start, ticks;
+#ifdef CONFIG_UIMAGE_VERIFY
+	unsigned int data_crc = 0;
+#endif
+	int ret;
+
+	kstream.read = read;
+	kstream.async = (KERNEL_STREAM_BUFS > 1) ? async : NULL;
+	kstream.priv = priv;
+	kstream.left = length;
+	kstream.next = 0;
+	kstream.pending = 0;
+	kstream.ticks = 0;
+#ifdef CONFIG_UIMAGE_VERIFY
+	kstream.verify = 0;
+#endif
+
+	memset(&stream, 0, sizeof(stream));
+	stream.fill = kernel_stream_fill;
+	stream.priv = &kstream;
+
+	start = timer_get_ticks();
+
+	ret = stream_refill(&stream);
+	if (ret || (stream.len < sizeof(struct linux_uimage_header))) {
+		dbg_info("Failed to read kernel image\n");
+		ret = -1;
+		goto out;
+	}
+
+	if (swap_uint32(uimage_header->magic) == LINUX_UIMAGE_MAGIC) {
+		dbg_info("\nBooting uImage ......\n");
+
+		comp_type = uimage_header->comp_type;
+		dest = swap_uint32(uimage_header->load);
+		entry = swap_uint32(uimage_header->entry_point);
+
+		stream.pos = sizeof(struct linux_uimage_header);
+
+#ifdef CONFIG_UIMAGE_VERIFY
+		if (uimage_check_header(uimage_header)) {
+			ret = -1;
+			goto out;
+		}
+
+		/* the first chunk here, the next ones as they are read */
+		data_crc = swap_uint32(uimage_header->data_crc);
+		kstream.crc = crc32(0, stream.buf + stream.pos,
+						stream.len - stream.pos);
+		kstream.verify = 1;
+#endif
+	} else {
+		dbg_info("\nBooting compressed Image ......\n");
+
+		comp_type = raw_comp_type((unsigned char *)stream_buf[0]);
+		dest = MEM_BANK + KERNEL_TEXT_OFFSET;
+		entry = dest;
+	}
+
+	dbg_info("Decompressing kernel image while reading it, dest: %d\n",
+			dest);
+
+	ret = decompress_kernel(comp_type, &stream, dest,
+				decompress_limit(image, 0, dest));
+	if (ret)
+		goto out;
+
+#ifdef CONFIG_UIMAGE_VERIFY
+	if (kstream.verify) {
+		/* the data after the end of the compressed stream */
+		do {
+			ret = kernel_stream_fill(&stream);
+		} while (ret > 0);
+
+		if (ret || uimage_check_data(data_crc, kstream.crc)) {
+			ret = -1;
+			goto out;
+		}
+	}
+#endif
+
+	ticks = timer_get_ticks() - start;
+	dbg_info(" ...... read: %d ms, decompress: %d ms\n",
+			timer_ticks_to_ms(kstream.ticks),
+			timer_ticks_to_ms(ticks - kstream.ticks));
+
+	stream_entry = entry;
+
+out:
+	kernel_stream_drain(&kstream);
+
+	return ret;
+}
+#endif
+
+/*
+ * The header of the uImage whose payload the media read straight to its
+ * load address, the payload may overwrite the one at image->dest.
+ */
+static struct linux_uimage_header uimage_in_place;
+
+/*
+ * An uncompressed uImage is not loaded to image->dest and relocated, its
+ * payload is read by the media to the load address. The first "loaded"
+ * bytes of the image, read to image->dest by the media to know its size,
+ * hold the header and the start of the payload, which is moved to the
+ * load address. Returns 0 with the rest of the payload to read.
+ */
+int kernel_get_payload(struct image_info *image, unsigned int loaded,
+			struct kernel_payload *payload)
+{
+	struct linux_uimage_header *uimage_header
+			= (struct linux_uimage_header *)image->dest;
+	unsigned int header_size = sizeof(struct linux_uimage_header);
+	unsigned int size, head;
+	unsigned char *dest;
+
+	if ((swap_uint32(uimage_header->magic) != LINUX_UIMAGE_MAGIC)
+		|| (uimage_header->comp_type != IH_COMP_NONE)
+		|| (loaded < header_size))
+		return -1;
+
+#ifdef CONFIG_UIMAGE_VERIFY
+	/* before trusting the load address */
+	if (uimage_check_header(uimage_header))
+		return -1;
+#endif
+
+	size = swap_uint32(uimage_header->size);
+	dest = (unsigned char *)swap_uint32(uimage_header->load);
+
+	memcpy(&uimage_in_place, uimage_header, header_size);
+
+	head = loaded - header_size;
+	if (head > size)
+		head = size;
+
+	/* the load address may overlap image->dest */
+	memmove(dest, image->dest + header_size, head);
+
+	payload->offset = loaded;
+	payload->size = size - head;
+	payload->dest = dest + head;
+
+	return 0;
+}
+
 int kernel_size(unsigned char *addr)
 {
 	struct linux_uimage_header *uimage_header
@@ -249,14 +818,106 @@ int kernel_size(unsigned char *addr)
 	if (zimage_header->magic == LINUX_ZIMAGE_MAGIC)
 		size = zimage_header->end - zimage_header->start;
 
+#ifdef CONFIG_FIT
+	/* The tree, the data may follow it */
+	if (fit_check_header(addr) == 0)
+		size = of_get_dt_total_size(addr);
+#endif
+
+#ifdef KERNEL_RAW_COMP_SIZE
+	/* The raw compressed formats do not tell their size */
+	if (raw_comp_type(addr) != IH_COMP_NONE)
+		size = KERNEL_RAW_COMP_SIZE;
+#endif
+
 	if ((int)size < 0)
 		return -1;
 
 	return (int)size;
 }
 
-static int boot_image_setup(unsigned char *addr, unsigned int *entry)
+#ifdef CONFIG_LOAD_INITRD
+/* The ramdisk read by offset is a uImage, to know its size */
+int initrd_size(unsigned char *addr)
 {
+	struct linux_uimage_header *uimage_header
+			= (struct linux_uimage_header *)addr;
+
+	if (swap_uint32(uimage_header->magic) != LINUX_UIMAGE_MAGIC) {
+		dbg_info("** Bad initrd uImage magic: %d\n",
+				swap_uint32(uimage_header->magic));
+		return -1;
+	}
+
+	return swap_uint32(uimage_header->size)
+			+ sizeof(struct linux_uimage_header);
+}
+
+/*
+ * A uImage ramdisk is passed as it is read, its data must not be
+ * compressed. A plain one has nothing to check.
+ */
+int initrd_verify(unsigned char *addr, unsigned int length)
+{
+	struct linux_uimage_header *uimage_header
+			= (struct linux_uimage_header *)addr;
+#ifdef CONFIG_UIMAGE_VERIFY
+	unsigned int crc;
+#endif
+
+	if ((length < sizeof(struct linux_uimage_header))
+		|| (swap_uint32(uimage_header->magic) != LINUX_UIMAGE_MAGIC))
+		return 0;
+
+#ifdef CONFIG_UIMAGE_VERIFY
+	if (uimage_check_header(uimage_header))
+		return -1;
+
+	crc = crc32(0, addr + sizeof(struct linux_uimage_header),
+				swap_uint32(uimage_header->size));
+	if (uimage_check_data(swap_uint32(uimage_header->data_crc), crc))
+		return -1;
+#endif
+
+	if (uimage_header->comp_type != IH_COMP_NONE) {
+		dbg_info("The initrd uImage compress type not supported\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * The media read and verified the ramdisk at image->initrd_dest, the
+ * data of a uImage follows its header. Nothing is read when a FIT
+ * image is booted, it brings its own ramdisk.
+ */
+static void initrd_setup(struct image_info *image)
+{
+	struct linux_uimage_header *uimage_header
+			= (struct linux_uimage_header *)image->initrd_dest;
+	unsigned int start = (unsigned int)image->initrd_dest;
+	unsigned int size = image->initrd_length;
+
+	if (size == 0)
+		return;
+
+	if ((size >= sizeof(struct linux_uimage_header))
+		&& (swap_uint32(uimage_header->magic) == LINUX_UIMAGE_MAGIC)) {
+		start += sizeof(struct linux_uimage_header);
+		size = swap_uint32(uimage_header->size);
+	}
+
+	dbg_info("initrd: %d bytes at %d\n", size, start);
+
+	initrd_start = start;
+	initrd_end = start + size;
+}
+#endif
+
+static int boot_image_setup(struct image_info *image, unsigned int *entry)
+{
+	unsigned char *addr = image->dest;
 	struct linux_zimage_header *zimage_header
 			= (struct linux_zimage_header *)addr;
 
@@ -265,6 +926,63 @@ static int boot_image_setup(unsigned char *addr, unsigned int *entry)
 	unsigned int src, dest;
 	unsigned int size;
 	unsigned int magic;
+#ifdef CONFIG_UIMAGE_VERIFY
+	unsigned int crc;
+#endif
+#ifdef KERNEL_DECOMPRESS
+	unsigned int comp_type;
+	int ret;
+#endif
+#ifdef CONFIG_FIT
+	struct fit_image *kernel;
+#endif
+
+#ifdef CONFIG_KERNEL_STREAM
+	/* the media has already decompressed it */
+	if (stream_entry) {
+		*entry = stream_entry;
+		return 0;
+	}
+#endif
+
+	/* the media has already read it to its load address */
+	if (uimage_in_place.magic) {
+		dbg_info("\nBooting uImage ......\n");
+
+#ifdef CONFIG_UIMAGE_VERIFY
+		crc = crc32(0,
+			(unsigned char *)swap_uint32(uimage_in_place.load),
+			swap_uint32(uimage_in_place.size));
+		if (uimage_check_data(swap_uint32(uimage_in_place.data_crc),
+									crc))
+			return -1;
+#endif
+		*entry = swap_uint32(uimage_in_place.entry_point);
+		return 0;
+	}
+
+#ifdef CONFIG_FIT
+	kernel = fit_get_kernel();
+	if (kernel) {
+		dbg_info("\nBooting FIT image ......\n");
+
+		if (kernel->comp != FIT_COMP_NONE) {
+#ifdef KERNEL_DECOMPRESS
+			ret = decompress_image(image, kernel->comp,
+					(unsigned char *)kernel->data,
+					kernel->size, kernel->load);
+			if (ret)
+				return ret;
+#else
+			dbg_info("The FIT kernel compression not supported\n");
+			return -1;
+#endif
+		}
+
+		*entry = kernel->entry;
+		return 0;
+	}
+#endif
 
 	dbg_loud("try zImage magic: %d is found\n", zimage_header->magic);
 	if (zimage_header->magic == LINUX_ZIMAGE_MAGIC) {
@@ -278,15 +996,38 @@ static int boot_image_setup(unsigned char *addr, unsigned int *entry)
 	if (magic == LINUX_UIMAGE_MAGIC) {
 		dbg_info("\nBooting uImage ......\n");
 
-		if (uimage_header->comp_type != 0) {
-			dbg_info("The uImage compress type not supported\n");
-			return -1;
-		}
-
 		size = swap_uint32(uimage_header->size);
 		dest = swap_uint32(uimage_header->load);
 		src = (unsigned int)addr + sizeof(struct linux_uimage_header);
 
+#ifdef CONFIG_UIMAGE_VERIFY
+		if (uimage_check_header(uimage_header))
+			return -1;
+
+		crc = crc32(0, (unsigned char *)src, size);
+		if (uimage_check_data(swap_uint32(uimage_header->data_crc),
+									crc))
+			return -1;
+#endif
+
+#ifdef KERNEL_DECOMPRESS
+		if (uimage_header->comp_type != IH_COMP_NONE) {
+			ret = decompress_image(image,
+					uimage_header->comp_type,
+					(unsigned char *)src, size, dest);
+			if (ret)
+				return ret;
+
+			*entry = swap_uint32(uimage_header->entry_point);
+			return 0;
+		}
+#else
+		if (uimage_header->comp_type != IH_COMP_NONE) {
+			dbg_info("The uImage compress type not supported\n");
+			return -1;
+		}
+#endif
+
 		dbg_info("Relocating kernel image, dest: %d, src: %d\n",
 				dest, src);
 
@@ -298,6 +1039,26 @@ static int boot_image_setup(unsigned char *addr, unsigned int *entry)
 		return 0;
 	}
 
+#ifdef KERNEL_DECOMPRESS
+	comp_type = raw_comp_type(addr);
+	if (comp_type != IH_COMP_NONE) {
+		dbg_info("\nBooting compressed Image ......\n");
+
+		/*
+		 * The stream ends by itself, the data after it
+		 * is not looked at.
+		 */
+		dest = MEM_BANK + KERNEL_TEXT_OFFSET;
+		ret = decompress_image(image, comp_type, addr,
+				MEM_BANK + MEM_SIZE - (unsigned int)addr, dest);
+		if (ret)
+			return ret;
+
+		*entry = dest;
+		return 0;
+	}
+#endif
+
 	dbg_info("** Bad uImage magic: %d, zImage magic: %d\n",
 			magic, zimage_header->magic);
 	return -1;
@@ -327,7 +1088,6 @@ static int load_kernel_image(struct image_info *image)
 
 int load_kernel(struct image_info *image)
 {
-	unsigned char *addr = image->dest;
 	unsigned int entry_point;
 	unsigned int r2;
 	unsigned int mach_type;
@@ -348,11 +1108,15 @@ int load_kernel(struct image_info *image)
 #endif
 
 #if defined(CONFIG_LINUX_IMAGE)
-	ret = boot_image_setup(addr, &entry_point);
+	ret = boot_image_setup(image, &entry_point);
 #endif
 	if (ret)
 		return -1;
 
+#ifdef CONFIG_LOAD_INITRD
+	initrd_setup(image);
+#endif
+
 	kernel_entry = (void (*)(int, int, unsigned int))entry_point;
 
 #ifdef CONFIG_OF_LIBFDT
@@ -360,6 +1124,8 @@ int load_kernel(struct image_info *image)
 	if (ret)
 		return ret;
 
+	profile_mark("fdt fixup");
+
 	mach_type = 0xffffffff;
 	r2 = (unsigned int)image->of_dest;
 #else
@@ -369,6 +1135,10 @@ int load_kernel(struct image_info *image)
 	r2 = (unsigned int)(MEM_BANK + 0x100);
 #endif
 
+	profile_mark("jump");
+	profile_show();
+	boot_trace_save();
+
 	dbg_info("\nStarting linux kernel ..., machid: %d\n\n",
 							mach_type);
 #if defined(CONFIG_ENTER_NWD)
@@ -378,9 +1148,11 @@ int load_kernel(struct image_info *image)
 
 	dbg_info("Enter Normal World, Run Kernel at %d\n",
 					(unsigned int)kernel_entry);
+	usart_flush();
 
 	enter_normal_world();
 #else
+	usart_flush();
 	kernel_entry(0, mach_type, r2);
 #endif
 
@@ -32,6 +32,11 @@
 #include "atmel_mci.h"
 #include "sdhc.h"
 #include "debug.h"
+#include "boot_trace.h"
+#ifdef CONFIG_SDCARD_WARM_INIT
+#include "hardware.h"
+#include "pmc.h"
+#endif
 
 #define DEFAULT_SD_BLOCK_LEN		512
 
@@ -40,6 +45,36 @@ static struct sd_command	sdcard_command;
 static struct sd_data		sdcard_data;
 static struct sd_card		atmel_sdcard;
 
+static void sdcard_set_clock(struct sd_card *sdcard, unsigned int clock)
+{
+	struct sd_host *host = sdcard->host;
+
+	if (host->ops->set_clock)
+		host->ops->set_clock(sdcard, clock);
+
+	if (host->caps_max_clock && (clock > host->caps_max_clock))
+		clock = host->caps_max_clock;
+
+	sdcard->clock = clock;
+}
+
+#ifdef CONFIG_SDHC_UHS
+static int sd_host_uhs_capable(struct sd_card *sdcard)
+{
+	struct sd_host *host = sdcard->host;
+
+	if (!host->ops->set_signal_voltage
+		|| !host->ops->set_timing
+		|| !host->ops->execute_tuning)
+		return 0;
+
+	if (!(host->caps_uhs & HOST_CAPS_1V8))
+		return 0;
+
+	return (host->caps_uhs & (HOST_CAPS_SDR50 | HOST_CAPS_SDR104)) ? 1 : 0;
+}
+#endif
+
 static int sd_cmd_go_idle_state(struct sd_card *sdcard)
 {
 	struct sd_host *host = sdcard->host;
@@ -97,6 +132,8 @@ static int sd_cmd_send_app_cmd(struct sd_card *sdcard)
 	return 0;
 }
 
+/* Switching to 1.8V Request / Accepted */
+#define OCR_S18R_S18A		(0x01 << 24)
 /* Host Capacity Support / Card Capacity Status */
 #define OCR_HCR_CCS		(0x01 << 30)
 #define OCR_BUSY_STATUS		(0x01 << 31)
@@ -114,6 +151,10 @@ static int sd_cmd_app_sd_send_op_cmd(struct sd_card *sdcard,
 				& OCR_VOLTAGE_27_36_MASK;
 	if (capacity_support)
 		command->argu |= OCR_HCR_CCS;
+#ifdef CONFIG_SDHC_UHS
+	if (capacity_support && sd_host_uhs_capable(sdcard))
+		command->argu |= OCR_S18R_S18A;
+#endif
 
 	ret = host->ops->send_command(command, 0);
 	if (ret)
@@ -160,6 +201,36 @@ static int sd_check_operational_condition(struct sd_card *sdcard,
 	return 0;
 }
 
+#ifdef CONFIG_SDHC_UHS
+/*
+ * Refer to Physical Layer Specification Version 3.01
+ * 4.2.4.2 Initialization Sequence for UHS-I
+ * Figure 3-12: Signal Voltage Switch Sequence
+ */
+static int sd_switch_signal_voltage(struct sd_card *sdcard)
+{
+	struct sd_host *host = sdcard->host;
+	struct sd_command *command = sdcard->command;
+	int ret;
+
+	command->cmd = SD_CMD_VOLTAGE_SWITCH;
+	command->resp_type = SD_RESP_TYPE_R1;
+	command->argu = 0;
+
+	ret = host->ops->send_command(command, 0);
+	if (ret)
+		return ret;
+
+	ret = host->ops->set_signal_voltage(sdcard, SD_SIGNAL_VOLTAGE_180);
+	if (ret)
+		return ret;
+
+	sdcard->signal_1v8 = 1;
+
+	return 0;
+}
+#endif
+
 static int sd_cmd_all_send_cid(struct sd_card *sdcard)
 {
 	struct sd_host *host = sdcard->host;
@@ -483,9 +554,111 @@ static int sd_card_set_bus_width(struct sd_card *sdcard)
 		return -1;
 	}
 
+	sdcard->bus_width = bus_width;
+
 	return 0;
 }
 
+#ifdef CONFIG_SDHC_UHS
+struct sd_uhs_mode {
+	unsigned int timing;
+	unsigned int func;
+	unsigned int clock;
+	unsigned int caps;
+};
+
+static const struct sd_uhs_mode sd_uhs_modes[] = {
+	{SD_TIMING_SDR104, SD_SWITCH_FUNC_SDR104, 208000000, HOST_CAPS_SDR104},
+	{SD_TIMING_SDR50, SD_SWITCH_FUNC_SDR50, 100000000, HOST_CAPS_SDR50},
+};
+
+static int sd_uhs_select_mode(struct sd_card *sdcard,
+				unsigned int func,
+				unsigned int timing,
+				unsigned int clock)
+{
+	struct sd_host *host = sdcard->host;
+	unsigned int switch_func_status[16];
+	unsigned int status;
+	int ret;
+
+	ret = sd_cmd_switch_fun(sdcard,
+				SD_SWITCH_MODE_SET,
+				SD_SWITCH_GRP_ACCESS_MODE,
+				func,
+				switch_func_status);
+	if (ret)
+		return ret;
+
+	/* Check Switched function */
+	status = swap_uint32(switch_func_status[4]);
+	if (((status >> 24) & 0x0f) != func)
+		return -1;
+
+	ret = host->ops->set_timing(sdcard, timing);
+	if (ret)
+		return ret;
+
+	sdcard_set_clock(sdcard, clock);
+	sdcard->bus_timing = timing;
+
+	return 0;
+}
+
+/*
+ * The card is already running at 1.8V on a 4-bit bus: pick the fastest
+ * access mode both sides support, tune the sampling point when the mode
+ * requires it, and fall back to SDR25 when nothing better works out.
+ */
+static int sd_switch_uhs(struct sd_card *sdcard)
+{
+	struct sd_host *host = sdcard->host;
+	const struct sd_uhs_mode *mode;
+	unsigned int switch_func_status[16];
+	unsigned int support;
+	unsigned int i;
+	int ret;
+
+	ret = sd_cmd_switch_fun(sdcard,
+				SD_SWITCH_MODE_CHECK,
+				SD_SWITCH_GRP_ACCESS_MODE,
+				SD_SWITCH_FUNC_SDR104,
+				switch_func_status);
+	if (ret)
+		return ret;
+
+	/* Function Group 1 support bits, 415:400 */
+	support = (swap_uint32(switch_func_status[3]) >> 16) & 0xffff;
+
+	for (i = 0; i < ARRAY_SIZE(sd_uhs_modes); i++) {
+		mode = &sd_uhs_modes[i];
+
+		if (!(host->caps_uhs & mode->caps)
+			|| !(support & (0x01 << mode->func)))
+			continue;
+
+		ret = sd_uhs_select_mode(sdcard,
+				mode->func, mode->timing, mode->clock);
+		if (ret)
+			continue;
+
+		if ((mode->timing == SD_TIMING_SDR50)
+			&& !(host->caps_uhs & HOST_CAPS_TUNE_SDR50))
+			return 0;
+
+		ret = host->ops->execute_tuning(sdcard,
+					SD_CMD_SEND_TUNING_BLOCK);
+		if (ret == 0)
+			return 0;
+
+		dbg_info("SD: Tuning failed, falling back\n");
+	}
+
+	return sd_uhs_select_mode(sdcard, SD_SWITCH_FUNC_HS_SDR25,
+					SD_TIMING_HS, 50000000);
+}
+#endif
+
 /*-----------------------------------------------------------------*/
 #define OCR_VOLTAGE_WIN_27_36	0x00FF8000
 #define OCR_ACCESS_MODE		0x60000000
@@ -601,6 +774,7 @@ static int mmc_cmd_send_ext_csd(struct sd_card *sdcard, char *ext_csd)
 #define MMC_EXT_CSD_ACCESS_CLEAR_BITS	0x02
 #define MMC_EXT_CSD_ACCESS_WRITE_BYTE	0x03
 
+#define EXT_CSD_BYTE_PARTITION_CONFIG	179
 #define EXT_CSD_BYTE_BUS_WIDTH		183
 #define EXT_CSD_BYTE_HS_TIMING		185
 #define EXT_CSD_BYTE_POWER_CLASS	187
@@ -610,6 +784,22 @@ static int mmc_cmd_send_ext_csd(struct sd_card *sdcard, char *ext_csd)
 #define EXT_CSD_BYTE_CSD_STRUCTURE	194
 #define EXT_CSD_BYTE_CARD_TYPE		196
 
+/* EXT_CSD_BYTE_CARD_TYPE */
+#define EXT_CSD_CARD_TYPE_HS_26		(0x01 << 0)
+#define EXT_CSD_CARD_TYPE_HS_52		(0x01 << 1)
+#define EXT_CSD_CARD_TYPE_DDR_52	(0x01 << 2)	/* 1.8V or 3V I/O */
+#define EXT_CSD_CARD_TYPE_DDR_52_1_2V	(0x01 << 3)
+#define EXT_CSD_CARD_TYPE_HS200_1_8V	(0x01 << 4)
+#define EXT_CSD_CARD_TYPE_HS200_1_2V	(0x01 << 5)
+
+/* EXT_CSD_BYTE_HS_TIMING */
+#define EXT_CSD_TIMING_BC		0
+#define EXT_CSD_TIMING_HS		1
+#define EXT_CSD_TIMING_HS200		2
+
+/* EXT_CSD_BYTE_PARTITION_CONFIG */
+#define EXT_CSD_PART_ACCESS_MASK	0x07
+
 static int mmc_switch_high_speed(struct sd_card *sdcard)
 {
 	char ext_csd[DEFAULT_SD_BLOCK_LEN];
@@ -697,6 +887,8 @@ static int mmc_cmd_bustest_r(struct sd_card *sdcard,
 	return 0;
 }
 
+#define MMC_BUS_WIDTH_DDR_8	6
+#define MMC_BUS_WIDTH_DDR_4	5
 #define MMC_BUS_WIDTH_8		2
 #define MMC_BUS_WIDTH_4		1
 #define MMC_BUS_WIDTH_1		0
@@ -722,6 +914,8 @@ static int mmc_bus_width_select(struct sd_card *sdcard, unsigned int buswidth)
 			return ret;
 	}
 
+	sdcard->bus_width = buswidth;
+
 	return 0;
 }
 
@@ -768,6 +962,190 @@ static int mmc_detect_buswidth(struct sd_card *sdcard)
 
 }
 
+#ifdef CONFIG_SDHC_UHS
+#ifdef CONFIG_SDHC_HS200
+static int mmc_switch_timing(struct sd_card *sdcard,
+				unsigned char hs_timing,
+				unsigned int timing,
+				unsigned int clock)
+{
+	struct sd_host *host = sdcard->host;
+	int ret;
+
+	ret = mmc_cmd_switch_fun(sdcard,
+			MMC_EXT_CSD_ACCESS_WRITE_BYTE,
+			EXT_CSD_BYTE_HS_TIMING,
+			hs_timing);
+	if (ret)
+		return ret;
+
+	ret = host->ops->set_timing(sdcard, timing);
+	if (ret)
+		return ret;
+
+	sdcard_set_clock(sdcard, clock);
+	sdcard->bus_timing = timing;
+
+	return 0;
+}
+
+static int mmc_switch_hs200(struct sd_card *sdcard)
+{
+	struct sd_host *host = sdcard->host;
+	int ret;
+
+	ret = host->ops->set_signal_voltage(sdcard, SD_SIGNAL_VOLTAGE_180);
+	if (ret)
+		return ret;
+
+	sdcard->signal_1v8 = 1;
+
+	ret = mmc_switch_timing(sdcard, EXT_CSD_TIMING_HS200,
+				MMC_TIMING_HS200, 200000000);
+	if (ret)
+		return ret;
+
+	return host->ops->execute_tuning(sdcard,
+				MMC_CMD_SEND_TUNING_BLOCK_HS200);
+}
+#endif
+
+/*
+ * DDR52 keeps the HS timing and only changes the bus width byte,
+ * the EXT_CSD is read back in DDR to check the data lines.
+ */
+static int mmc_switch_ddr52(struct sd_card *sdcard, char *ext_csd)
+{
+	struct sd_host *host = sdcard->host;
+	unsigned char busw;
+	int ret;
+
+	busw = (sdcard->bus_width == 8) ?
+			MMC_BUS_WIDTH_DDR_8 : MMC_BUS_WIDTH_DDR_4;
+
+	ret = mmc_cmd_switch_fun(sdcard,
+			MMC_EXT_CSD_ACCESS_WRITE_BYTE,
+			EXT_CSD_BYTE_BUS_WIDTH,
+			busw);
+	if (ret)
+		return ret;
+
+	ret = host->ops->set_timing(sdcard, MMC_TIMING_DDR52);
+	if (ret)
+		return ret;
+
+	sdcard->bus_timing = MMC_TIMING_DDR52;
+
+	ret = mmc_cmd_send_ext_csd(sdcard, ext_csd);
+	if (ret)
+		return ret;
+
+	/* BUS_WIDTH is write only, a clean DDR read is the check */
+	if (ext_csd[EXT_CSD_BYTE_HS_TIMING] != EXT_CSD_TIMING_HS)
+		return -1;
+
+	return 0;
+}
+
+static int mmc_switch_uhs(struct sd_card *sdcard)
+{
+	struct sd_host *host = sdcard->host;
+	char ext_csd[DEFAULT_SD_BLOCK_LEN];
+	unsigned char busw;
+	char cardtype;
+	int ret;
+
+	if (!host->ops->set_timing || !host->ops->execute_tuning)
+		return 0;
+
+	ret = mmc_cmd_send_ext_csd(sdcard, ext_csd);
+	if (ret)
+		return ret;
+
+	cardtype = ext_csd[EXT_CSD_BYTE_CARD_TYPE];
+
+#ifdef CONFIG_SDHC_HS200
+	if ((cardtype & EXT_CSD_CARD_TYPE_HS200_1_8V)
+		&& host->ops->set_signal_voltage
+		&& (host->caps_uhs & HOST_CAPS_1V8)
+		&& (host->caps_uhs & HOST_CAPS_SDR104)) {
+		ret = mmc_switch_hs200(sdcard);
+		if (ret == 0)
+			return 0;
+
+		dbg_info("MMC: HS200 failed, falling back\n");
+
+		ret = mmc_switch_timing(sdcard, EXT_CSD_TIMING_HS,
+					SD_TIMING_HS, 52000000);
+		if (ret)
+			return ret;
+	}
+#endif
+
+	if ((cardtype & EXT_CSD_CARD_TYPE_DDR_52)
+		&& (host->caps_uhs & HOST_CAPS_DDR50)) {
+		ret = mmc_switch_ddr52(sdcard, ext_csd);
+		if (ret == 0)
+			return 0;
+
+		dbg_info("MMC: DDR52 failed, falling back\n");
+
+		busw = (sdcard->bus_width == 8) ?
+				MMC_BUS_WIDTH_8 : MMC_BUS_WIDTH_4;
+		ret = mmc_cmd_switch_fun(sdcard,
+				MMC_EXT_CSD_ACCESS_WRITE_BYTE,
+				EXT_CSD_BYTE_BUS_WIDTH,
+				busw);
+		if (ret)
+			return ret;
+
+		ret = host->ops->set_timing(sdcard, SD_TIMING_HS);
+		if (ret)
+			return ret;
+
+		sdcard->bus_timing = SD_TIMING_HS;
+	}
+
+	return 0;
+}
+
+static const char *sdcard_timing_name(unsigned int timing)
+{
+	switch (timing) {
+	case SD_TIMING_HS:
+		return "High Speed";
+	case SD_TIMING_SDR50:
+		return "SDR50";
+	case SD_TIMING_SDR104:
+		return "SDR104";
+	case MMC_TIMING_DDR52:
+		return "DDR52";
+	case MMC_TIMING_HS200:
+		return "HS200";
+	default:
+		return "Default Speed";
+	}
+}
+
+/* Bus mode and the raw bus throughput it gives, in KB/s */
+static void sdcard_show_mode(struct sd_card *sdcard)
+{
+	unsigned int rate;
+
+	rate = (sdcard->clock / 1000) * sdcard->bus_width / 8;
+	if (sdcard->bus_timing == MMC_TIMING_DDR52)
+		rate *= 2;
+
+	dbg_info("%s: %s, %d-bit, %s, clock: %d kHz, bus rate: %d KB/s\n",
+		 (sdcard->card_type == CARD_TYPE_SD) ? "SD" : "MMC",
+		 sdcard_timing_name(sdcard->bus_timing),
+		 sdcard->bus_width,
+		 sdcard->signal_1v8 ? "1.8V" : "3.3V",
+		 sdcard->clock / 1000,
+		 rate);
+}
+#endif
+
 /*-----------------------------------------------------------------*/
 
 /*
@@ -801,6 +1179,22 @@ static int sdcard_identification(struct sd_card *sdcard)
 				return -1;
 			} else if (ret)
 				return ret;
+#ifdef CONFIG_SDHC_UHS
+			if ((sdcard->reg->ocr & OCR_HCR_CCS)
+				&& (sdcard->reg->ocr & OCR_S18R_S18A)
+				&& sd_host_uhs_capable(sdcard)) {
+				/*
+				 * The card which failed the switch only
+				 * comes back to 3.3V through a power cycle,
+				 * which the hosts here can't do.
+				 */
+				ret = sd_switch_signal_voltage(sdcard);
+				if (ret) {
+					dbg_info("SD: 1.8V signal switch failed\n");
+					return ret;
+				}
+			}
+#endif
 		} else if (ret == ERROR_TIMEOUT) {
 			ret = sd_check_operational_condition(sdcard, 0);
 			if (ret == ERROR_UNUSABLE_CARD) {
@@ -910,11 +1304,11 @@ static int sd_initialization(struct sd_card *sdcard)
 		}
 	}
 
-	if (host->ops->set_clock) {
-		if (sdcard->highspeed_card)
-			host->ops->set_clock(sdcard, 50000000);
-		else
-			host->ops->set_clock(sdcard, 25000000);
+	if (sdcard->highspeed_card) {
+		sdcard_set_clock(sdcard, 50000000);
+		sdcard->bus_timing = SD_TIMING_HS;
+	} else {
+		sdcard_set_clock(sdcard, 25000000);
 	}
 
 	/* Change the bus mode */
@@ -922,6 +1316,14 @@ static int sd_initialization(struct sd_card *sdcard)
 	if (ret)
 		return ret;
 
+#ifdef CONFIG_SDHC_UHS
+	if (sdcard->signal_1v8 && (sdcard->bus_width == 4)) {
+		ret = sd_switch_uhs(sdcard);
+		if (ret)
+			return ret;
+	}
+#endif
+
 	return 0;
 }
 
@@ -967,7 +1369,7 @@ static int mmc_initialization(struct sd_card *sdcard)
 			return ret;
 	}
 
-	if (sdcard->host->caps_high_speed) {
+	if (host->caps_high_speed) {
 		if (sdcard->sd_spec_version >= MMC_VERSION_4) {
 			ret = mmc_switch_high_speed(sdcard);
 			if (ret)
@@ -975,13 +1377,21 @@ static int mmc_initialization(struct sd_card *sdcard)
 		}
 	}
 
-	if (host->ops->set_clock) {
-		if (sdcard->highspeed_card)
-			host->ops->set_clock(sdcard, 52000000);
-		else
-			host->ops->set_clock(sdcard, 26000000);
+	if (sdcard->highspeed_card) {
+		sdcard_set_clock(sdcard, 52000000);
+		sdcard->bus_timing = SD_TIMING_HS;
+	} else {
+		sdcard_set_clock(sdcard, 26000000);
 	}
 
+#ifdef CONFIG_SDHC_UHS
+	if (sdcard->highspeed_card && (sdcard->bus_width >= 4)) {
+		ret = mmc_switch_uhs(sdcard);
+		if (ret)
+			return ret;
+	}
+#endif
+
 	return 0;
 }
 
@@ -997,6 +1407,224 @@ static void init_sdcard_struct(struct sd_card *sdcard)
 	sdcard->data = &sdcard_data;
 }
 
+#ifdef CONFIG_SDCARD_WARM_INIT
+/*
+ * The parameters negotiated with an eMMC device are kept in memory
+ * that survives a reset. After a warm reset the device is still powered
+ * and addressed, so it only has to be found again with CMD13 and put
+ * back into the saved bus mode, skipping the identification.
+ */
+#define SDCARD_WARM_MAGIC	0x574d4d43	/* "WMMC" */
+
+#define SDCARD_WARM_MAGIC_REG	(CONFIG_SDCARD_WARM_STATE_ADDR + 0x0)
+#define SDCARD_WARM_RCA_REG	(CONFIG_SDCARD_WARM_STATE_ADDR + 0x4)
+#define SDCARD_WARM_PARAM_REG	(CONFIG_SDCARD_WARM_STATE_ADDR + 0x8)
+#define SDCARD_WARM_CHECK_REG	(CONFIG_SDCARD_WARM_STATE_ADDR + 0xc)
+
+#define WARM_PARAM_HC		(0x01 << 0)	/* sector addressing */
+#define WARM_PARAM_HS		(0x01 << 1)	/* 52MHz High Speed */
+#define WARM_PARAM_BUS_WIDTH(x)	(((x) & 0x0f) << 4)
+#define WARM_PARAM_TIMING(x)	(((x) & 0x0f) << 8)
+#define WARM_PARAM_VERSION(x)	(((x) & 0xff) << 16)
+
+#define WARM_GET_BUS_WIDTH(x)	(((x) >> 4) & 0x0f)
+#define WARM_GET_TIMING(x)	(((x) >> 8) & 0x0f)
+#define WARM_GET_VERSION(x)	(((x) >> 16) & 0xff)
+
+/* CURRENT_STATE of the R1 card status */
+#define R1_CURRENT_STATE(x)	(((x) >> 9) & 0x0f)
+#define R1_STATE_STBY		3
+#define R1_STATE_TRAN		4
+
+static unsigned int sdcard_warm_check(unsigned int rca, unsigned int param)
+{
+	return ~(SDCARD_WARM_MAGIC ^ rca ^ param);
+}
+
+static void sdcard_warm_invalidate(void)
+{
+	writel(0, SDCARD_WARM_MAGIC_REG);
+}
+
+static void sdcard_warm_save(struct sd_card *sdcard)
+{
+	unsigned int rca = sdcard->reg->rca;
+	unsigned int param;
+
+	if ((sdcard->card_type != CARD_TYPE_MMC)
+		|| (sdcard->sd_spec_version < MMC_VERSION_4)) {
+		sdcard_warm_invalidate();
+		return;
+	}
+
+	param = (sdcard->highcapacity_card ? WARM_PARAM_HC : 0)
+		| (sdcard->highspeed_card ? WARM_PARAM_HS : 0)
+		| WARM_PARAM_BUS_WIDTH(sdcard->bus_width)
+		| WARM_PARAM_TIMING(sdcard->bus_timing)
+		| WARM_PARAM_VERSION(sdcard->sd_spec_version);
+
+	writel(rca, SDCARD_WARM_RCA_REG);
+	writel(param, SDCARD_WARM_PARAM_REG);
+	writel(sdcard_warm_check(rca, param), SDCARD_WARM_CHECK_REG);
+	writel(SDCARD_WARM_MAGIC, SDCARD_WARM_MAGIC_REG);
+}
+
+static int mmc_cmd_get_state(struct sd_card *sdcard, unsigned int *state)
+{
+	struct sd_host *host = sdcard->host;
+	struct sd_command *command = sdcard->command;
+	int ret;
+
+	command->cmd = SD_CMD_SEND_STATUS;
+	command->resp_type = SD_RESP_TYPE_R1;
+	command->argu = sdcard->reg->rca << 16;
+
+	ret = host->ops->send_command(command, 0);
+	if (ret)
+		return ret;
+
+	*state = R1_CURRENT_STATE(command->resp[0]);
+
+	return 0;
+}
+
+/*
+ * Put the device back into the saved bus width and timing, whatever
+ * mode the previous software left it in, then read the EXT_CSD in that
+ * mode to check the data lines and to route the accesses to the user
+ * area again, as CMD0 would have done.
+ */
+static int mmc_warm_restore_mode(struct sd_card *sdcard, unsigned int param)
+{
+	char ext_csd[DEFAULT_SD_BLOCK_LEN];
+	unsigned int timing = WARM_GET_TIMING(param);
+	unsigned char hs_timing;
+	unsigned int clock;
+	int ret;
+
+	if (timing != SD_TIMING_LEGACY) {
+		ret = mmc_cmd_switch_fun(sdcard,
+				MMC_EXT_CSD_ACCESS_WRITE_BYTE,
+				EXT_CSD_BYTE_HS_TIMING,
+				EXT_CSD_TIMING_HS);
+		if (ret)
+			return ret;
+	}
+
+	if (sdcard->bus_width != 1) {
+		ret = mmc_bus_width_select(sdcard, sdcard->bus_width);
+		if (ret)
+			return ret;
+	}
+
+	if (sdcard->highspeed_card) {
+		clock = 52000000;
+		sdcard->bus_timing = SD_TIMING_HS;
+	} else {
+		clock = 26000000;
+	}
+	sdcard_set_clock(sdcard, clock);
+
+#ifdef CONFIG_SDHC_UHS
+	if (timing == MMC_TIMING_DDR52) {
+		ret = mmc_switch_ddr52(sdcard, ext_csd);
+		if (ret)
+			return ret;
+	}
+#ifdef CONFIG_SDHC_HS200
+	if (timing == MMC_TIMING_HS200) {
+		ret = mmc_switch_hs200(sdcard);
+		if (ret)
+			return ret;
+	}
+#endif
+#endif
+	if (sdcard->bus_timing != timing)
+		return -1;
+
+	ret = mmc_cmd_send_ext_csd(sdcard, ext_csd);
+	if (ret)
+		return ret;
+
+	if (timing == SD_TIMING_LEGACY)
+		hs_timing = EXT_CSD_TIMING_BC;
+	else if (timing == MMC_TIMING_HS200)
+		hs_timing = EXT_CSD_TIMING_HS200;
+	else
+		hs_timing = EXT_CSD_TIMING_HS;
+
+	if (ext_csd[EXT_CSD_BYTE_HS_TIMING] != hs_timing)
+		return -1;
+
+	if (ext_csd[EXT_CSD_BYTE_PARTITION_CONFIG] & EXT_CSD_PART_ACCESS_MASK) {
+		ret = mmc_cmd_switch_fun(sdcard,
+			MMC_EXT_CSD_ACCESS_WRITE_BYTE,
+			EXT_CSD_BYTE_PARTITION_CONFIG,
+			ext_csd[EXT_CSD_BYTE_PARTITION_CONFIG]
+				& ~EXT_CSD_PART_ACCESS_MASK);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int sdcard_warm_restore(struct sd_card *sdcard)
+{
+	unsigned int rca, param;
+	unsigned int bus_width;
+	unsigned int state;
+	int ret;
+
+	if (readl(SDCARD_WARM_MAGIC_REG) != SDCARD_WARM_MAGIC)
+		return -1;
+
+	rca = readl(SDCARD_WARM_RCA_REG);
+	param = readl(SDCARD_WARM_PARAM_REG);
+	if (readl(SDCARD_WARM_CHECK_REG) != sdcard_warm_check(rca, param))
+		return -1;
+
+	/* The host is set up with the width, it must be one it drives */
+	bus_width = WARM_GET_BUS_WIDTH(param);
+	if (((bus_width != 1) && (bus_width != 4) && (bus_width != 8))
+		|| !(sdcard->host->caps_bus_width & bus_width)) {
+		dbg_info("MMC: Warm bus width %d, full init\n", bus_width);
+		return -1;
+	}
+
+	sdcard->reg->rca = rca;
+
+	/* A device that was power cycled is idle and does not answer */
+	ret = mmc_cmd_get_state(sdcard, &state);
+	if (ret)
+		return ret;
+
+	if (state == R1_STATE_STBY) {
+		ret = sd_cmd_select_card(sdcard);
+		if (ret)
+			return ret;
+	} else if (state != R1_STATE_TRAN) {
+		dbg_info("MMC: Warm state %d, full init\n", state);
+		return -1;
+	}
+
+	sdcard->card_type = CARD_TYPE_MMC;
+	sdcard->sd_spec_version = WARM_GET_VERSION(param);
+	sdcard->highcapacity_card = (param & WARM_PARAM_HC) ? 1 : 0;
+	sdcard->highspeed_card = (param & WARM_PARAM_HS) ? 1 : 0;
+	sdcard->bus_width = bus_width;
+	sdcard->read_bl_len = DEFAULT_SD_BLOCK_LEN;
+
+	ret = mmc_warm_restore_mode(sdcard, param);
+	if (ret)
+		return ret;
+
+	dbg_info("MMC: Resumed from warm state\n");
+
+	return 0;
+}
+#endif
+
 /*--------------------------------------------------------------------------*/
 
 int sdcard_initialize(void)
@@ -1019,6 +1647,22 @@ int sdcard_initialize(void)
 	if (host->ops->init)
 		host->ops->init(sdcard);
 
+#ifdef CONFIG_SDCARD_WARM_INIT
+#ifdef AT91C_ID_SECURAM
+	pmc_enable_periph_clock(AT91C_ID_SECURAM);
+#endif
+	if (sdcard_warm_restore(sdcard) == 0)
+		goto done;
+
+	sdcard_warm_invalidate();
+
+	/* The restore attempt may have left the host in another mode */
+	init_sdcard_struct(sdcard);
+	sdcard->host = host;
+	if (host->ops->init)
+		host->ops->init(sdcard);
+#endif
+
 	/* Card Indentification Mode */
 	ret = sdcard_identification(sdcard);
 	if (ret)
@@ -1031,6 +1675,14 @@ int sdcard_initialize(void)
 	if (ret)
 		return ret;
 
+#ifdef CONFIG_SDCARD_WARM_INIT
+	sdcard_warm_save(sdcard);
+done:
+#endif
+#ifdef CONFIG_SDHC_UHS
+	sdcard_show_mode(sdcard);
+#endif
+
 	return 0;
 }
 
@@ -1134,6 +1786,7 @@ unsigned int sdcard_block_read(unsigned int start,
 {
 	struct sd_card *sdcard = &atmel_sdcard;
 	unsigned int blocks_todo = block_count;
+	unsigned int max_blocks = SUPPORT_MAX_BLOCKS;
 	unsigned int blocks;
 	unsigned int block_len = sdcard->read_bl_len;
 	unsigned int blocks_read;
@@ -1144,14 +1797,19 @@ unsigned int sdcard_block_read(unsigned int start,
 	 * Figure 35-10. Read Function Flow Diagram
 	*/
 
-	/* Send SET_BLOCKLEN command */
-	ret = sd_cmd_set_blocklen(sdcard, block_len);
-	if (ret)
-		return 0;
+	/* Send SET_BLOCKLEN command, it is illegal in DDR mode */
+	if (sdcard->bus_timing != MMC_TIMING_DDR52) {
+		ret = sd_cmd_set_blocklen(sdcard, block_len);
+		if (ret)
+			return 0;
+	}
+
+	if (sdcard->host->caps_max_blocks
+		&& (sdcard->host->caps_max_blocks < max_blocks))
+		max_blocks = sdcard->host->caps_max_blocks;
 
 	for (blocks_todo = block_count; blocks_todo > 0; ) {
-		blocks = (blocks_todo > SUPPORT_MAX_BLOCKS) ?
-					SUPPORT_MAX_BLOCKS : blocks_todo;
+		blocks = (blocks_todo > max_blocks) ? max_blocks : blocks_todo;
 
 		if (blocks > 1) {
 			blocks_read = sd_cmd_read_multiple_block(sdcard,
@@ -1173,5 +1831,109 @@ unsigned int sdcard_block_read(unsigned int start,
 		buf += blocks * block_len;
 	}
 
+	boot_trace_read("SD/MMC", block_count * block_len);
+
 	return block_count;
 }
+
+/*
+ * The read split in two, for a caller which has work to do while the
+ * host moves the blocks by DMA: sdcard_block_read_start() issues the
+ * multi-block read, sdcard_block_read_wait() completes it and returns
+ * the count of blocks read, as sdcard_block_read() does. A read which
+ * the host can't leave to its DMA is done whole by the start.
+ */
+static unsigned int sd_read_pending;	/* blocks of the running read */
+static unsigned int sd_read_done;	/* blocks read by the start */
+
+void sdcard_block_read_start(unsigned int start,
+				unsigned int block_count,
+				void *buf)
+{
+	struct sd_card *sdcard = &atmel_sdcard;
+	struct sd_host *host = sdcard->host;
+	struct sd_data *data = sdcard->data;
+
+	sd_read_pending = 0;
+	sd_read_done = 0;
+
+	if (!host->ops->wait_data
+		|| (block_count < 2)
+		|| (block_count > SUPPORT_MAX_BLOCKS)
+		|| (host->caps_max_blocks
+			&& (block_count > host->caps_max_blocks))) {
+		sd_read_done = sdcard_block_read(start, block_count, buf);
+		return;
+	}
+
+	if (sdcard->bus_timing != MMC_TIMING_DDR52) {
+		if (sd_cmd_set_blocklen(sdcard, sdcard->read_bl_len))
+			return;
+	}
+
+	data->nowait = 1;
+	sd_read_pending = sd_cmd_read_multiple_block(sdcard,
+						buf, start, block_count);
+	data->nowait = 0;
+
+	if (!sd_read_pending)
+		sd_cmd_stop_transmission(sdcard);
+}
+
+unsigned int sdcard_block_read_wait(void)
+{
+	struct sd_card *sdcard = &atmel_sdcard;
+	unsigned int blocks = sd_read_pending;
+	int ret;
+
+	if (!blocks)
+		return sd_read_done;
+
+	sd_read_pending = 0;
+
+	ret = sdcard->host->ops->wait_data(sdcard->data);
+
+	if (sd_cmd_stop_transmission(sdcard) || ret)
+		return 0;
+
+	boot_trace_read("SD/MMC", blocks * sdcard->read_bl_len);
+
+	return blocks;
+}
+
+#ifdef CONFIG_SDCARD_RAW_BOOTPART
+/*
+ * Route the following accesses to the user area (0),
+ * or to one of the boot partitions (1: BOOT0, 2: BOOT1)
+ */
+int sdcard_switch_partition(unsigned int part)
+{
+	struct sd_card *sdcard = &atmel_sdcard;
+	char ext_csd[DEFAULT_SD_BLOCK_LEN];
+	unsigned char config;
+	int ret;
+
+	if ((sdcard->card_type != CARD_TYPE_MMC)
+		|| (sdcard->sd_spec_version < MMC_VERSION_4)) {
+		dbg_info("MMC: No boot partition on this card\n");
+		return -1;
+	}
+
+	ret = mmc_cmd_send_ext_csd(sdcard, ext_csd);
+	if (ret)
+		return ret;
+
+	config = ext_csd[EXT_CSD_BYTE_PARTITION_CONFIG];
+	config &= ~EXT_CSD_PART_ACCESS_MASK;
+	config |= part & EXT_CSD_PART_ACCESS_MASK;
+
+	ret = mmc_cmd_switch_fun(sdcard,
+			MMC_EXT_CSD_ACCESS_WRITE_BYTE,
+			EXT_CSD_BYTE_PARTITION_CONFIG,
+			config);
+	if (ret)
+		return ret;
+
+	return 0;
+}
+#endif
@@ -38,7 +38,13 @@
 #include "hamming.h"
 #include "timer.h"
 #include "fdt.h"
+#include "secure.h"
+#include "fit.h"
 #include "div.h"
+#include "manifest.h"
+#include "profile.h"
+#include "boot_trace.h"
+#include "usart.h"
 
 #ifdef CONFIG_NANDFLASH_SMALL_BLOCKS
 static struct nand_chip nand_ids[] = {
@@ -563,6 +569,8 @@ static int nand_info_init(struct nand_info *nand, struct nand_chip *chip)
 	/* the layout of the spare area */
 	config_nand_ooblayout(&nand_oob_layout, nand, chip);
 	nand->ecclayout = &nand_oob_layout;
+	/* no block checked yet */
+	nand->good_block = 0;
 	/* data bus width (8/16 bits) */
 	nand->buswidth = chip->buswidth;
 	if (nand->buswidth) {
@@ -861,14 +869,15 @@ static int nand_read_page(struct nand_info *nand,
 				unsigned char *buffer)
 {
 	unsigned int row_address = block * nand->pages_block + page;
-
-#ifndef CONFIG_ENABLE_SW_ECC
-	return nand_read_sector(nand, row_address, buffer, ZONE_DATA);
-#else
-
+#ifdef CONFIG_ENABLE_SW_ECC
 	int retval;
 	unsigned char hamming[48], error;
+#endif
 
+#ifndef CONFIG_ENABLE_SW_ECC
+	if (nand_read_sector(nand, row_address, buffer, ZONE_DATA))
+		return -1;
+#else
 	retval = nand_read_sector(nand, row_address, buffer,
 				ZONE_DATA | ZONE_INFO);
 	if (retval)
@@ -882,8 +891,13 @@ static int nand_read_page(struct nand_info *nand,
 		return -1;
 	}
 
-	return 0;
+	if (error == Hamming_ERROR_SINGLEBIT)
+		boot_trace_ecc("NAND", 1);
 #endif /* #ifndef CONFIG_ENABLE_SW_ECC */
+
+	boot_trace_read("NAND", nand->pagesize);
+
+	return 0;
 }
 
 #ifdef CONFIG_NANDFLASH_RECOVERY
@@ -962,11 +976,10 @@ static int nand_loadimage(struct nand_info *nand,
 	start_page = div(start_page, nand->pagesize);
 
 	while (length > 0) {
-		/* read a buffer corresponding to a block */
-		if (length < nand->blocksize)
+		/* read a buffer up to the end of the block */
+		readsize = nand->blocksize - start_page * nand->pagesize;
+		if (length < readsize)
 			readsize = length;
-		else
-			readsize = nand->blocksize;
 
 		/* adjust the number of pages to read */
 		division(readsize, nand->pagesize, &numpages, &offsetpage);
@@ -975,15 +988,19 @@ static int nand_loadimage(struct nand_info *nand,
 
 		end_page = start_page + numpages;
 
-		/* check the bad block */
-		while (1) {
-			if (nand_check_badblock(nand,
-					block, buffer) != 0) {
-				block++; /* skip this block */
-				dbg_info("NAND: Bad block:" \
-					" #%d\n", block);
-			} else
-				break;
+		/* check the bad block, unless the last read found it good */
+		if (block + 1 != nand->good_block) {
+			while (1) {
+				if (nand_check_badblock(nand,
+						block, buffer) != 0) {
+					block++; /* skip this block */
+					dbg_info("NAND: Bad block:" \
+						" #%d\n", block);
+					boot_trace_retry("NAND");
+				} else
+					break;
+			}
+			nand->good_block = block + 1;
 		}
 
 		/* read pages of a block */
@@ -994,6 +1011,8 @@ static int nand_loadimage(struct nand_info *nand,
 				return -1;
 			else
 				buffer += nand->pagesize;
+
+			usart_poll();
 		}
 		length -= readsize;
 
@@ -1007,8 +1026,7 @@ static int nand_loadimage(struct nand_info *nand,
 #if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
 static int update_image_length(struct nand_info *nand,
 				unsigned int offset,
-				unsigned char *dest,
-				unsigned char flag)
+				unsigned char *dest)
 {
 	unsigned int length = nand->pagesize;
 	int ret;
@@ -1017,21 +1035,109 @@ static int update_image_length(struct nand_info *nand,
 	if (ret)
 		return -1;
 
-	if (flag == KERNEL_IMAGE)
-		return kernel_size(dest);
-#ifdef CONFIG_OF_LIBFDT
-	else
-		return of_get_dt_total_size((void *)dest);
-#else
-	return -1;
+	return kernel_size(dest);
+}
 #endif
+
+static int nand_read(void *priv, unsigned int offset,
+			unsigned int len, unsigned char *dest)
+{
+	return nand_loadimage((struct nand_info *)priv, offset, len, dest);
+}
+
+#ifdef CONFIG_FIT
+struct nand_fit {
+	struct nand_info	*nand;
+	unsigned int		offset;
+};
+
+static int nand_read_fit(void *priv, unsigned int offset,
+			unsigned int len, unsigned char *dest)
+{
+	struct nand_fit *fit = priv;
+	unsigned int page, page_offset;
+
+	offset += fit->offset;
+
+	/* nand_loadimage() reads whole pages */
+	division(offset, fit->nand->pagesize, &page, &page_offset);
+	if (page_offset) {
+		dbg_info("NAND: FIT data at %d is not page aligned\n",
+				offset);
+		return -1;
+	}
+
+	return nand_loadimage(fit->nand, offset, len, dest);
+}
+#endif
+
+#if defined(CONFIG_KERNEL_STREAM) || defined(CONFIG_SECURE_STREAM)
+struct nand_stream {
+	struct nand_info	*nand;
+	unsigned int		block;
+	unsigned int		page;	/* next page in the block */
+};
+
+/*
+ * Reads whole pages up to the end of the current block. The page reads
+ * may store the spare area after the page, it must fit in the buffer.
+ */
+static int nand_read_stream(void *priv, unsigned char *buf, unsigned int len)
+{
+	struct nand_stream *stream = priv;
+	struct nand_info *nand = stream->nand;
+	unsigned int pagesize = nand->pagesize;
+	unsigned int count = 0;
+
+	if (len < pagesize + nand->oobsize) {
+		dbg_info("NAND: Stream buffer too small for a page: %d\n", len);
+		return -1;
+	}
+
+	/* check the bad block */
+	if (stream->page == 0) {
+		while (nand_check_badblock(nand, stream->block, buf) != 0) {
+			dbg_info("NAND: Bad block: #%d\n", stream->block);
+			stream->block++; /* skip this block */
+		}
+	}
+
+	while ((stream->page < nand->pages_block)
+		&& ((count + pagesize + nand->oobsize) <= len)) {
+		if (nand_read_page(nand, stream->block, stream->page,
+					ZONE_DATA, buf + count))
+			return -1;
+
+		count += pagesize;
+		stream->page++;
+	}
+
+	if (stream->page == nand->pages_block) {
+		stream->block++;
+		stream->page = 0;
+	}
+
+	return count;
+}
+
+static void nand_stream_init(struct nand_stream *stream,
+			     struct nand_info *nand,
+			     unsigned int offset)
+{
+	stream->nand = nand;
+	division(offset, nand->blocksize, &stream->block, &stream->page);
+	stream->page = div(stream->page, nand->pagesize);
 }
 #endif
 
 int load_nandflash(struct image_info *image)
 {
+	struct load_manifest manifest;
 	struct nand_info nand;
-	int ret;
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	struct kernel_payload payload;
+#endif
+	int ret = 0;
 
 	nandflash_hw_init();
 
@@ -1052,38 +1158,73 @@ int load_nandflash(struct image_info *image)
 	dbg_info("NAND: Using Software ECC\n");
 #endif
 
+	profile_mark("media probe");
+
+	manifest_init(&manifest, "NAND");
+
 #if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
-	int length = update_image_length(&nand,
-				image->offset, image->dest, KERNEL_IMAGE);
+	int length = update_image_length(&nand, image->offset, image->dest);
 	if (length == -1)
 		return -1;
 
 	image->length = length;
 #endif
 
-	dbg_info("NAND: Image: Copy %d bytes from %d to %d\n",
-			image->length, image->offset, image->dest);
+#ifdef CONFIG_FIT
+	if (fit_check_header(image->dest) == 0) {
+		struct nand_fit fit;
 
-	ret = nand_loadimage(&nand, image->offset, image->length, image->dest);
-	if (ret)
-		return ret;
+		fit.nand = &nand;
+		fit.offset = image->offset;
 
-#ifdef CONFIG_OF_LIBFDT
-	length = update_image_length(&nand,
-			image->of_offset, image->of_dest, DT_BLOB);
-	if (length == -1)
-		return -1;
+		return fit_load(image, nand_read_fit, &fit);
+	}
+#endif
+
+#ifdef CONFIG_KERNEL_STREAM
+	if (kernel_is_compressed(image->dest)) {
+		struct nand_stream stream;
+
+		nand_stream_init(&stream, &nand, image->offset);
+
+		dbg_info("NAND: Image: Stream %d bytes from %d\n",
+				image->length, image->offset);
+
+		ret = load_kernel_stream(image, image->length,
+					nand_read_stream, NULL, &stream);
+	} else
+#endif
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (kernel_get_payload(image, nand.pagesize, &payload) == 0) {
+		manifest_add(&manifest, KERNEL_IMAGE,
+				image->offset + payload.offset, payload.dest,
+				&payload.size, NULL);
+	} else
+#endif
+#ifdef CONFIG_SECURE_STREAM
+	{
+		struct nand_stream stream;
 
-	image->of_length = length;
+		nand_stream_init(&stream, &nand, image->offset);
 
-	dbg_info("NAND: dt blob: Copy %d bytes from %d to %d\n",
-		image->of_length, image->of_offset, image->of_dest);
+		dbg_info("NAND: Image: Stream from %d to %d\n",
+				image->offset, image->dest);
 
-	ret = nand_loadimage(&nand, image->of_offset,
-				image->of_length, image->of_dest);
+		ret = secure_load_stream(image, nand_read_stream, &stream);
+	}
+#else
+	{
+		manifest_add(&manifest, KERNEL_IMAGE, image->offset,
+				image->dest, &image->length, NULL);
+	}
+#endif
 	if (ret)
 		return ret;
+
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (image_manifest_add(image, &manifest))
+		return -1;
 #endif
 
-	return 0;
+	return manifest_load(&manifest, nand_read, &nand, nand.pagesize);
  }
@@ -33,6 +33,7 @@
 #include "debug.h"
 #include "div.h"
 #include "pmc.h"
+#include "profile.h"
 
 static inline void write_pmc(unsigned int offset, const unsigned int value)
 {
@@ -209,6 +210,8 @@ int pmc_cfg_mck(unsigned int pmc_mckr)
 	while (!(read_pmc(PMC_SR) & AT91C_PMC_MCKRDY))
 		;
 
+	profile_mark("clock switch");
+
 	return 0;
 }
 
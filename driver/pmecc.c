@@ -33,6 +33,7 @@
 #include "pmecc.h"
 #include "debug.h"
 #include "div.h"
+#include "boot_trace.h"
 
 static struct _PMECC_paramDesc_struct PMECC_paramDesc;
 
@@ -857,6 +858,8 @@ static unsigned int PMECC_CorrectionAlgo(unsigned long pPMECC,
 						eccBaseAddr,
 						ecc_byte_per_sector,
 						errorNbr);
+
+			boot_trace_ecc("NAND", errorNbr);
 		}
 		sectorNumber++;
 		pmeccStatus = pmeccStatus >> 1;
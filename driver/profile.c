@@ -0,0 +1,224 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hardware.h"
+#include "board.h"
+#include "arch/at91_pmc.h"
+#include "timer.h"
+#include "pmc.h"
+#include "div.h"
+#include "debug.h"
+#include "profile.h"
+
+#define PROFILE_MAX_MARKS	16
+
+/* the Cortex-A5 parts have a cycle counter, the ARM926 ones use the PIT */
+#if defined(SAMA5D3X) || defined(SAMA5D4) || defined(SAMA5D2)
+#define PROFILE_CYCLE_COUNTER
+#endif
+
+#ifdef BOARD_MAINOSC
+#define PROFILE_MAINCK		BOARD_MAINOSC
+#else
+#define PROFILE_MAINCK		12000000
+#endif
+
+struct profile_entry {
+	const char	*name;
+	unsigned int	usec;
+};
+
+static struct profile_entry marks[PROFILE_MAX_MARKS];
+static unsigned int num_marks;
+static unsigned int lost_marks;
+
+static unsigned int last_count;
+static unsigned int last_khz;
+static unsigned int elapsed_usec;
+
+#ifdef PROFILE_CYCLE_COUNTER
+/*
+ * The cycle counter of the Cortex-A5 PMU, it is set to count every 64
+ * cycles of the processor clock, and wraps after about 500 seconds.
+ */
+static void profile_counter_start(void)
+{
+	/* PMCR: enable, reset the cycle counter, divide by 64 */
+	asm volatile (
+		"mcr	p15, 0, %0, c9, c12, 0\n\t"
+		"isb"
+		:
+		: "r" ((1 << 0) | (1 << 2) | (1 << 3)));
+
+	/* PMCNTENSET: enable the cycle counter */
+	asm volatile (
+		"mcr	p15, 0, %0, c9, c12, 1"
+		:
+		: "r" (1 << 31));
+}
+
+static unsigned int profile_counter_read(void)
+{
+	unsigned int count;
+
+	asm volatile (
+		"mrc	p15, 0, %0, c9, c13, 0"
+		: "=r" (count));
+
+	return count;
+}
+#else
+/*
+ * The PIT, it counts MCK / 16 periods from timer_init(), the time spent
+ * before is not accounted.
+ */
+static void profile_counter_start(void)
+{
+}
+
+static unsigned int profile_counter_read(void)
+{
+	return timer_get_ticks();
+}
+#endif
+
+/* The rate of the counter in kHz, for the current clock setup */
+static unsigned int profile_counter_khz(void)
+{
+	unsigned int mckr = readl(AT91C_BASE_PMC + PMC_MCKR);
+	unsigned int mdiv;
+	unsigned int freq;
+
+	switch (mckr & AT91C_PMC_MDIV) {
+	case AT91C_PMC_MDIV_2:
+		mdiv = 2;
+		break;
+	case AT91C_PMC_MDIV_3:
+		mdiv = 3;
+		break;
+	case AT91C_PMC_MDIV_4:
+		mdiv = 4;
+		break;
+	default:
+		mdiv = 1;
+		break;
+	}
+
+	switch (mckr & AT91C_PMC_CSS) {
+	case AT91C_PMC_CSS_PLLA_CLK:
+	case AT91C_PMC_CSS_UPLL_CLK:
+#ifdef PROFILE_CYCLE_COUNTER
+		/* the processor clock */
+		return div(MASTER_CLOCK * mdiv, 64 * 1000);
+#else
+		return div(at91_get_ahb_clock(), 16 * 1000);
+#endif
+	case AT91C_PMC_CSS_SLOW_CLK:
+		freq = 32768;
+		break;
+	default:
+		freq = PROFILE_MAINCK;
+		break;
+	}
+
+#ifdef PROFILE_CYCLE_COUNTER
+	return div(freq, 64 * 1000);
+#else
+	return div(div(freq, mdiv), 16 * 1000);
+#endif
+}
+
+static unsigned int profile_ticks_to_usec(unsigned int ticks, unsigned int khz)
+{
+	unsigned int msec, rest;
+
+	if (!khz)
+		return 0;
+
+	division(ticks, khz, &msec, &rest);
+
+	return msec * 1000 + div(rest * 1000, khz);
+}
+
+/*
+ * Each interval is converted with the rate in use at its start, so that
+ * the clock switch of hw_init() does not skew the stages after it. The
+ * counters are 32-bit, the differences stay right across a wrap.
+ */
+void profile_mark(const char *name)
+{
+	unsigned int count;
+
+	if (!num_marks && !lost_marks) {
+		profile_counter_start();
+		last_count = profile_counter_read();
+		last_khz = profile_counter_khz();
+	}
+
+	count = profile_counter_read();
+	elapsed_usec += profile_ticks_to_usec(count - last_count, last_khz);
+	last_count = count;
+	last_khz = profile_counter_khz();
+
+	if (num_marks >= PROFILE_MAX_MARKS) {
+		lost_marks++;
+		return;
+	}
+
+	marks[num_marks].name = name;
+	marks[num_marks].usec = elapsed_usec;
+	num_marks++;
+}
+
+/* The name and the time of the mark "index", -1 past the last one */
+int profile_get(unsigned int index, const char **name, unsigned int *usec)
+{
+	if (index >= num_marks)
+		return -1;
+
+	*name = marks[index].name;
+	*usec = marks[index].usec;
+
+	return 0;
+}
+
+void profile_show(void)
+{
+	unsigned int last = 0;
+	unsigned int i;
+
+	dbg_info("PROFILE: %d stages\n", num_marks);
+
+	for (i = 0; i < num_marks; i++) {
+		dbg_info("PROFILE: %s: %d us, +%d us\n",
+			marks[i].name, marks[i].usec, marks[i].usec - last);
+		last = marks[i].usec;
+	}
+
+	if (lost_marks)
+		dbg_info("PROFILE: %d stages not recorded\n", lost_marks);
+}
@@ -30,6 +30,8 @@
 #include "qspi.h"
 #include "string.h"
 #include "debug.h"
+#include "profile.h"
+#include "boot_trace.h"
 
 /*
  * QSPI Flash Commands (Micron N25Q128A)
@@ -240,6 +242,8 @@ int qspi_flash_loadimage(struct image_info *image)
 
 	dbg_info("QSPI Flash: Switch to Quad SPI mode\n");
 
+	profile_mark("media probe");
+
 	dbg_info("QSPI Flash: Copy %d bytes from %d to %d\n",
 			image->length, image->offset, image->dest);
 
@@ -247,6 +251,9 @@ int qspi_flash_loadimage(struct image_info *image)
 	if (ret)
 		return -1;
 
+	boot_trace_read("QSPI", image->length);
+	profile_mark("image");
+
 	ret = qspi_flash_enable_quad_mode(0);
 	if (ret)
 		return -1;
@@ -28,17 +28,28 @@
 #include "common.h"
 #include "hardware.h"
 #include "board.h"
+#include "fit.h"
+#include "secure.h"
 
+#ifdef CONFIG_SDCARD_RAW
+#include "media.h"
+#include "fdt.h"
+#include "string.h"
+#include "manifest.h"
+#else
 #include "ff.h"
+#include "diskio.h"
+#endif
 
 #include "debug.h"
+#include "profile.h"
 
-#define CHUNK_SIZE	0x40000
+#ifndef CONFIG_SDCARD_RAW
 
+#if !defined(CONFIG_SECURE_STREAM) || defined(CONFIG_OF_LIBFDT)
 static int sdcard_loadimage(char *filename, BYTE *dest)
 {
 	FIL 	file;
-	UINT	byte_to_read = CHUNK_SIZE;
 	UINT	byte_read;
 	FRESULT	fret;
 	int	ret;
@@ -50,15 +61,11 @@ static int sdcard_loadimage(char *filename, BYTE *dest)
 		goto open_fail;
 	}
 
-	do {
-		byte_read = 0;
-		fret = f_read(&file, (void *)(dest), byte_to_read, &byte_read);
-		dest += byte_to_read;
-	} while (byte_read >= byte_to_read);
-
-	if (fret != FR_OK) {
+	/* One multi-block read per contiguous extent of the file */
+	fret = f_read_extents(&file, (void *)dest, &byte_read);
+	if ((fret != FR_OK) || (byte_read != f_size(&file))) {
 		dbg_info("*** FATFS: f_read: error\n");
-		 ret = -1;
+		ret = -1;
 		goto read_fail;
 	}
 	ret = 0;
@@ -70,6 +77,216 @@ open_fail:
 	return ret;
 
 }
+#endif
+
+#ifdef CONFIG_FIT
+static int sdcard_read_fit(void *priv, unsigned int offset,
+			unsigned int len, unsigned char *dest)
+{
+	FIL	*file = priv;
+	UINT	byte_read;
+
+	if (f_lseek(file, offset) != FR_OK)
+		return -1;
+
+	if ((f_read(file, dest, len, &byte_read) != FR_OK)
+		|| (byte_read != len))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Returns 1 if the file is not a FIT image, and is to be loaded by
+ * sdcard_loadimage().
+ */
+static int sdcard_loadfit(struct image_info *image)
+{
+	FIL 	file;
+	UINT	byte_read;
+	FRESULT	fret;
+	int	ret;
+
+	fret = f_open(&file, image->filename, FA_OPEN_EXISTING | FA_READ);
+	if (fret != FR_OK) {
+		dbg_info("*** FATFS: f_open, filename: [%s]: error\n",
+							image->filename);
+		return -1;
+	}
+
+	fret = f_read(&file, image->dest, 512, &byte_read);
+	if ((fret != FR_OK) || fit_check_header(image->dest)) {
+		f_close(&file);
+		return 1;
+	}
+
+	dbg_info("SD/MMC: Image: Load FIT image %s\n", image->filename);
+
+	ret = fit_load(image, sdcard_read_fit, &file);
+
+	f_close(&file);
+
+	return ret;
+}
+#endif
+
+#if defined(CONFIG_KERNEL_STREAM) || defined(CONFIG_SECURE_STREAM)
+static int sdcard_read_stream(void *priv, unsigned char *buf, unsigned int len)
+{
+	UINT	byte_read;
+
+	if (f_read((FIL *)priv, buf, len, &byte_read) != FR_OK)
+		return -1;
+
+	return byte_read;
+}
+#endif
+
+#ifdef CONFIG_SECURE_STREAM
+static int sdcard_securestream(struct image_info *image)
+{
+	FIL 	file;
+	FRESULT	fret;
+	int	ret;
+
+	fret = f_open(&file, image->filename, FA_OPEN_EXISTING | FA_READ);
+	if (fret != FR_OK) {
+		dbg_info("*** FATFS: f_open, filename: [%s]: error\n",
+							image->filename);
+		return -1;
+	}
+
+	dbg_info("SD/MMC: Image: Stream file %s to %d\n",
+					image->filename, image->dest);
+
+	ret = secure_load_stream(image, sdcard_read_stream, &file);
+
+	f_close(&file);
+
+	return ret;
+}
+#endif
+
+#ifdef CONFIG_KERNEL_STREAM
+/*
+ * Returns 1 if the file is not a compressed kernel, and is to be loaded
+ * by sdcard_loadimage().
+ */
+static int sdcard_streamimage(struct image_info *image)
+{
+	FIL 	file;
+	UINT	byte_read;
+	FRESULT	fret;
+	int	ret;
+
+	fret = f_open(&file, image->filename, FA_OPEN_EXISTING | FA_READ);
+	if (fret != FR_OK) {
+		dbg_info("*** FATFS: f_open, filename: [%s]: error\n",
+							image->filename);
+		return -1;
+	}
+
+	fret = f_read(&file, image->dest, 512, &byte_read);
+	f_close(&file);
+	if ((fret != FR_OK) || !kernel_is_compressed(image->dest))
+		return 1;
+
+	/* the stream starts at the top of the file again */
+	fret = f_open(&file, image->filename, FA_OPEN_EXISTING | FA_READ);
+	if (fret != FR_OK)
+		return -1;
+
+	dbg_info("SD/MMC: Image: Stream file %s\n", image->filename);
+
+	ret = load_kernel_stream(image, f_size(&file),
+				sdcard_read_stream, NULL, &file);
+
+	f_close(&file);
+
+	return ret;
+}
+#endif
+
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+/*
+ * The payload of a uImage is read straight to its load address, other
+ * kernel images are read to image->dest by sdcard_loadimage().
+ */
+static int sdcard_loadkernel(struct image_info *image)
+{
+	struct kernel_payload payload;
+	FIL 	file;
+	UINT	byte_read;
+	FRESULT	fret;
+	int	ret = -1;
+
+	fret = f_open(&file, image->filename, FA_OPEN_EXISTING | FA_READ);
+	if (fret != FR_OK) {
+		dbg_info("*** FATFS: f_open, filename: [%s]: error\n",
+							image->filename);
+		return -1;
+	}
+
+	fret = f_read(&file, image->dest, 512, &byte_read);
+	if ((fret != FR_OK)
+		|| kernel_get_payload(image, byte_read, &payload)) {
+		f_close(&file);
+
+		dbg_info("SD/MMC: Image: Read file %s to %d\n",
+					image->filename, image->dest);
+
+		return sdcard_loadimage(image->filename, image->dest);
+	}
+
+	dbg_info("SD/MMC: Image: Read file %s payload to %d\n",
+					image->filename, payload.dest);
+
+	/* the rest of the file, from the second sector */
+	fret = f_read_extents(&file, (void *)payload.dest, &byte_read);
+	if ((fret != FR_OK) || (byte_read < payload.size))
+		dbg_info("*** FATFS: f_read: error\n");
+	else
+		ret = 0;
+
+	f_close(&file);
+
+	return ret;
+}
+#endif
+
+#ifdef CONFIG_LOAD_INITRD
+/* The file size is the ramdisk size, unless it is a uImage */
+static int sdcard_loadinitrd(struct image_info *image)
+{
+	FIL 	file;
+	UINT	byte_read;
+	FRESULT	fret;
+	int	ret = -1;
+
+	fret = f_open(&file, image->initrd_filename,
+					FA_OPEN_EXISTING | FA_READ);
+	if (fret != FR_OK) {
+		dbg_info("*** FATFS: f_open, filename: [%s]: error\n",
+						image->initrd_filename);
+		return -1;
+	}
+
+	dbg_info("SD/MMC: initrd: Read file %s to %d\n",
+			image->initrd_filename, image->initrd_dest);
+
+	fret = f_read_extents(&file, (void *)image->initrd_dest, &byte_read);
+	if ((fret != FR_OK) || (byte_read != f_size(&file))) {
+		dbg_info("*** FATFS: f_read: error\n");
+	} else {
+		image->initrd_length = byte_read;
+		ret = initrd_verify(image->initrd_dest, byte_read);
+	}
+
+	f_close(&file);
+
+	return ret;
+}
+#endif
 
 int load_sdcard(struct image_info *image)
 {
@@ -85,20 +302,66 @@ int load_sdcard(struct image_info *image)
 	at91_sdhc_hw_init();
 #endif
 
-	/* mount fs */
+	/* mount fs once, for all the files */
 	fret = f_mount(0, &fs);
 	if (fret != FR_OK) {
 		dbg_info("*** FATFS: f_mount mount error **\n");
 		return -1;
 	}
 
-	dbg_info("SD/MMC: Image: Read file %s to %d\n",
-					image->filename, image->dest);
+	profile_mark("media probe");
+
+#ifdef CONFIG_FIT
+	ret = sdcard_loadfit(image);
+	if (ret != 1)
+		goto umount;
+#endif
 
-	ret = sdcard_loadimage(image->filename, image->dest);
+#ifdef CONFIG_KERNEL_STREAM
+	ret = sdcard_streamimage(image);
+	if (ret == 1)
+#endif
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+		ret = sdcard_loadkernel(image);
+#elif defined(CONFIG_SECURE_STREAM)
+		ret = sdcard_securestream(image);
+#else
+	{
+		dbg_info("SD/MMC: Image: Read file %s to %d\n",
+						image->filename, image->dest);
+
+		ret = sdcard_loadimage(image->filename, image->dest);
+	}
+#endif
 	if (ret)
-		return ret;
+		goto umount;
+
+	profile_mark("image");
+
+#ifdef CONFIG_OF_LIBFDT
+	at91_board_set_dtb_name(image->of_filename);
+
+	dbg_info("SD/MMC: dt blob: Read file %s to %d\n",
+			image->of_filename, image->of_dest);
+
+	ret = sdcard_loadimage(image->of_filename, image->of_dest);
+	if (ret)
+		goto umount;
+
+	profile_mark("dt blob");
+#endif
+
+#ifdef CONFIG_LOAD_INITRD
+	ret = sdcard_loadinitrd(image);
+	if (ret)
+		goto umount;
+
+	profile_mark("initrd");
+#endif
+
+	disk_cache_show_stats();
 
+umount:
 	/* umount fs */
 	fret = f_mount(0, NULL);
 	if (fret != FR_OK) {
@@ -106,30 +369,490 @@ int load_sdcard(struct image_info *image)
 		return -1;
 	}
 
+	return ret;
+}
+
+#else /* CONFIG_SDCARD_RAW */
+
+#define SDCARD_BLOCK_SIZE	512
+
+struct sdcard_raw_part {
+	unsigned int start;	/* first block */
+	unsigned int blocks;	/* 0: size unknown */
+};
+
+#ifdef CONFIG_SDCARD_RAW_GPT
+/*
+ * Refer to UEFI Specification Version 2.4
+ * 5.3 GUID Partition Table (GPT) Disk Layout
+ * The 64-bit LBA fields are kept as two words, only the low one is used.
+ */
+#define GPT_HEADER_LBA		1
+#define GPT_HEADER_SIGNATURE	"EFI PART"
+#define GPT_ENTRY_SIZE		128
+#define GPT_NAME_LEN		36
+#define GPT_GUID_STR_LEN	36
+
+struct gpt_header {
+	unsigned char	signature[8];
+	unsigned int	revision;
+	unsigned int	header_size;
+	unsigned int	header_crc32;
+	unsigned int	reserved;
+	unsigned int	my_lba[2];
+	unsigned int	alternate_lba[2];
+	unsigned int	first_usable_lba[2];
+	unsigned int	last_usable_lba[2];
+	unsigned char	disk_guid[16];
+	unsigned int	partition_entry_lba[2];
+	unsigned int	num_partition_entries;
+	unsigned int	sizeof_partition_entry;
+	unsigned int	partition_entry_array_crc32;
+};
+
+struct gpt_entry {
+	unsigned char	type_guid[16];
+	unsigned char	unique_guid[16];
+	unsigned int	starting_lba[2];
+	unsigned int	ending_lba[2];
+	unsigned int	attributes[2];
+	unsigned short	name[GPT_NAME_LEN];
+};
+
+static int hex_to_nibble(char c)
+{
+	if ((c >= '0') && (c <= '9'))
+		return c - '0';
+	if ((c >= 'a') && (c <= 'f'))
+		return c - 'a' + 10;
+	if ((c >= 'A') && (c <= 'F'))
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+/*
+ * Convert "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" to the on-disk layout,
+ * where the first three fields are stored little endian.
+ */
+static int gpt_parse_guid(const char *str, unsigned char *guid)
+{
+	static const unsigned char order[16] = {
+		3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15
+	};
+	int hi, lo;
+	unsigned int i, j;
+
+	if (strlen(str) != GPT_GUID_STR_LEN)
+		return -1;
+
+	for (i = 0, j = 0; i < 16; i++) {
+		if ((i == 4) || (i == 6) || (i == 8) || (i == 10)) {
+			if (str[j++] != '-')
+				return -1;
+		}
+
+		hi = hex_to_nibble(str[j++]);
+		lo = hex_to_nibble(str[j++]);
+		if ((hi < 0) || (lo < 0))
+			return -1;
+
+		guid[order[i]] = (hi << 4) | lo;
+	}
+
+	return 0;
+}
+
+static int gpt_name_match(const unsigned short *name, const char *str)
+{
+	unsigned int i;
+
+	for (i = 0; i < GPT_NAME_LEN; i++) {
+		if (name[i] != (unsigned char)str[i])
+			return 0;
+		if (!str[i])
+			return 1;
+	}
+
+	return str[i] ? 0 : 1;
+}
+
+static int gpt_find_partition(const char *part_name,
+				struct sdcard_raw_part *part)
+{
+	unsigned int buf[SDCARD_BLOCK_SIZE / 4];
+	struct gpt_header *header = (struct gpt_header *)buf;
+	struct gpt_entry *entry;
+	unsigned char guid[16];
+	unsigned int entry_lba, entries, entry_size, per_block;
+	unsigned int by_guid;
+	unsigned int i;
+
+	by_guid = gpt_parse_guid(part_name, guid) ? 0 : 1;
+
+	if (sdcard_block_read(GPT_HEADER_LBA, 1, buf) != 1)
+		return -1;
+
+	if (memcmp(header->signature, GPT_HEADER_SIGNATURE, 8)) {
+		dbg_info("SD/MMC: No GPT found\n");
+		return -1;
+	}
+
+	entry_lba = header->partition_entry_lba[0];
+	entries = header->num_partition_entries;
+	entry_size = header->sizeof_partition_entry;
+	if ((entry_size < GPT_ENTRY_SIZE)
+		|| (entry_size > SDCARD_BLOCK_SIZE)
+		|| (SDCARD_BLOCK_SIZE % entry_size)) {
+		dbg_info("SD/MMC: GPT: Unsupported entry size: %d\n",
+							entry_size);
+		return -1;
+	}
+
+	per_block = SDCARD_BLOCK_SIZE / entry_size;
+
+	for (i = 0; i < entries; i++) {
+		if ((i % per_block) == 0) {
+			if (sdcard_block_read(entry_lba + i / per_block,
+							1, buf) != 1)
+				return -1;
+		}
+
+		entry = (struct gpt_entry *)((unsigned char *)buf
+					+ (i % per_block) * entry_size);
+
+		if (by_guid) {
+			if (memcmp(entry->unique_guid, guid, 16))
+				continue;
+		} else {
+			if (!gpt_name_match(entry->name, part_name))
+				continue;
+		}
+
+		if (entry->starting_lba[1] || entry->ending_lba[1]) {
+			dbg_info("SD/MMC: GPT: Partition beyond 2TiB\n");
+			return -1;
+		}
+
+		part->start = entry->starting_lba[0];
+		part->blocks = entry->ending_lba[0] - part->start + 1;
+
+		dbg_loud("SD/MMC: GPT: %s at block %d, %d blocks\n",
+				part_name, part->start, part->blocks);
+
+		return 0;
+	}
+
+	dbg_info("SD/MMC: GPT: Partition %s not found\n", part_name);
+
+	return -1;
+}
+#endif /* #ifdef CONFIG_SDCARD_RAW_GPT */
+
+static int sdcard_raw_read(struct sdcard_raw_part *part,
+			unsigned int offset,
+			unsigned int length,
+			unsigned char *dest)
+{
+	unsigned int block, blocks;
+
+	if (offset % SDCARD_BLOCK_SIZE) {
+		dbg_info("SD/MMC: Offset %d is not block aligned\n", offset);
+		return -1;
+	}
+
+	block = offset / SDCARD_BLOCK_SIZE;
+	blocks = (length + SDCARD_BLOCK_SIZE - 1) / SDCARD_BLOCK_SIZE;
+
+	if (part->blocks && ((block + blocks) > part->blocks)) {
+		dbg_info("SD/MMC: Read beyond the partition end\n");
+		return -1;
+	}
+
+	if (sdcard_block_read(part->start + block, blocks, dest) != blocks)
+		return -1;
+
+	return 0;
+}
+
+#ifdef CONFIG_FIT
+struct sdcard_fit {
+	struct sdcard_raw_part	*part;
+	unsigned int		offset;
+};
+
+static int sdcard_read_fit(void *priv, unsigned int offset,
+			unsigned int len, unsigned char *dest)
+{
+	struct sdcard_fit *fit = priv;
+
+	return sdcard_raw_read(fit->part, fit->offset + offset, len, dest);
+}
+#endif
+
+#if defined(CONFIG_KERNEL_STREAM) || defined(CONFIG_SECURE_STREAM)
+struct sdcard_stream {
+	struct sdcard_raw_part	*part;
+	unsigned int		offset;
+	unsigned int		blocks;	/* of the read started */
+};
+
+/*
+ * The read of the next blocks of the stream is started, and completed by
+ * sdcard_read_stream_wait(), which returns the count of bytes read. The
+ * blocks are moved by the DMA of the host in between, when it has one.
+ */
+static int sdcard_read_stream_start(void *priv,
+				unsigned char *buf,
+				unsigned int len)
+{
+	struct sdcard_stream *stream = priv;
+	struct sdcard_raw_part *part = stream->part;
+	unsigned int block = stream->offset / SDCARD_BLOCK_SIZE;
+	unsigned int blocks = len / SDCARD_BLOCK_SIZE;
+
+	/* do not read past the partition end */
+	if (part->blocks && (blocks > part->blocks - block))
+		blocks = part->blocks - block;
+
+	stream->blocks = blocks;
+	if (blocks)
+		sdcard_block_read_start(part->start + block, blocks, buf);
+
+	return 0;
+}
+
+static int sdcard_read_stream_wait(void *priv)
+{
+	struct sdcard_stream *stream = priv;
+	unsigned int blocks = stream->blocks;
+
+	if (blocks == 0)
+		return 0;
+
+	stream->blocks = 0;
+	if (sdcard_block_read_wait() != blocks)
+		return -1;
+
+	stream->offset += blocks * SDCARD_BLOCK_SIZE;
+
+	return blocks * SDCARD_BLOCK_SIZE;
+}
+
+static int sdcard_read_stream(void *priv, unsigned char *buf, unsigned int len)
+{
+	sdcard_read_stream_start(priv, buf, len);
+
+	return sdcard_read_stream_wait(priv);
+}
+#endif
+
+#ifdef CONFIG_KERNEL_STREAM
+static struct image_read_async sdcard_stream_async = {
+	.start = sdcard_read_stream_start,
+	.wait = sdcard_read_stream_wait,
+};
+#endif
+
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+static int update_image_length(struct sdcard_raw_part *part,
+				unsigned int offset,
+				unsigned char *dest)
+{
+	int ret;
+
+	ret = sdcard_raw_read(part, offset, SDCARD_BLOCK_SIZE, dest);
+	if (ret)
+		return -1;
+
+	return kernel_size(dest);
+}
+#endif
+
+static int sdcard_read_part(void *priv, unsigned int offset,
+			unsigned int len, unsigned char *dest)
+{
+	return sdcard_raw_read((struct sdcard_raw_part *)priv,
+					offset, len, dest);
+}
+
+#if defined(CONFIG_SDCARD_RAW_GPT) \
+	&& (defined(CONFIG_OF_LIBFDT) || defined(CONFIG_LOAD_INITRD))
+/* The DT blob and the initrd are in their own partitions */
+static int sdcard_gpt_sources(struct load_manifest *manifest,
+				struct sdcard_raw_part *parts)
+{
+	struct load_entry *entry;
+	const char *name;
+	int i;
+
+	for (i = 0; i < manifest->count; i++) {
+		entry = &manifest->entries[i];
+
+		switch (entry->type) {
 #ifdef CONFIG_OF_LIBFDT
-	at91_board_set_dtb_name(image->of_filename);
+		case DT_BLOB:
+			name = CONFIG_SDCARD_GPT_OF_PART;
+			break;
+#endif
+#ifdef CONFIG_LOAD_INITRD
+		case INITRD_IMAGE:
+			name = CONFIG_SDCARD_GPT_INITRD_PART;
+			break;
+#endif
+		default:
+			continue;
+		}
 
-	/* mount fs */
-	fret = f_mount(0, &fs);
-	if (fret != FR_OK) {
-		dbg_info("*** FATFS: f_mount error **\n");
+		if (gpt_find_partition(name, &parts[i]))
+			return -1;
+
+		entry->source = &parts[i];
+	}
+
+	return 0;
+}
+#endif
+
+int load_sdcard(struct image_info *image)
+{
+	struct load_manifest manifest;
+	struct sdcard_raw_part part;
+#if defined(CONFIG_SDCARD_RAW_GPT) \
+	&& (defined(CONFIG_OF_LIBFDT) || defined(CONFIG_LOAD_INITRD))
+	struct sdcard_raw_part parts[MANIFEST_MAX_ENTRIES];
+#endif
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	struct kernel_payload payload;
+	int length;
+#endif
+	int ret;
+
+#ifdef CONFIG_AT91_MCI
+	at91_mci0_hw_init();
+#endif
+
+#ifdef CONFIG_SDHC
+	at91_sdhc_hw_init();
+#endif
+
+	ret = sdcard_initialize();
+	if (ret) {
+		dbg_info("SD/MMC: Failed to initialize card\n");
 		return -1;
 	}
 
-	dbg_info("SD/MMC: dt blob: Read file %s to %d\n",
-			image->of_filename, image->of_dest);
+	memset(&part, 0, sizeof(part));
 
-	ret = sdcard_loadimage(image->of_filename, image->of_dest);
+#ifdef CONFIG_SDCARD_RAW_BOOTPART
+	ret = sdcard_switch_partition(CONFIG_SDCARD_BOOTPART);
+	if (ret)
+		return -1;
+#else
+	ret = gpt_find_partition(CONFIG_SDCARD_GPT_IMG_PART, &part);
 	if (ret)
-		return ret;
+		return -1;
+#endif
 
-	/* umount fs */
-	fret = f_mount(0, NULL);
-	if (fret != FR_OK) {
-		dbg_info("*** FATFS: f_mount umount error **\n");
+	profile_mark("media probe");
+
+	manifest_init(&manifest, "SD/MMC");
+
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	length = update_image_length(&part, image->offset, image->dest);
+	if (length == -1)
 		return -1;
+
+	image->length = length;
+#endif
+
+#ifdef CONFIG_FIT
+	if (fit_check_header(image->dest) == 0) {
+		struct sdcard_fit fit;
+
+		fit.part = &part;
+		fit.offset = image->offset;
+
+		ret = fit_load(image, sdcard_read_fit, &fit);
+		if (ret)
+			return ret;
+
+		goto done;
 	}
 #endif
 
+#ifdef CONFIG_KERNEL_STREAM
+	if (kernel_is_compressed(image->dest)) {
+		struct sdcard_stream stream;
+
+		stream.part = &part;
+		stream.offset = image->offset;
+
+		dbg_info("SD/MMC: Image: Stream %d bytes from %d\n",
+				image->length, image->offset);
+
+		ret = load_kernel_stream(image, image->length,
+					sdcard_read_stream, &sdcard_stream_async,
+					&stream);
+	} else
+#endif
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (kernel_get_payload(image, SDCARD_BLOCK_SIZE, &payload) == 0) {
+		manifest_add(&manifest, KERNEL_IMAGE,
+				image->offset + payload.offset, payload.dest,
+				&payload.size, NULL);
+	} else
+#endif
+#ifdef CONFIG_SECURE_STREAM
+	{
+		struct sdcard_stream stream;
+
+		stream.part = &part;
+		stream.offset = image->offset;
+
+		dbg_info("SD/MMC: Image: Stream from %d to %d\n",
+				image->offset, image->dest);
+
+		ret = secure_load_stream(image, sdcard_read_stream, &stream);
+	}
+#else
+	{
+		manifest_add(&manifest, KERNEL_IMAGE, image->offset,
+				image->dest, &image->length, NULL);
+	}
+#endif
+	if (ret) {
+		dbg_info("SD/MMC: Image: Read error\n");
+		return -1;
+	}
+
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (image_manifest_add(image, &manifest))
+		return -1;
+#endif
+
+#if defined(CONFIG_SDCARD_RAW_GPT) \
+	&& (defined(CONFIG_OF_LIBFDT) || defined(CONFIG_LOAD_INITRD))
+	if (sdcard_gpt_sources(&manifest, parts))
+		return -1;
+#endif
+
+	ret = manifest_load(&manifest, sdcard_read_part, &part,
+						SDCARD_BLOCK_SIZE);
+	if (ret)
+		return -1;
+
+#ifdef CONFIG_FIT
+done:
+#endif
+#ifdef CONFIG_SDCARD_RAW_BOOTPART
+	/* Leave the user area selected for the next stage */
+	ret = sdcard_switch_partition(0);
+	if (ret)
+		return -1;
+#endif
+
 	return 0;
 }
+
+#endif /* #ifndef CONFIG_SDCARD_RAW */
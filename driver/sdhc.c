@@ -31,6 +31,7 @@
 #include "div.h"
 #include "timer.h"
 #include "debug.h"
+#include "usart.h"
 #include "pmc.h"
 
 /*
@@ -270,6 +271,47 @@
 #define	SDMMC_HC1R_CARDDTL	(0x1 << 6)	/* Card Detect Test Level */
 #define	SDMMC_HC1R_CARDDSEL	(0x1 << 7)	/* Card Detect Signal Selection */
 
+/* SDMMC_HC2R */
+#define	SDMMC_HC2R_UHSMS	(0x7 << 0)	/* UHS Mode Select */
+#define		SDMMC_HC2R_UHSMS_SDR12		(0x0 << 0)
+#define		SDMMC_HC2R_UHSMS_SDR25		(0x1 << 0)
+#define		SDMMC_HC2R_UHSMS_SDR50		(0x2 << 0)
+#define		SDMMC_HC2R_UHSMS_SDR104		(0x3 << 0)
+#define		SDMMC_HC2R_UHSMS_DDR50		(0x4 << 0)
+#define	SDMMC_HC2R_VS18EN	(0x1 << 3)	/* 1.8V Signaling Enable */
+#define	SDMMC_HC2R_DRVSEL	(0x3 << 4)	/* Driver Strength Select */
+#define	SDMMC_HC2R_EXTUN	(0x1 << 6)	/* Execute Tuning */
+#define	SDMMC_HC2R_SCLKSEL	(0x1 << 7)	/* Sampling Clock Select */
+#define	SDMMC_HC2R_ASINTEN	(0x1 << 14)	/* Asynchronous Interrupt Enable */
+#define	SDMMC_HC2R_PVALEN	(0x1 << 15)	/* Preset Value Enable */
+
+/* SDMMC_AESR */
+#define	SDMMC_AESR_ERRST	(0x3 << 0)	/* ADMA Error State */
+#define	SDMMC_AESR_LMIS		(0x1 << 2)	/* ADMA Length Mismatch Error */
+
+/*
+ * ADMA2 32-bit Descriptor
+ */
+#define	SDHC_ADMA2_ATTR_VALID	(0x1 << 0)	/* Valid */
+#define	SDHC_ADMA2_ATTR_END	(0x1 << 1)	/* End of Descriptor */
+#define	SDHC_ADMA2_ATTR_INT	(0x1 << 2)	/* Interrupt */
+#define	SDHC_ADMA2_ATTR_ACT	(0x3 << 4)	/* Action */
+#define		SDHC_ADMA2_ATTR_ACT_NOP		(0x0 << 4)
+#define		SDHC_ADMA2_ATTR_ACT_TRAN	(0x2 << 4)
+#define		SDHC_ADMA2_ATTR_ACT_LINK	(0x3 << 4)
+
+/* A length field of 0 stands for 65536 bytes */
+#define	SDHC_ADMA2_MAX_LEN	0x10000
+
+#define	SDHC_ADMA2_DESC_NUM	32
+#define	SDHC_ADMA2_MAX_BLOCKS	(SDHC_ADMA2_DESC_NUM * (SDHC_ADMA2_MAX_LEN / 512))
+
+struct sdhc_adma2_desc {
+	unsigned short	attr;
+	unsigned short	len;
+	unsigned int	addr;
+};
+
 /*---------------------------------------------------------------*/
 
 static unsigned int sdhc_get_base(void)
@@ -436,6 +478,156 @@ static int sdhc_set_bus_width(struct sd_card *sdcard, unsigned int width)
 	return 0;
 }
 
+#ifdef CONFIG_SDHC_UHS
+static void sdhc_sd_clock_enable(int enable)
+{
+	unsigned short reg = sdhc_readw(SDMMC_CCR);
+
+	if (enable)
+		reg |= SDMMC_CCR_SDCLKEN;
+	else
+		reg &= ~SDMMC_CCR_SDCLKEN;
+
+	sdhc_writew(SDMMC_CCR, reg);
+}
+
+/*
+ * Refer to SD Host Controller Simplified Specification Version 3.00
+ * 3.6.1 Signal Voltage Switch Procedure
+ */
+static int sdhc_set_signal_voltage(struct sd_card *sdcard,
+				unsigned int voltage)
+{
+	unsigned short reg;
+
+	reg = sdhc_readw(SDMMC_HC2R);
+
+	if (voltage == SD_SIGNAL_VOLTAGE_330) {
+		sdhc_writew(SDMMC_HC2R, reg & ~SDMMC_HC2R_VS18EN);
+		return 0;
+	}
+
+	sdhc_sd_clock_enable(0);
+
+	/* An SD card drives DAT[3:0] low once it accepted CMD11 */
+	if ((sdcard->card_type == CARD_TYPE_SD)
+		&& (sdhc_readl(SDMMC_PSR) & SDMMC_PSR_DATLL))
+		return -1;
+
+	sdhc_writew(SDMMC_HC2R, reg | SDMMC_HC2R_VS18EN);
+
+	mdelay(5);
+
+	if (!(sdhc_readw(SDMMC_HC2R) & SDMMC_HC2R_VS18EN))
+		return -1;
+
+	sdhc_sd_clock_enable(1);
+
+	mdelay(1);
+
+	if ((sdhc_readl(SDMMC_PSR) & SDMMC_PSR_DATLL) != SDMMC_PSR_DATLL) {
+		dbg_info("SDHC: DAT lines not high after 1.8V switch\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int sdhc_set_timing(struct sd_card *sdcard, unsigned int timing)
+{
+	unsigned short reg;
+	unsigned char mc1r;
+
+	/* The UHS mode may only be changed while SDCLK is stopped */
+	sdhc_sd_clock_enable(0);
+
+	reg = sdhc_readw(SDMMC_HC2R) & ~SDMMC_HC2R_UHSMS;
+	mc1r = sdhc_readb(SDMMC_MC1R) & ~SDMMC_MC1R_DDR;
+
+	switch (timing) {
+	case SD_TIMING_HS:
+		reg |= SDMMC_HC2R_UHSMS_SDR25;
+		break;
+	case SD_TIMING_SDR50:
+		reg |= SDMMC_HC2R_UHSMS_SDR50;
+		break;
+	case SD_TIMING_SDR104:
+	case MMC_TIMING_HS200:
+		reg |= SDMMC_HC2R_UHSMS_SDR104;
+		break;
+	case MMC_TIMING_DDR52:
+		reg |= SDMMC_HC2R_UHSMS_DDR50;
+		mc1r |= SDMMC_MC1R_DDR;
+		break;
+	default:
+		reg |= SDMMC_HC2R_UHSMS_SDR12;
+		break;
+	}
+
+	sdhc_writew(SDMMC_HC2R, reg);
+	sdhc_writeb(SDMMC_MC1R, mc1r);
+
+	sdhc_sd_clock_enable(1);
+
+	return 0;
+}
+
+static int sdhc_send_command(struct sd_command *sd_cmd, struct sd_data *data);
+
+/*
+ * Refer to SD Host Controller Simplified Specification Version 3.00
+ * 2.2.18 Host Control 2 Register, Figure 2-29: Tuning Procedure
+ */
+#define SDHC_TUNING_LOOPS	40
+
+static int sdhc_execute_tuning(struct sd_card *sdcard, unsigned int cmd)
+{
+	struct sd_command command;
+	struct sd_data data;
+	unsigned int tuning_block[32];
+	unsigned short reg;
+	unsigned int i;
+
+	reg = sdhc_readw(SDMMC_HC2R) & ~SDMMC_HC2R_SCLKSEL;
+	sdhc_writew(SDMMC_HC2R, reg | SDMMC_HC2R_EXTUN);
+
+	for (i = 0; i < SDHC_TUNING_LOOPS; i++) {
+		command.cmd = cmd;
+		command.resp_type = SD_RESP_TYPE_R1;
+		command.argu = 0;
+
+		data.buff = (unsigned char *)tuning_block;
+		data.direction = SD_DATA_DIR_RD;
+		data.blocks = 1;
+		data.blocksize = ((cmd == MMC_CMD_SEND_TUNING_BLOCK_HS200)
+				&& (sdhc_readb(SDMMC_HC1R) & SDMMC_HC1R_EXTDW)) ?
+				128 : 64;
+
+		sdhc_send_command(&command, &data);
+
+		if (!(sdhc_readw(SDMMC_HC2R) & SDMMC_HC2R_EXTUN))
+			break;
+	}
+
+	reg = sdhc_readw(SDMMC_HC2R);
+	if ((reg & (SDMMC_HC2R_EXTUN | SDMMC_HC2R_SCLKSEL))
+					!= SDMMC_HC2R_SCLKSEL) {
+		sdhc_writew(SDMMC_HC2R,
+			reg & ~(SDMMC_HC2R_EXTUN | SDMMC_HC2R_SCLKSEL));
+
+		sdhc_softare_reset_cmd();
+		sdhc_softare_reset_dat();
+
+		dbg_info("SDHC: Tuning failed\n");
+		return -1;
+	}
+
+	dbg_loud("SDHC: Tuning done in %d loops\n", i + 1);
+
+	return 0;
+}
+#endif
+
 static int sdhc_host_capability(struct sd_card *sdcard)
 {
 	struct sd_host *host = sdcard->host;
@@ -462,11 +654,34 @@ static int sdhc_host_capability(struct sd_card *sdcard)
 	if (caps & SDMMC_CA0R_V18VSUP)
 		host->caps_voltages |= SD_OCR_VDD_165_195;
 
+	host->caps_max_blocks = 0;
+#ifdef CONFIG_SDHC_ADMA
+	if (caps & SDMMC_CA0R_ADMA2SUP)
+		host->caps_max_blocks = SDHC_ADMA2_MAX_BLOCKS;
+#endif
+
+	host->caps_uhs = 0;
+#ifdef CONFIG_SDHC_UHS
+	if (caps & SDMMC_CA0R_V18VSUP)
+		host->caps_uhs |= HOST_CAPS_1V8;
+#endif
+
 	caps = sdhc_readl(SDMMC_CA1R);
 
 	host->caps_clk_mult = (caps >> SDMMC_CA1R_CLKMULT_OFFSET)
 						& SDMMC_CA1R_CLKMULT_MSK;
 
+#ifdef CONFIG_SDHC_UHS
+	if (caps & SDMMC_CA1R_SDR50SUP)
+		host->caps_uhs |= HOST_CAPS_SDR50;
+	if (caps & SDMMC_CA1R_SDR104SUP)
+		host->caps_uhs |= HOST_CAPS_SDR104;
+	if (caps & SDMMC_CA1R_DDR50SUP)
+		host->caps_uhs |= HOST_CAPS_DDR50;
+	if (caps & SDMMC_CA1R_TSDR50)
+		host->caps_uhs |= HOST_CAPS_TUNE_SDR50;
+#endif
+
 	return 0;
 }
 
@@ -491,6 +706,9 @@ static int sdhc_init(struct sd_card *sdcard)
 				| SDMMC_EISTR_DATTEO
 				| SDMMC_EISTR_DATCRC
 				| SDMMC_EISTR_DATEND;
+#ifdef CONFIG_SDHC_ADMA
+	error_status_mask |= SDMMC_EISTR_ADMA;
+#endif
 
 	sdhc_writew(SDMMC_NISTER, normal_status_mask);
 	sdhc_writew(SDMMC_EISTER, error_status_mask);
@@ -549,6 +767,8 @@ static int sdhc_read_data(struct sd_data *data)
 			data->buff += data->blocksize;
 			if (++block >= data->blocks)
 				break;
+
+			usart_poll();
 		}
 
 		if (timeout-- > 0) {
@@ -562,11 +782,127 @@ static int sdhc_read_data(struct sd_data *data)
 	return 0;
 }
 
+static struct sd_host sdhc_host;
+
+#ifdef CONFIG_SDHC_ADMA
+static struct sdhc_adma2_desc sdhc_adma2_table[SDHC_ADMA2_DESC_NUM];
+
+/* A transfer left to the ADMA by sdhc_send_command(), see sdhc_wait_data() */
+static int sdhc_adma_pending;
+
+/*
+ * Describe the whole transfer in the descriptor table, each descriptor
+ * covering up to 64KiB of the destination buffer, so that the controller
+ * moves the data by itself once the command is issued.
+ * Return 0 if the transfer has to go through the buffer data port.
+ */
+static int sdhc_adma_prepare(struct sd_data *data)
+{
+	struct sdhc_adma2_desc *desc = sdhc_adma2_table;
+	unsigned int addr = (unsigned int)data->buff;
+	unsigned int size = data->blocks * data->blocksize;
+	unsigned int len;
+
+	if (!sdhc_host.caps_max_blocks)
+		return 0;
+
+	if ((data->direction != SD_DATA_DIR_RD) || (addr & 0x3))
+		return 0;
+
+	if (data->blocks > SDHC_ADMA2_MAX_BLOCKS)
+		return 0;
+
+	while (size) {
+		len = (size > SDHC_ADMA2_MAX_LEN) ? SDHC_ADMA2_MAX_LEN : size;
+
+		desc->attr = SDHC_ADMA2_ATTR_VALID | SDHC_ADMA2_ATTR_ACT_TRAN;
+		desc->len = len & 0xffff;
+		desc->addr = addr;
+
+		addr += len;
+		size -= len;
+		if (!size)
+			desc->attr |= SDHC_ADMA2_ATTR_END;
+		desc++;
+	}
+
+	sdhc_writel(SDMMC_ASAR0, (unsigned int)sdhc_adma2_table);
+
+	return 1;
+}
+
+static void sdhc_adma_select(int enable)
+{
+	unsigned char reg = sdhc_readb(SDMMC_HC1R) & ~SDMMC_HC1R_DMASEL;
+
+	if (enable)
+		reg |= SDMMC_HC1R_DMASEL_ADMA32;
+
+	sdhc_writeb(SDMMC_HC1R, reg);
+}
+
+static int sdhc_adma_wait_transfer(struct sd_data *data)
+{
+	unsigned int normal_status, error_status;
+	unsigned int timeout = 10000000;
+
+	do {
+		normal_status = sdhc_readw(SDMMC_NISTR);
+		if (normal_status & (SDMMC_NISTR_TRFC | SDMMC_NISTR_ERRINT))
+			break;
+
+		udelay(1);
+	} while (--timeout);
+
+	sdhc_writew(SDMMC_NISTR, normal_status);
+
+	if (normal_status & SDMMC_NISTR_ERRINT) {
+		error_status = sdhc_readw(SDMMC_EISTR);
+
+		sdhc_writew(SDMMC_EISTR, error_status);
+
+		sdhc_softare_reset_dat();
+
+		if (error_status & SDMMC_EISTR_ADMA)
+			dbg_info("SDHC: ADMA error, AESR: %x\n",
+					sdhc_readb(SDMMC_AESR));
+		else
+			dbg_info("SDHC: Error detected in status\n");
+
+		return -1;
+	}
+
+	if (!timeout) {
+		sdhc_softare_reset_dat();
+
+		dbg_info("SDHC: Transfer data timeout\n");
+		return -1;
+	}
+
+	data->buff += data->blocks * data->blocksize;
+
+	return 0;
+}
+
+static int sdhc_wait_data(struct sd_data *data)
+{
+	if (!sdhc_adma_pending)
+		return 0;
+
+	sdhc_adma_pending = 0;
+
+	return sdhc_adma_wait_transfer(data);
+}
+#endif
+
 static int sdhc_send_command(struct sd_command *sd_cmd, struct sd_data *data)
 {
 	unsigned int normal_status, error_status, normal_status_mask;
 	unsigned int cmd_reg, mode;
 	unsigned int i;
+#ifdef CONFIG_SDHC_ADMA
+	int use_dma = 0;
+#endif
 	int ret;
 	unsigned int timeout;
 
@@ -611,6 +947,15 @@ static int sdhc_send_command(struct sd_command *sd_cmd, struct sd_data *data)
 		mode |= (data->blocks > 1) ? SDMMC_TMR_MSBSEL : 0;
 		mode |= (data->direction == SD_DATA_DIR_RD) ? SDMMC_TMR_DTDSEL_READ : 0;
 
+#ifdef CONFIG_SDHC_ADMA
+		if ((sd_cmd->cmd != SD_CMD_SEND_TUNING_BLOCK)
+			&& (sd_cmd->cmd != MMC_CMD_SEND_TUNING_BLOCK_HS200))
+			use_dma = sdhc_adma_prepare(data);
+		sdhc_adma_select(use_dma);
+		if (use_dma)
+			mode |= SDMMC_TMR_DMAEN;
+#endif
+
 		sdhc_writeb(SDMMC_TCR, 0xe);
 		sdhc_writew(SDMMC_BSR, data->blocksize);
 		if (data->blocks > 1)
@@ -643,10 +988,17 @@ static int sdhc_send_command(struct sd_command *sd_cmd, struct sd_data *data)
 			*sd_cmd->resp = sdhc_readl(SDMMC_RR0);
 		}
 
-		if (data)
-			sdhc_read_data(data);
-
 		ret = 0;
+		if (data) {
+#ifdef CONFIG_SDHC_ADMA
+			if (use_dma && data->nowait)
+				sdhc_adma_pending = 1;
+			else if (use_dma)
+				ret = sdhc_adma_wait_transfer(data);
+			else
+#endif
+				ret = sdhc_read_data(data);
+		}
 	} else {
 		error_status = sdhc_readw(SDMMC_EISTR);
 
@@ -663,13 +1015,19 @@ static int sdhc_send_command(struct sd_command *sd_cmd, struct sd_data *data)
 	return ret;
 }
 
-static struct sd_host sdhc_host;
-
 static struct host_ops sdhc_ops = {
 	.init = sdhc_init,
 	.send_command = sdhc_send_command,
 	.set_clock = sdhc_set_clock,
 	.set_bus_width = sdhc_set_bus_width,
+#ifdef CONFIG_SDHC_UHS
+	.set_signal_voltage = sdhc_set_signal_voltage,
+	.set_timing = sdhc_set_timing,
+	.execute_tuning = sdhc_execute_tuning,
+#endif
+#ifdef CONFIG_SDHC_ADMA
+	.wait_data = sdhc_wait_data,
+#endif
 };
 
 int sdcard_register_sdhc(struct sd_card *sdcard)
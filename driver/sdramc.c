@@ -29,6 +29,7 @@
 #include "board.h"
 #include "arch/at91_sdramc.h"
 #include "sdramc.h"
+#include "profile.h"
 
 static inline void sdramc_writel(unsigned int reg, const unsigned int value)
 {
@@ -86,5 +87,7 @@ int sdramc_initialize(struct sdramc_register *sdramc_config,
 	/* Step#11 Write the refresh rate into the count field in the SDRAMC Refresh Timer Rgister. */
 	sdramc_writel(SDRAMC_TR, sdramc_config->tr);
 
+	profile_mark("sdram init");
+
 	return 0;
 }
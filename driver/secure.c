@@ -32,6 +32,10 @@
 #include "string.h"
 #include "autoconf.h"
 
+#ifdef CONFIG_SECURE_DIGEST
+#include "sha256.h"
+#endif
+
 
 static inline void init_keys(at91_aes_key_size_t *key_size,
 			     unsigned int *cipher_key,
@@ -125,6 +129,127 @@ exit:
 	return rc;
 }
 
+#ifdef CONFIG_SECURE_DIGEST
+/* Checks the CMAC which follows the "data_length" bytes at "data" */
+static int secure_authenticate(const void *data, unsigned int data_length)
+{
+	at91_aes_key_size_t key_size;
+	unsigned int cmac_key[8], cipher_key[8];
+	unsigned int iv[AT91_AES_IV_SIZE_WORD];
+	unsigned int computed_cmac[AT91_AES_BLOCK_SIZE_WORD];
+	const unsigned int *cmac;
+	int rc = -1;
+
+	init_keys(&key_size, cipher_key, cmac_key, iv);
+
+	at91_aes_init();
+
+	if (at91_aes_cmac(data_length, data, computed_cmac,
+			  key_size, cmac_key))
+		goto exit;
+
+	cmac = (const unsigned int *)((const char *)data
+				+ at91_aes_roundup(data_length));
+	if (memcmp(cmac, computed_cmac, AT91_AES_BLOCK_SIZE_BYTE))
+		goto exit;
+
+	rc = 0;
+exit:
+	at91_aes_cleanup();
+
+	memset(cmac_key, 0, sizeof(cmac_key));
+	memset(cipher_key, 0, sizeof(cipher_key));
+	memset(iv, 0, sizeof(iv));
+
+	return rc;
+}
+
+int secure_check(void *data)
+{
+	const at91_secure_digest_header_t *header = data;
+	unsigned char digest[SHA256_DIGEST_SIZE];
+	struct sha256_ctx ctx;
+
+	/* the header but its CMAC */
+	if (secure_authenticate(header,
+			(unsigned int)header->cmac - (unsigned int)header))
+		return -1;
+
+	if (header->magic != AT91_SECURE_MAGIC)
+		return -1;
+
+	sha256_starts(&ctx);
+	sha256_update(&ctx, (const unsigned char *)data + sizeof(*header),
+				header->file_size);
+	if (sha256_finish(&ctx, digest))
+		return -1;
+
+	return memcmp(digest, header->digest, SHA256_DIGEST_SIZE) ? -1 : 0;
+}
+#elif defined(CONFIG_SECURE_GCM)
+/* The header but its tag is the additional authenticated data */
+static int secure_gcm_start(const at91_secure_gcm_header_t *header,
+			    at91_aes_key_size_t key_size,
+			    const unsigned int *cipher_key)
+{
+	if ((header->magic != AT91_SECURE_MAGIC) || !header->file_size)
+		return -1;
+
+	return at91_aes_gcm_start(0, key_size, cipher_key, header->iv,
+			(unsigned int)header->tag - (unsigned int)header,
+			header, header->file_size);
+}
+
+static int secure_gcm_finish(const at91_secure_gcm_header_t *header)
+{
+	unsigned int tag[AT91_AES_BLOCK_SIZE_WORD];
+
+	if (at91_aes_gcm_finish(tag))
+		return -1;
+
+	if (memcmp(tag, header->tag, AT91_AES_BLOCK_SIZE_BYTE)) {
+		dbg_info("SECURE: Bad tag\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+int secure_check(void *data)
+{
+	const at91_secure_gcm_header_t *header = data;
+	unsigned char *file = (unsigned char *)data + sizeof(*header);
+	at91_aes_key_size_t key_size;
+	unsigned int cmac_key[8], cipher_key[8];
+	unsigned int iv[AT91_AES_IV_SIZE_WORD];
+	int rc = -1;
+
+	init_keys(&key_size, cipher_key, cmac_key, iv);
+
+	at91_aes_init();
+
+	if (secure_gcm_start(header, key_size, cipher_key))
+		goto exit;
+
+	if (at91_aes_gcm_update(header->file_size, file, file))
+		goto exit;
+
+	if (secure_gcm_finish(header)) {
+		memset(file, 0, header->file_size);
+		goto exit;
+	}
+
+	rc = 0;
+exit:
+	at91_aes_cleanup();
+
+	memset(cmac_key, 0, sizeof(cmac_key));
+	memset(cipher_key, 0, sizeof(cipher_key));
+	memset(iv, 0, sizeof(iv));
+
+	return rc;
+}
+#else
 int secure_check(void *data)
 {
 	const at91_secure_header_t *header;
@@ -140,3 +265,263 @@ int secure_check(void *data)
 	file = (unsigned char *)data + sizeof(*header);
 	return secure_decrypt(file, header->file_size, 1);
 }
+#endif
+
+#ifdef CONFIG_SECURE_STREAM
+/*
+ * The media reads whole chunks: up to a chunk past the end of the
+ * application may be written.
+ */
+#define SECURE_STREAM_CHUNK	(16 * 1024)
+
+static int secure_stream_read(image_read_function read, void *priv,
+			      unsigned char *dest, unsigned int *loaded)
+{
+	int ret;
+
+	ret = read(priv, dest + *loaded, SECURE_STREAM_CHUNK);
+	if (ret <= 0) {
+		dbg_info("SECURE: Read error\n");
+		return -1;
+	}
+
+	*loaded += ret;
+
+	return 0;
+}
+
+#ifdef CONFIG_SECURE_DIGEST
+int secure_load_stream(struct image_info *image,
+		       image_read_function read,
+		       void *priv)
+{
+	const at91_secure_digest_header_t *header =
+			(const at91_secure_digest_header_t *)image->dest;
+	unsigned char *file = image->dest + sizeof(*header);
+	unsigned char digest[SHA256_DIGEST_SIZE];
+	struct sha256_ctx ctx;
+	unsigned int loaded = 0;
+	unsigned int hashed = 0;
+	unsigned int end;
+
+	while (loaded < sizeof(*header)) {
+		if (secure_stream_read(read, priv, image->dest, &loaded))
+			return -1;
+	}
+
+	if (secure_authenticate(header,
+			(unsigned int)header->cmac - (unsigned int)header))
+		return -1;
+
+	if (header->magic != AT91_SECURE_MAGIC)
+		return -1;
+
+	dbg_info("SECURE: Stream %d bytes to %d\n", header->file_size, file);
+
+	/* the hash of a chunk runs on while the next one is read */
+	sha256_starts(&ctx);
+	for (;;) {
+		end = loaded - sizeof(*header);
+		if (end > header->file_size)
+			end = header->file_size;
+
+		if (end > hashed) {
+			sha256_update(&ctx, file + hashed, end - hashed);
+			hashed = end;
+		}
+
+		if (hashed == header->file_size)
+			break;
+
+		if (secure_stream_read(read, priv, image->dest, &loaded)) {
+			sha256_finish(&ctx, digest);
+			return -1;
+		}
+	}
+
+	if (sha256_finish(&ctx, digest))
+		return -1;
+
+	return memcmp(digest, header->digest, SHA256_DIGEST_SIZE) ? -1 : 0;
+}
+#elif defined(CONFIG_SECURE_GCM)
+/*
+ * Each chunk is decrypted, and goes through the tag, as soon as it is
+ * read. The tag is compared at the end: the decrypted data is wiped if
+ * it does not match.
+ */
+int secure_load_stream(struct image_info *image,
+		       image_read_function read,
+		       void *priv)
+{
+	at91_aes_key_size_t key_size;
+	unsigned int cmac_key[8], cipher_key[8];
+	unsigned int iv[AT91_AES_IV_SIZE_WORD];
+	const at91_secure_gcm_header_t *header =
+			(const at91_secure_gcm_header_t *)image->dest;
+	unsigned char *file = image->dest + sizeof(*header);
+	unsigned int loaded = 0;
+	unsigned int done = 0;
+	unsigned int end;
+	int rc = -1;
+
+	while (loaded < sizeof(*header)) {
+		if (secure_stream_read(read, priv, image->dest, &loaded))
+			return -1;
+	}
+
+	init_keys(&key_size, cipher_key, cmac_key, iv);
+
+	at91_aes_init();
+
+	if (secure_gcm_start(header, key_size, cipher_key))
+		goto exit;
+
+	dbg_info("SECURE: Stream %d bytes to %d\n", header->file_size, file);
+
+	for (;;) {
+		/* whole blocks, but the end of the file */
+		end = loaded - sizeof(*header);
+		if (end >= header->file_size)
+			end = header->file_size;
+		else
+			end &= ~(AT91_AES_BLOCK_SIZE_BYTE - 1);
+
+		if (end > done) {
+			if (at91_aes_gcm_update(end - done, file + done,
+						file + done))
+				goto exit;
+			done = end;
+		}
+
+		if (done == header->file_size)
+			break;
+
+		if (secure_stream_read(read, priv, image->dest, &loaded))
+			goto exit;
+	}
+
+	if (secure_gcm_finish(header))
+		goto exit;
+
+	rc = 0;
+exit:
+	at91_aes_cleanup();
+
+	if (rc)
+		memset(file, 0, done);
+
+	memset(cmac_key, 0, sizeof(cmac_key));
+	memset(cipher_key, 0, sizeof(cipher_key));
+	memset(iv, 0, sizeof(iv));
+
+	return rc;
+}
+#else
+/*
+ * The CMAC of a chunk is computed, then the chunk is decrypted in place
+ * while the next one is read. The last block of the file completes the
+ * CMAC, which is only compared at the end: the decrypted data is wiped
+ * if it does not match.
+ */
+int secure_load_stream(struct image_info *image,
+		       image_read_function read,
+		       void *priv)
+{
+	at91_aes_key_size_t key_size;
+	unsigned int cmac_key[8], cipher_key[8];
+	unsigned int iv[AT91_AES_IV_SIZE_WORD];
+	unsigned int next_iv[AT91_AES_IV_SIZE_WORD];
+	unsigned int cmac[AT91_AES_BLOCK_SIZE_WORD];
+	const at91_secure_header_t *header =
+			(const at91_secure_header_t *)image->dest;
+	unsigned char *file = image->dest + sizeof(*header);
+	unsigned int loaded = 0;
+	unsigned int done = 0;
+	unsigned int fixed_length;
+	unsigned int end;
+	int rc = -1;
+
+	while (loaded < sizeof(*header)) {
+		if (secure_stream_read(read, priv, image->dest, &loaded))
+			return -1;
+	}
+
+	init_keys(&key_size, cipher_key, cmac_key, iv);
+
+	at91_aes_init();
+
+	if (at91_aes_cbc(sizeof(*header), image->dest, image->dest, 0,
+			 key_size, cipher_key, iv))
+		goto exit;
+
+	if ((header->magic != AT91_SECURE_MAGIC) || !header->file_size)
+		goto exit;
+
+	dbg_info("SECURE: Stream %d bytes to %d\n", header->file_size, file);
+
+	/* the file blocks, then the CMAC */
+	fixed_length = at91_aes_roundup(header->file_size);
+	memset(cmac, 0, sizeof(cmac));
+
+	for (;;) {
+		/* whole blocks, but the last one of the file */
+		end = loaded - sizeof(*header);
+		if (end >= fixed_length)
+			end = fixed_length - AT91_AES_BLOCK_SIZE_BYTE;
+		end &= ~(AT91_AES_BLOCK_SIZE_BYTE - 1);
+
+		if (end > done) {
+			if (at91_aes_cbc_mac(end - done, file + done, cmac,
+					     key_size, cmac_key))
+				goto exit;
+
+			memcpy(next_iv, file + end - AT91_AES_BLOCK_SIZE_BYTE,
+			       AT91_AES_BLOCK_SIZE_BYTE);
+
+			if (at91_aes_cbc_start(end - done, file + done,
+					       file + done, 0,
+					       key_size, cipher_key, iv))
+				goto exit;
+
+			memcpy(iv, next_iv, AT91_AES_BLOCK_SIZE_BYTE);
+			done = end;
+		}
+
+		if (loaded >= sizeof(*header) + fixed_length
+					+ AT91_AES_BLOCK_SIZE_BYTE)
+			break;
+
+		if (secure_stream_read(read, priv, image->dest, &loaded))
+			goto exit;
+	}
+
+	if (at91_aes_cmac_finish(file + done, cmac, key_size, cmac_key))
+		goto exit;
+
+	if (memcmp(file + fixed_length, cmac, AT91_AES_BLOCK_SIZE_BYTE)) {
+		dbg_info("SECURE: Bad CMAC\n");
+		goto exit;
+	}
+
+	if (at91_aes_cbc(AT91_AES_BLOCK_SIZE_BYTE, file + done, file + done,
+			 0, key_size, cipher_key, iv))
+		goto exit;
+
+	rc = 0;
+exit:
+	/* Reset periph */
+	at91_aes_cleanup();
+
+	if (rc)
+		memset(file, 0, done);
+
+	/* Reset keys */
+	memset(cmac_key, 0, sizeof(cmac_key));
+	memset(cipher_key, 0, sizeof(cipher_key));
+	memset(iv, 0, sizeof(iv));
+
+	return rc;
+}
+#endif
+#endif
@@ -35,6 +35,12 @@
 #include "timer.h"
 #include "div.h"
 #include "fdt.h"
+#include "fit.h"
+#include "secure.h"
+#include "manifest.h"
+#include "profile.h"
+#include "boot_trace.h"
+#include "usart.h"
 #include "debug.h"
 
 /* Manufacturer Device ID Read */
@@ -114,6 +120,9 @@ static int df_send_command(unsigned char *cmd,
 	for (i = 0; i < data_len; i++) {
 		at91_spi_write_data(0);
 		*data++ = at91_spi_read_spi();
+
+		if (!(i & 0xff))
+			usart_poll();
 	}
 	at91_spi_cs_deactivate();
 
@@ -197,17 +206,23 @@ static int read_array(struct dataflash_descriptor *df_desc,
 				unsigned int len,
 				void *buf)
 {
+	int ret;
+
 	if (!df_desc->is_spinor)
-		return dataflash_read_array(df_desc, offset, len, buf);
+		ret = dataflash_read_array(df_desc, offset, len, buf);
 	else
-		return spinor_read_array(df_desc, offset, len, buf);
+		ret = spinor_read_array(df_desc, offset, len, buf);
+
+	if (ret == 0)
+		boot_trace_read("SF", len);
+
+	return ret;
 }
 
 #if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
 static int update_image_length(struct dataflash_descriptor *df_desc,
 				unsigned int offset,
-				unsigned char *dest,
-				unsigned char flag)
+				unsigned char *dest)
 {
 	unsigned int length = df_desc->page_size;
 	int ret;
@@ -216,14 +231,46 @@ static int update_image_length(struct dataflash_descriptor *df_desc,
 	if (ret)
 		return -1;
 
-	if (flag == KERNEL_IMAGE)
-		return kernel_size(dest);
-#ifdef CONFIG_OF_LIBFDT
-	else
-		return of_get_dt_total_size((void *)dest);
-#else
-	return -1;
+	return kernel_size(dest);
+}
 #endif
+
+static int df_read(void *priv, unsigned int offset,
+			unsigned int len, unsigned char *dest)
+{
+	return read_array((struct dataflash_descriptor *)priv,
+				offset, len, dest);
+}
+
+#if defined(CONFIG_KERNEL_STREAM) || defined(CONFIG_SECURE_STREAM) \
+	|| defined(CONFIG_FIT)
+struct df_image {
+	struct dataflash_descriptor	*df_desc;
+	unsigned int			offset;
+};
+#endif
+
+#if defined(CONFIG_KERNEL_STREAM) || defined(CONFIG_SECURE_STREAM)
+static int df_read_stream(void *priv, unsigned char *buf, unsigned int len)
+{
+	struct df_image *stream = priv;
+
+	if (read_array(stream->df_desc, stream->offset, len, buf))
+		return -1;
+
+	stream->offset += len;
+
+	return len;
+}
+#endif
+
+#ifdef CONFIG_FIT
+static int df_read_fit(void *priv, unsigned int offset,
+			unsigned int len, unsigned char *dest)
+{
+	struct df_image *fit = priv;
+
+	return read_array(fit->df_desc, fit->offset + offset, len, dest);
 }
 #endif
 
@@ -639,6 +686,10 @@ int spi_flash_loadimage(struct image_info *image)
 {
 	struct dataflash_descriptor	df_descriptor;
 	struct dataflash_descriptor	*df_desc = &df_descriptor;
+	struct load_manifest		manifest;
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	struct kernel_payload		payload;
+#endif
 	int ret = 0;
 
 	memset(df_desc, 0, sizeof(*df_desc));
@@ -668,45 +719,84 @@ int spi_flash_loadimage(struct image_info *image)
 	}
 #endif
 
+	profile_mark("media probe");
+
+	manifest_init(&manifest, "SF");
+
 #if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
-	int length = update_image_length(df_desc,
-				image->offset, image->dest, KERNEL_IMAGE);
+	int length = update_image_length(df_desc, image->offset, image->dest);
 	if (length == -1)
 		return -1;
 
 	image->length = length;
 #endif
 
-	dbg_info("SF: Copy %d bytes from %d to %d\n",
-			image->length, image->offset, image->dest);
+#ifdef CONFIG_FIT
+	if (fit_check_header(image->dest) == 0) {
+		struct df_image fit;
 
-	ret = read_array(df_desc, image->offset, image->length, image->dest);
-	if (ret) {
-		dbg_info("** SF: Serial flash read error**\n");
-		ret = -1;
+		fit.df_desc = df_desc;
+		fit.offset = image->offset;
+
+		ret = fit_load(image, df_read_fit, &fit);
 		goto err_exit;
 	}
+#endif
 
-#ifdef CONFIG_OF_LIBFDT
-	length = update_image_length(df_desc,
-			image->of_offset, image->of_dest, DT_BLOB);
-	if (length == -1)
-		return -1;
+#ifdef CONFIG_KERNEL_STREAM
+	if (kernel_is_compressed(image->dest)) {
+		struct df_image stream;
+
+		stream.df_desc = df_desc;
+		stream.offset = image->offset;
+
+		dbg_info("SF: Stream %d bytes from %d\n",
+				image->length, image->offset);
+
+		ret = load_kernel_stream(image, image->length,
+					df_read_stream, NULL, &stream);
+	} else
+#endif
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (kernel_get_payload(image, df_desc->page_size, &payload) == 0) {
+		manifest_add(&manifest, KERNEL_IMAGE,
+				image->offset + payload.offset, payload.dest,
+				&payload.size, NULL);
+	} else
+#endif
+#ifdef CONFIG_SECURE_STREAM
+	{
+		struct df_image stream;
 
-	image->of_length = length;
+		stream.df_desc = df_desc;
+		stream.offset = image->offset;
 
-	dbg_info("SF: dt blob: Copy %d bytes from %d to %d\n",
-		image->of_length, image->of_offset, image->of_dest);
+		dbg_info("SF: Stream from %d to %d\n",
+				image->offset, image->dest);
 
-	ret = read_array(df_desc,
-		image->of_offset, image->of_length, image->of_dest);
+		ret = secure_load_stream(image, df_read_stream, &stream);
+	}
+#else
+	{
+		manifest_add(&manifest, KERNEL_IMAGE, image->offset,
+				image->dest, &image->length, NULL);
+	}
+#endif
 	if (ret) {
-		dbg_info("** SF: DT: Serial flash read error**\n");
+		dbg_info("** SF: Serial flash read error**\n");
+		ret = -1;
+		goto err_exit;
+	}
+
+#if defined(CONFIG_LOAD_LINUX) || defined(CONFIG_LOAD_ANDROID)
+	if (image_manifest_add(image, &manifest)) {
 		ret = -1;
 		goto err_exit;
 	}
 #endif
 
+	ret = manifest_load(&manifest, df_read, df_desc, df_desc->page_size);
+
 err_exit:
 	at91_spi_disable();
 	return ret;
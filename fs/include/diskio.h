@@ -30,7 +30,7 @@ typedef enum {
 int assign_drives (int, int);
 DSTATUS disk_initialize (BYTE);
 DSTATUS disk_status (BYTE);
-DRESULT disk_read (BYTE, BYTE*, DWORD, BYTE);
+DRESULT disk_read (BYTE, BYTE*, DWORD, UINT);
 #if	_READONLY == 0
 DRESULT disk_write (BYTE, const BYTE*, DWORD, BYTE);
 #endif
@@ -38,6 +38,7 @@ DRESULT disk_write (BYTE, const BYTE*, DWORD, BYTE);
 #if	_USE_IOCTL == 1
 DRESULT disk_ioctl (BYTE, BYTE, void*);
 #endif
+void disk_cache_show_stats (void);
 
 
 /* Disk Status Bits (DSTATUS) */
@@ -26,7 +26,11 @@
 /  f_truncate and useless f_getfree. */
 
 
+#ifdef CONFIG_FIT
+#define _FS_MINIMIZE	2	/* f_lseek() for the FIT images */
+#else
 #define _FS_MINIMIZE	3	/* 0 to 3 */
+#endif
 /* The _FS_MINIMIZE option defines minimization level to remove some functions.
 /
 /   0: Full function.
@@ -52,6 +56,10 @@
 /* To enable fast seek feature, set _USE_FASTSEEK to 1. */
 
 
+#define	_USE_EXTENT_READ	1	/* 0:Disable or 1:Enable */
+/* To enable f_read_extents function, set _USE_EXTENT_READ to 1. */
+
+
 
 /*---------------------------------------------------------------------------/
 / Locale and Namespace Configurations
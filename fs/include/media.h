@@ -32,5 +32,10 @@ extern int sdcard_initialize(void);
 extern unsigned int sdcard_block_read(unsigned int start,
 					unsigned int blkcnt,
 					void *dest);
+extern void sdcard_block_read_start(unsigned int start,
+					unsigned int blkcnt,
+					void *dest);
+extern unsigned int sdcard_block_read_wait(void);
+extern int sdcard_switch_partition(unsigned int part);
 
 #endif
@@ -8,12 +8,92 @@
 #include "ffconf.h"
 #include "integer.h"
 #include "media.h"
+#include "string.h"
+#include "debug.h"
 
 //------------------------------------------------------------------------------
 //         Internal variables
 
 static volatile DSTATUS Stat = STA_NOINIT;	/* Disk status */
 
+//------------------------------------------------------------------------------
+/* Sector cache                                                          */
+/*-----------------------------------------------------------------------*/
+/* Single sector reads, mostly FAT and directory sectors brought in by   */
+/* move_window(), are kept in a small LRU cache. Multi-sector reads are  */
+/* file data and go straight to the media.                               */
+
+#ifndef CONFIG_FATFS_CACHE_SECTORS
+#define CONFIG_FATFS_CACHE_SECTORS	0
+#endif
+
+#if CONFIG_FATFS_CACHE_SECTORS > 0
+typedef struct {
+	DWORD	sector;
+	DWORD	stamp;		/* 0: entry unused */
+	BYTE	data[_MAX_SS];
+} CACHE_ENTRY;
+
+static CACHE_ENTRY Cache[CONFIG_FATFS_CACHE_SECTORS];
+static DWORD CacheStamp;
+
+#ifdef CONFIG_DEBUG
+static unsigned int CacheHits, CacheMisses;
+#endif
+
+static void cache_invalidate(void)
+{
+	memset(Cache, 0, sizeof(Cache));
+	CacheStamp = 0;
+}
+
+static DRESULT cache_read(BYTE *buff, DWORD sector)
+{
+	CACHE_ENTRY *entry, *victim = Cache;
+	unsigned int i;
+
+	for (i = 0; i < CONFIG_FATFS_CACHE_SECTORS; i++) {
+		entry = &Cache[i];
+		if (entry->stamp && (entry->sector == sector)) {
+			entry->stamp = ++CacheStamp;
+			memcpy(buff, entry->data, _MAX_SS);
+#ifdef CONFIG_DEBUG
+			CacheHits++;
+#endif
+			return RES_OK;
+		}
+
+		if (entry->stamp < victim->stamp)
+			victim = entry;
+	}
+
+#ifdef CONFIG_DEBUG
+	CacheMisses++;
+#endif
+
+	if (sdcard_block_read((unsigned int)sector, 1, (void *)buff) != 1)
+		return RES_ERROR;
+
+	victim->sector = sector;
+	victim->stamp = ++CacheStamp;
+	memcpy(victim->data, buff, _MAX_SS);
+
+	return RES_OK;
+}
+#else
+static void cache_invalidate(void)
+{
+}
+#endif
+
+void disk_cache_show_stats(void)
+{
+#if (CONFIG_FATFS_CACHE_SECTORS > 0) && defined(CONFIG_DEBUG)
+	dbg_loud("FATFS: sector cache: %d hits, %d misses\n",
+					CacheHits, CacheMisses);
+#endif
+}
+
 //------------------------------------------------------------------------------
 /* Initialize a Drive                                                    */
 /*-----------------------------------------------------------------------*/
@@ -23,6 +103,8 @@ DSTATUS disk_initialize(BYTE drv        /* Physical drive number (0..) */
 {
 	if (drv) return STA_NOINIT;	
 	
+	cache_invalidate();
+
 	if (sdcard_initialize() == 0)
 		Stat &= ~STA_NOINIT;
 
@@ -48,18 +130,23 @@ DSTATUS disk_status(BYTE drv    /* Physical drive number (0..) */
 DRESULT disk_read(BYTE drv,     /* Physical drive number (0..) */
                   BYTE *buff,  /* Data buffer to store read data */
                   DWORD sector, /* Start sector number (LBA) */
-                  BYTE count    /* Sector count (1..255) */
+                  UINT count    /* Sector count */
     )
 {
 	if (drv || !count) return RES_PARERR;
 	if (Stat & STA_NOINIT) return RES_NOTRDY;
 
+#if CONFIG_FATFS_CACHE_SECTORS > 0
+	if (count == 1)
+		return cache_read(buff, sector);
+#endif
+
 	if (sdcard_block_read((unsigned int)sector,
 				(unsigned int)count,
-				(void *)buff) == count)
-		return RES_OK;
-	else
+				(void *)buff) != count)
 		return RES_ERROR;
+
+	return RES_OK;
 }
 
 /*-----------------------------------------------------------------------*/
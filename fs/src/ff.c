@@ -2418,7 +2418,7 @@ FRESULT f_read (
 			if (cc) {					/* Read maximum contiguous sectors directly */
 				if (csect + cc > fp->fs->csize)		/* Clip at cluster boundary */
 					cc = fp->fs->csize - csect;
-				if (disk_read(fp->fs->drv, rbuff, sect, (BYTE)cc) != RES_OK)
+				if (disk_read(fp->fs->drv, rbuff, sect, cc) != RES_OK)
 					ABORT(fp->fs, FR_DISK_ERR);
 #if !_FS_READONLY && _FS_MINIMIZE <= 2			/* Replace one of the read sectors with cached data if it contains a dirty sector */
 #if _FS_TINY
@@ -2464,6 +2464,81 @@ FRESULT f_read (
 
 
 
+#if _USE_EXTENT_READ
+/*-----------------------------------------------------------------------*/
+/* Read Rest of File by Contiguous Extents                               */
+/*-----------------------------------------------------------------------*/
+/* The cluster chain is followed once, and each run of consecutive       */
+/* clusters is read with a single disk_read() straight into the buffer.  */
+/* The read starts at the file pointer, which must be on a sector        */
+/* boundary. The last sector is read whole, so the buffer must have room */
+/* for the rest of the file rounded up to the sector size.               */
+
+FRESULT f_read_extents (
+	FIL *fp, 		/* Pointer to the file object, on a sector boundary */
+	void *buff,		/* Pointer to data buffer */
+	UINT *br		/* Pointer to number of bytes read */
+)
+{
+	FRESULT res;
+	DWORD clst, scl, ncl, nxt, sect, remain, csbytes, skip;
+	UINT rcnt;
+	BYTE *rbuff = buff;
+
+
+	*br = 0;	/* Initialize byte counter */
+
+	res = validate(fp->fs, fp->id);			/* Check validity */
+	if (res != FR_OK) LEAVE_FF(fp->fs, res);
+	if (fp->flag & FA__ERROR)			/* Aborted file? */
+		LEAVE_FF(fp->fs, FR_INT_ERR);
+	if (!(fp->flag & FA_READ)) 			/* Check access mode */
+		LEAVE_FF(fp->fs, FR_DENIED);
+	remain = fp->fsize - fp->fptr;
+	if (!remain)					/* Nothing left to read */
+		LEAVE_FF(fp->fs, FR_OK);
+	if (fp->fptr % SS(fp->fs))			/* Only from a sector boundary */
+		LEAVE_FF(fp->fs, FR_INVALID_PARAMETER);
+
+	csbytes = (DWORD)fp->fs->csize * SS(fp->fs);	/* Bytes per cluster */
+	skip = fp->fptr % csbytes;			/* Bytes already read in the first cluster */
+	if (fp->fptr == 0)				/* On the top of the file? */
+		clst = fp->sclust;
+	else if (skip)					/* In the current cluster */
+		clst = fp->clust;
+	else {						/* The current cluster is read through */
+		clst = get_fat(fp->fs, fp->clust);
+		if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
+	}
+
+	while (remain) {
+		if (clst < 2 || clst >= fp->fs->n_fatent) ABORT(fp->fs, FR_INT_ERR);
+		scl = clst; ncl = 1; nxt = 0;
+		while (ncl * csbytes - skip < remain) {	/* Stretch the extent while the chain is contiguous */
+			nxt = get_fat(fp->fs, clst);
+			if (nxt == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
+			if (nxt != clst + 1) break;
+			clst = nxt; ncl++;
+		}
+		sect = clust2sect(fp->fs, scl);			/* Extent start sector */
+		if (!sect) ABORT(fp->fs, FR_INT_ERR);
+		sect += skip / SS(fp->fs);
+		rcnt = (ncl * csbytes - skip < remain) ? ncl * csbytes - skip : remain;
+		if (disk_read(fp->fs->drv, rbuff, sect, (rcnt + SS(fp->fs) - 1) / SS(fp->fs)) != RES_OK)
+			ABORT(fp->fs, FR_DISK_ERR);
+		fp->clust = clst;				/* Last cluster of the extent */
+		rbuff += rcnt; fp->fptr += rcnt; *br += rcnt; remain -= rcnt;
+		clst = nxt;					/* First cluster of the next extent */
+		skip = 0;
+	}
+
+	LEAVE_FF(fp->fs, FR_OK);
+}
+#endif /* _USE_EXTENT_READ */
+
+
+
+
 #if !_FS_READONLY
 /*-----------------------------------------------------------------------*/
 /* Write File                                                            */
@@ -34,6 +34,9 @@
 #define AT91_AES_IV_SIZE_BYTE		16
 #define AT91_AES_IV_SIZE_WORD		4
 
+#define AT91_AES_GCM_IV_SIZE_BYTE	12
+#define AT91_AES_GCM_IV_SIZE_WORD	3
+
 typedef enum at91_aes_operation {
 	AT91_AES_OP_DECRYPT,
 	AT91_AES_OP_ENCRYPT,
@@ -106,4 +109,55 @@ int at91_aes_cmac(unsigned int data_length,
 		  at91_aes_key_size_t key_size,
 		  const unsigned int *key);
 
+/*
+ * As at91_aes_cbc(), but a decryption by the DMA may still be running
+ * when it returns: at91_aes_wait() waits for it, as the next operation
+ * does.
+ */
+int at91_aes_cbc_start(unsigned int data_length,
+		       const void *input,
+		       void *output,
+		       int encrypt,
+		       at91_aes_key_size_t key_size,
+		       const unsigned int *key,
+		       const unsigned int *iv);
+
+int at91_aes_wait(void);
+
+/*
+ * A CMAC in pieces: "mac" starts with zeroes, at91_aes_cbc_mac() chains
+ * it through the whole blocks but the last one, which is given to
+ * at91_aes_cmac_finish().
+ */
+int at91_aes_cbc_mac(unsigned int data_length,
+		     const void *data,
+		     unsigned int *mac,
+		     at91_aes_key_size_t key_size,
+		     const unsigned int *key);
+
+int at91_aes_cmac_finish(const void *last_block,
+			 unsigned int *mac,
+			 at91_aes_key_size_t key_size,
+			 const unsigned int *key);
+
+/*
+ * AES-GCM with a 96-bit IV, in one pass: at91_aes_gcm_start() takes the
+ * additional authenticated data and the length of the whole text, which
+ * is then given to at91_aes_gcm_update() in whole blocks but the last
+ * piece. at91_aes_gcm_finish() returns the tag.
+ */
+int at91_aes_gcm_start(int encrypt,
+		       at91_aes_key_size_t key_size,
+		       const unsigned int *key,
+		       const unsigned int *iv,
+		       unsigned int aad_length,
+		       const void *aad,
+		       unsigned int data_length);
+
+int at91_aes_gcm_update(unsigned int data_length,
+			const void *input,
+			void *output);
+
+int at91_aes_gcm_finish(unsigned int *tag);
+
 #endif /* __AES_H__ */
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2006, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __AT91_DMAC_H__
+#define __AT91_DMAC_H__
+
+/* Global registers */
+#define DMAC_GCFG	0x00	/* Global Configuration Register */
+#define DMAC_EN		0x04	/* Enable Register */
+#define DMAC_SREQ	0x08	/* Software Single Request Register */
+#define DMAC_CREQ	0x0C	/* Software Chunk Transfer Request Register */
+#define DMAC_LAST	0x10	/* Software Last Transfer Flag Register */
+#define DMAC_EBCIER	0x18	/* Error, Buffer Transfer and Chained Buffer Transfer Interrupt Enable Register */
+#define DMAC_EBCIDR	0x1C	/* Error, Buffer Transfer and Chained Buffer Transfer Interrupt Disable Register */
+#define DMAC_EBCIMR	0x20	/* Error, Buffer Transfer and Chained Buffer Transfer Interrupt Mask Register */
+#define DMAC_EBCISR	0x24	/* Error, Buffer Transfer and Chained Buffer Transfer Status Register */
+#define DMAC_CHER	0x28	/* Channel Handler Enable Register */
+#define DMAC_CHDR	0x2C	/* Channel Handler Disable Register */
+#define DMAC_CHSR	0x30	/* Channel Handler Status Register */
+
+/* Channel registers */
+#define DMAC_CH_OFFSET(ch)	(0x3C + (ch) * 0x28)
+#define DMAC_SADDR(ch)	(DMAC_CH_OFFSET(ch) + 0x00)	/* Source Address Register */
+#define DMAC_DADDR(ch)	(DMAC_CH_OFFSET(ch) + 0x04)	/* Destination Address Register */
+#define DMAC_DSCR(ch)	(DMAC_CH_OFFSET(ch) + 0x08)	/* Descriptor Address Register */
+#define DMAC_CTRLA(ch)	(DMAC_CH_OFFSET(ch) + 0x0C)	/* Control A Register */
+#define DMAC_CTRLB(ch)	(DMAC_CH_OFFSET(ch) + 0x10)	/* Control B Register */
+#define DMAC_CFG(ch)	(DMAC_CH_OFFSET(ch) + 0x14)	/* Configuration Register */
+
+/*-------- DMAC_EN : (DMAC Offset: 0x04) Enable Register --------*/
+#define AT91C_DMAC_ENABLE	(0x1UL << 0)
+
+/*-------- DMAC_EBCISR : (DMAC Offset: 0x24) Status Register --------*/
+#define AT91C_DMAC_BTC(ch)	(0x1UL << (ch))		/* Buffer Transfer Completed */
+#define AT91C_DMAC_CBTC(ch)	(0x1UL << (8 + (ch)))	/* Chained Buffer Transfer Completed */
+#define AT91C_DMAC_ERR(ch)	(0x1UL << (16 + (ch)))	/* Access Error */
+
+/*-------- DMAC_CHER/CHDR/CHSR : Channel Handler Registers --------*/
+#define AT91C_DMAC_ENA(ch)	(0x1UL << (ch))
+
+/*-------- DMAC_CTRLAx : Channel Control A Register --------*/
+#define AT91C_DMAC_BTSIZE(x)	((x) & 0xffff)	/* Buffer Transfer Size */
+#define AT91C_DMAC_BTSIZE_MAX	0xffff
+#define AT91C_DMAC_SCSIZE_1	(0x0UL << 16)	/* Source Chunk Transfer Size */
+#define AT91C_DMAC_SCSIZE_16	(0x3UL << 16)
+#define AT91C_DMAC_DCSIZE_1	(0x0UL << 20)	/* Destination Chunk Transfer Size */
+#define AT91C_DMAC_DCSIZE_16	(0x3UL << 20)
+#define AT91C_DMAC_SRC_WIDTH_WORD	(0x2UL << 24)
+#define AT91C_DMAC_DST_WIDTH_WORD	(0x2UL << 28)
+#define AT91C_DMAC_DONE		(0x1UL << 31)
+
+/*-------- DMAC_CTRLBx : Channel Control B Register --------*/
+#define AT91C_DMAC_SRC_DSCR_FETCH_DISABLE	(0x1UL << 16)
+#define AT91C_DMAC_DST_DSCR_FETCH_DISABLE	(0x1UL << 20)
+#define AT91C_DMAC_FC_MEM2PER	(0x1UL << 21)	/* Memory-to-Peripheral, DMAC flow controller */
+#define AT91C_DMAC_FC_PER2MEM	(0x2UL << 21)	/* Peripheral-to-Memory, DMAC flow controller */
+#define AT91C_DMAC_SRC_INCR_INCREMENTING	(0x0UL << 24)
+#define AT91C_DMAC_SRC_INCR_FIXED	(0x2UL << 24)
+#define AT91C_DMAC_DST_INCR_INCREMENTING	(0x0UL << 28)
+#define AT91C_DMAC_DST_INCR_FIXED	(0x2UL << 28)
+
+/*-------- DMAC_CFGx : Channel Configuration Register --------*/
+#define AT91C_DMAC_SRC_PER(x)	((x) & 0xf)	/* Source Hardware Interface */
+#define AT91C_DMAC_DST_PER(x)	(((x) & 0xf) << 4)	/* Destination Hardware Interface */
+#define AT91C_DMAC_SRC_H2SEL_HW	(0x1UL << 9)	/* Hardware Handshaking on Source */
+#define AT91C_DMAC_DST_H2SEL_HW	(0x1UL << 13)	/* Hardware Handshaking on Destination */
+#define AT91C_DMAC_DST_PER_MSB(x)	((((x) >> 4) & 0x3) << 14)
+#define AT91C_DMAC_SOD		(0x1UL << 16)	/* Stop On Done */
+#define AT91C_DMAC_FIFOCFG_ALAP	(0x1UL << 28)	/* As Large As Possible */
+
+#endif /* #ifndef __AT91_DMAC_H__ */
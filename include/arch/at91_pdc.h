@@ -0,0 +1,55 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2006, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __AT91_PDC_H__
+#define __AT91_PDC_H__
+
+/*
+ * Peripheral DMA Controller registers, at offset 0x100 from the base
+ * of the peripheral they are attached to.
+ */
+#define PDC_RPR		0x100	/* Receive Pointer Register */
+#define PDC_RCR		0x104	/* Receive Counter Register */
+#define PDC_TPR		0x108	/* Transmit Pointer Register */
+#define PDC_TCR		0x10C	/* Transmit Counter Register */
+#define PDC_RNPR	0x110	/* Receive Next Pointer Register */
+#define PDC_RNCR	0x114	/* Receive Next Counter Register */
+#define PDC_TNPR	0x118	/* Transmit Next Pointer Register */
+#define PDC_TNCR	0x11C	/* Transmit Next Counter Register */
+#define PDC_PTCR	0x120	/* Transfer Control Register */
+#define PDC_PTSR	0x124	/* Transfer Status Register */
+
+/*-------- PDC_PTCR : (PDC Offset: 0x120) Transfer Control Register --------*/
+#define AT91C_PDC_RXTEN		(0x1UL << 0)	/* Receiver Transfer Enable */
+#define AT91C_PDC_RXTDIS	(0x1UL << 1)	/* Receiver Transfer Disable */
+#define AT91C_PDC_TXTEN		(0x1UL << 8)	/* Transmitter Transfer Enable */
+#define AT91C_PDC_TXTDIS	(0x1UL << 9)	/* Transmitter Transfer Disable */
+
+/* The counter registers are 16-bit wide */
+#define AT91C_PDC_MAX_COUNT	0xffff
+
+#endif /* #ifndef __AT91_PDC_H__ */
@@ -0,0 +1,62 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __AT91_SHA_H__
+#define __AT91_SHA_H__
+
+/**** Register offset in AT91_SHA structure ***/
+#define SHA_CR		0x00	/* Control Register */
+#define SHA_MR		0x04	/* Mode Register */
+#define SHA_IER		0x10	/* Interrupt Enable Register */
+#define SHA_IDR		0x14	/* Interrupt Disable Register */
+#define SHA_IMR		0x18	/* Interrupt Mask Register */
+#define SHA_ISR		0x1C	/* Interrupt Status Register */
+#define SHA_IDATAR(x)	(0x40 + (x) * 4)	/* Input Data Register x */
+#define SHA_IODATAR(x)	(0x80 + (x) * 4)	/* Input/Output Data Register x */
+
+/*-------- SHA_CR : (Offset: 0x00) Control Register --------*/
+#define	SHA_CR_START		(0x1UL << 0)	/* Start Processing */
+#define	SHA_CR_FIRST		(0x1UL << 4)	/* First Block of a Message */
+#define	SHA_CR_SWRST		(0x1UL << 8)	/* Software Reset */
+
+/*-------- SHA_MR : (Offset: 0x04) Mode Register --------*/
+#define	SHA_MR_SMOD_MANUAL_START	(0x0UL << 0)	/* Start Mode */
+#define	SHA_MR_SMOD_AUTO_START		(0x1UL << 0)
+#define	SHA_MR_SMOD_IDATAR0_START	(0x2UL << 0)	/* for the DMA */
+#define	SHA_MR_PROCDLY_LONGEST		(0x1UL << 4)	/* Processing Delay */
+#define	SHA_MR_ALGO_SHA1		(0x0UL << 8)	/* SHA Algorithm */
+#define	SHA_MR_ALGO_SHA256		(0x1UL << 8)
+#define	SHA_MR_ALGO_SHA384		(0x2UL << 8)
+#define	SHA_MR_ALGO_SHA512		(0x3UL << 8)
+#define	SHA_MR_ALGO_SHA224		(0x4UL << 8)
+#define	SHA_MR_DUALBUFF			(0x1UL << 16)	/* Dual Input Buffer */
+
+/*-------- SHA_ISR : (Offset: 0x1C) Interrupt Status Register --------*/
+#define	SHA_INT_DATRDY		(0x1UL << 0)	/* Data Ready */
+#define	SHA_INT_URAD		(0x1UL << 8)	/* Unspecified Register Access */
+
+#endif /* #ifndef __AT91_SHA_H__ */
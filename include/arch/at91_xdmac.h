@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __AT91_XDMAC_H__
+#define __AT91_XDMAC_H__
+
+/* Global registers */
+#define XDMAC_GTYPE	0x00	/* Global Type Register */
+#define XDMAC_GCFG	0x04	/* Global Configuration Register */
+#define XDMAC_GWAC	0x08	/* Global Weighted Arbiter Configuration Register */
+#define XDMAC_GIE	0x0C	/* Global Interrupt Enable Register */
+#define XDMAC_GID	0x10	/* Global Interrupt Disable Register */
+#define XDMAC_GIM	0x14	/* Global Interrupt Mask Register */
+#define XDMAC_GIS	0x18	/* Global Interrupt Status Register */
+#define XDMAC_GE	0x1C	/* Global Channel Enable Register */
+#define XDMAC_GD	0x20	/* Global Channel Disable Register */
+#define XDMAC_GS	0x24	/* Global Channel Status Register */
+#define XDMAC_GSWR	0x38	/* Global Channel Software Request Register */
+#define XDMAC_GSWF	0x40	/* Global Channel Software Flush Request Register */
+
+/* Channel registers */
+#define XDMAC_CH_OFFSET(ch)	(0x50 + (ch) * 0x40)
+#define XDMAC_CIE(ch)	(XDMAC_CH_OFFSET(ch) + 0x00)	/* Channel Interrupt Enable Register */
+#define XDMAC_CID(ch)	(XDMAC_CH_OFFSET(ch) + 0x04)	/* Channel Interrupt Disable Register */
+#define XDMAC_CIM(ch)	(XDMAC_CH_OFFSET(ch) + 0x08)	/* Channel Interrupt Mask Register */
+#define XDMAC_CIS(ch)	(XDMAC_CH_OFFSET(ch) + 0x0C)	/* Channel Interrupt Status Register */
+#define XDMAC_CSA(ch)	(XDMAC_CH_OFFSET(ch) + 0x10)	/* Channel Source Address Register */
+#define XDMAC_CDA(ch)	(XDMAC_CH_OFFSET(ch) + 0x14)	/* Channel Destination Address Register */
+#define XDMAC_CNDA(ch)	(XDMAC_CH_OFFSET(ch) + 0x18)	/* Channel Next Descriptor Address Register */
+#define XDMAC_CNDC(ch)	(XDMAC_CH_OFFSET(ch) + 0x1C)	/* Channel Next Descriptor Control Register */
+#define XDMAC_CUBC(ch)	(XDMAC_CH_OFFSET(ch) + 0x20)	/* Channel Microblock Control Register */
+#define XDMAC_CBC(ch)	(XDMAC_CH_OFFSET(ch) + 0x24)	/* Channel Block Control Register */
+#define XDMAC_CC(ch)	(XDMAC_CH_OFFSET(ch) + 0x28)	/* Channel Configuration Register */
+#define XDMAC_CDS_MSP(ch)	(XDMAC_CH_OFFSET(ch) + 0x2C)	/* Channel Data Stride Memory Set Pattern */
+#define XDMAC_CSUS(ch)	(XDMAC_CH_OFFSET(ch) + 0x30)	/* Channel Source Microblock Stride */
+#define XDMAC_CDUS(ch)	(XDMAC_CH_OFFSET(ch) + 0x34)	/* Channel Destination Microblock Stride */
+
+/*-------- XDMAC_GE/GD/GS : Global Channel Registers --------*/
+#define AT91C_XDMAC_CH(ch)	(0x1UL << (ch))
+
+/*-------- XDMAC_CIS : Channel Interrupt Status Register --------*/
+#define AT91C_XDMAC_CIS_BIS	(0x1UL << 0)	/* End of Block */
+#define AT91C_XDMAC_CIS_LIS	(0x1UL << 1)	/* End of Linked List */
+#define AT91C_XDMAC_CIS_DIS	(0x1UL << 2)	/* End of Disable */
+#define AT91C_XDMAC_CIS_FIS	(0x1UL << 3)	/* End of Flush */
+#define AT91C_XDMAC_CIS_RBEIS	(0x1UL << 4)	/* Read Bus Error */
+#define AT91C_XDMAC_CIS_WBEIS	(0x1UL << 5)	/* Write Bus Error */
+#define AT91C_XDMAC_CIS_ROIS	(0x1UL << 6)	/* Request Overflow Error */
+#define AT91C_XDMAC_CIS_ERRORS	(AT91C_XDMAC_CIS_RBEIS \
+				| AT91C_XDMAC_CIS_WBEIS \
+				| AT91C_XDMAC_CIS_ROIS)
+
+/*-------- XDMAC_CNDC : Channel Next Descriptor Control Register --------*/
+#define AT91C_XDMAC_CNDC_NDE		(0x1UL << 0)	/* Next Descriptor Enable */
+#define AT91C_XDMAC_CNDC_NDSUP		(0x1UL << 1)	/* Source Parameters Updated */
+#define AT91C_XDMAC_CNDC_NDDUP		(0x1UL << 2)	/* Destination Parameters Updated */
+#define AT91C_XDMAC_CNDC_NDVIEW_1	(0x1UL << 3)	/* Descriptor View 1 */
+
+/*-------- XDMAC_CUBC : Channel Microblock Control Register --------*/
+#define AT91C_XDMAC_UBLEN(x)	((x) & 0xffffff)	/* Microblock Length, in data */
+#define AT91C_XDMAC_UBLEN_MAX	0xffffff
+
+/*-------- Linked list descriptor, view 1: MBR_UBC --------*/
+#define AT91C_XDMAC_UBC_NDE		(0x1UL << 24)	/* Next Descriptor Enable */
+#define AT91C_XDMAC_UBC_NSEN		(0x1UL << 25)	/* Next Descriptor Source Update */
+#define AT91C_XDMAC_UBC_NDEN		(0x1UL << 26)	/* Next Descriptor Destination Update */
+#define AT91C_XDMAC_UBC_NVIEW_1		(0x1UL << 27)	/* Next Descriptor View 1 */
+
+/*-------- XDMAC_CC : Channel Configuration Register --------*/
+#define AT91C_XDMAC_CC_TYPE_PER_TRAN	(0x1UL << 0)	/* Peripheral Synchronized Transfer */
+#define AT91C_XDMAC_CC_MBSIZE_SINGLE	(0x0UL << 1)	/* Memory Burst Size */
+#define AT91C_XDMAC_CC_MBSIZE_FOUR	(0x1UL << 1)
+#define AT91C_XDMAC_CC_MBSIZE_EIGHT	(0x2UL << 1)
+#define AT91C_XDMAC_CC_MBSIZE_SIXTEEN	(0x3UL << 1)
+#define AT91C_XDMAC_CC_DSYNC_PER2MEM	(0x0UL << 4)	/* Synchronization */
+#define AT91C_XDMAC_CC_DSYNC_MEM2PER	(0x1UL << 4)
+#define AT91C_XDMAC_CC_CSIZE_1		(0x0UL << 8)	/* Chunk Size */
+#define AT91C_XDMAC_CC_CSIZE_4		(0x2UL << 8)
+#define AT91C_XDMAC_CC_CSIZE_16		(0x4UL << 8)
+#define AT91C_XDMAC_CC_DWIDTH_WORD	(0x2UL << 11)	/* Data Width */
+#define AT91C_XDMAC_CC_SIF_AHB_IF0	(0x0UL << 13)	/* Source Interface */
+#define AT91C_XDMAC_CC_SIF_AHB_IF1	(0x1UL << 13)
+#define AT91C_XDMAC_CC_DIF_AHB_IF0	(0x0UL << 14)	/* Destination Interface */
+#define AT91C_XDMAC_CC_DIF_AHB_IF1	(0x1UL << 14)
+#define AT91C_XDMAC_CC_SAM_FIXED	(0x0UL << 16)	/* Source Addressing Mode */
+#define AT91C_XDMAC_CC_SAM_INCR		(0x1UL << 16)
+#define AT91C_XDMAC_CC_DAM_FIXED	(0x0UL << 18)	/* Destination Addressing Mode */
+#define AT91C_XDMAC_CC_DAM_INCR		(0x1UL << 18)
+#define AT91C_XDMAC_CC_PERID(x)		(((x) & 0x7f) << 24)	/* Hardware Request Line */
+
+#endif /* #ifndef __AT91_XDMAC_H__ */
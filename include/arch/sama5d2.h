@@ -177,6 +177,12 @@
 #define	AT91C_BASE_BSCR		0xf8048054
 #define	AT91C_BASE_GPBR		0xf8045400
 
+/*
+ * XDMAC0 hardware interfaces
+ */
+#define	AT91C_XDMAC0_PER_AES_TX	26
+#define	AT91C_XDMAC0_PER_AES_RX	27
+
 /*
  * Address Memory Space
  */
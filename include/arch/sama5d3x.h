@@ -148,6 +148,12 @@
 /* Reserved 0xffff fe70 */
 #define AT91C_BASE_RTCC		0xfffffeb0
 /* Reserved 0xffff fee0 */
+
+/*
+ * DMAC hardware interfaces
+ */
+#define AT91C_DMAC1_PER_SHA_TX	17
+
 /*
  * Internal Memory common on all these SoCs
  */
@@ -149,6 +149,7 @@
 #define AT91C_BASE_PKCC		0xf000c000
 #define AT91C_BASE_MPDDRC	0xf0010000
 #define AT91C_BASE_DMAC0	0xf0014000
+#define AT91C_BASE_XDMAC0	AT91C_BASE_DMAC0
 #define AT91C_BASE_PMC		0xf0018000
 #define AT91C_BASE_MATRIX64	0xf001c000
 #define AT91C_BASE_AESB		0xf0020000
@@ -185,6 +186,13 @@
  */
 #define AT91C_BASE_SYS		0xffffc000
 /* Reserved */
+
+/*
+ * XDMAC0 hardware interfaces
+ */
+#define AT91C_XDMAC0_PER_AES_TX	41
+#define AT91C_XDMAC0_PER_AES_RX	40
+
 /*
  * Internal Memory common on all these SoCs
  */
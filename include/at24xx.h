@@ -29,5 +29,6 @@
 #define __AT24XX_H__
 
 extern int load_ek_at24xx(unsigned char *buff, unsigned int length);
+extern int load_at24mac_address(unsigned char *mac);
 
 #endif
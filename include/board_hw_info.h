@@ -67,6 +67,9 @@ extern unsigned int get_sys_sn(void);
 extern unsigned int get_sys_rev(void);
 extern char get_ek_rev(void);
 extern unsigned int get_ek_sn(void);
+extern char *get_cm_name(void);
+extern char *get_dm_name(void);
+extern char *get_ek_name(void);
 
 extern void load_board_hw_info(void);
 
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __BOOT_TRACE_H__
+#define __BOOT_TRACE_H__
+
+/*
+ * The boot trace, as it is left in DDR for Linux. The words are little
+ * endian, the names are NUL terminated. The crc32 is the one of zlib,
+ * over the whole record with the crc32 word at 0.
+ */
+#define BOOT_TRACE_MAGIC	0x43525442	/* "BTRC" */
+#define BOOT_TRACE_VERSION	1
+
+#define BOOT_TRACE_SIZE		0x1000
+
+#define BOOT_TRACE_MAX_STAGES	16
+#define BOOT_TRACE_MAX_MEDIA	4
+
+#define BOOT_TRACE_NAME_SIZE	16
+
+#ifndef BOOT_TRACE_ADDR
+#if defined(CONFIG_OF_RESERVED_MEMORY) && !defined(OF_RESERVED_MEMORY_ADDR)
+/* below the region reserved at the top of the memory bank */
+#define BOOT_TRACE_ADDR	(MEM_BANK + MEM_SIZE \
+			- OF_RESERVED_MEMORY_SIZE - BOOT_TRACE_SIZE)
+#else
+#define BOOT_TRACE_ADDR	(MEM_BANK + MEM_SIZE - BOOT_TRACE_SIZE)
+#endif
+#endif
+
+/* the time from the first timestamp to the end of the stage */
+struct boot_trace_stage {
+	char		name[BOOT_TRACE_NAME_SIZE];
+	unsigned int	usec;
+};
+
+/* the retries count the bad blocks skipped */
+struct boot_trace_media {
+	char		name[BOOT_TRACE_NAME_SIZE];
+	unsigned int	bytes;
+	unsigned int	ecc_corrected;
+	unsigned int	retries;
+};
+
+struct boot_trace {
+	unsigned int	magic;
+	unsigned int	version;
+	unsigned int	length;		/* of the record, in bytes */
+	unsigned int	crc32;
+	unsigned int	num_stages;
+	unsigned int	num_media;
+	struct boot_trace_stage	stages[BOOT_TRACE_MAX_STAGES];
+	struct boot_trace_media	media[BOOT_TRACE_MAX_MEDIA];
+};
+
+#ifdef CONFIG_BOOT_TRACE
+/* the media names are kept as pointers, they must be string constants */
+extern void boot_trace_read(const char *media, unsigned int bytes);
+extern void boot_trace_ecc(const char *media, unsigned int corrected);
+extern void boot_trace_retry(const char *media);
+extern void boot_trace_save(void);
+#else
+static inline void boot_trace_read(const char *media, unsigned int bytes) { }
+static inline void boot_trace_ecc(const char *media,
+				unsigned int corrected) { }
+static inline void boot_trace_retry(const char *media) { }
+static inline void boot_trace_save(void) { }
+#endif
+
+#endif /* #ifndef __BOOT_TRACE_H__ */
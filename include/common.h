@@ -42,12 +42,14 @@
 enum {
 	KERNEL_IMAGE,
 	DT_BLOB,
+	INITRD_IMAGE,
 };
 
 /* structure definition */
 struct image_info
 {
-#if defined(CONFIG_DATAFLASH) || defined(CONFIG_NANDFLASH) || defined(CONFIG_FLASH)
+#if defined(CONFIG_DATAFLASH) || defined(CONFIG_NANDFLASH) || defined(CONFIG_FLASH) \
+	|| defined(CONFIG_SDCARD_RAW)
 	unsigned int offset;
 	unsigned int length;
 #endif
@@ -57,7 +59,8 @@ struct image_info
 	unsigned char *dest;
 
 #ifdef CONFIG_OF_LIBFDT
-#if defined(CONFIG_DATAFLASH) || defined(CONFIG_NANDFLASH) || defined(CONFIG_FLASH)
+#if defined(CONFIG_DATAFLASH) || defined(CONFIG_NANDFLASH) || defined(CONFIG_FLASH) \
+	|| defined(CONFIG_SDCARD_RAW)
 	unsigned int of_offset;
 	unsigned int of_length;
 #endif
@@ -66,6 +69,18 @@ struct image_info
 #endif
 	unsigned char *of_dest;
 #endif
+
+#ifdef CONFIG_LOAD_INITRD
+#if defined(CONFIG_DATAFLASH) || defined(CONFIG_NANDFLASH) || defined(CONFIG_FLASH) \
+	|| defined(CONFIG_SDCARD_RAW)
+	unsigned int initrd_offset;
+#endif
+#ifdef CONFIG_SDCARD
+	char *initrd_filename;
+#endif
+	unsigned char *initrd_dest;
+	unsigned int initrd_length;
+#endif
 };
 
 typedef int (*load_function)(struct image_info *image);
@@ -73,11 +88,56 @@ typedef int (*load_function)(struct image_info *image);
 extern load_function load_image;
 extern void init_load_image(struct image_info *image);
 extern void load_image_done(int retval);
+extern void hang(void);
 
 extern int load_kernel(struct image_info *image);
 
 extern int kernel_size(unsigned char *addr);
 
+#ifdef CONFIG_LOAD_INITRD
+extern int initrd_size(unsigned char *addr);
+extern int initrd_verify(unsigned char *addr, unsigned int length);
+#endif
+
+#ifdef CONFIG_LINUX_IMAGE
+/* The part of the kernel image the media reads to its load address */
+struct kernel_payload {
+	unsigned int	offset;		/* from the image start */
+	unsigned int	size;
+	unsigned char	*dest;
+};
+
+extern int kernel_get_payload(struct image_info *image, unsigned int loaded,
+				struct kernel_payload *payload);
+#endif
+
+#if defined(CONFIG_KERNEL_STREAM) || defined(CONFIG_SECURE_STREAM)
+/*
+ * Reads the next bytes of the image from the media, up to "len",
+ * returns the count of bytes read, 0 at the end of the data, or -1 on
+ * error.
+ */
+typedef int (*image_read_function)(void *priv,
+				unsigned char *buf, unsigned int len);
+#endif
+
+#ifdef CONFIG_KERNEL_STREAM
+/*
+ * The read of a media which moves its data by DMA, split in two: start()
+ * queues the read of up to "len" bytes to "buf" and returns 0, or -1 on
+ * error, wait() completes it and returns what image_read_function does.
+ */
+struct image_read_async {
+	int (*start)(void *priv, unsigned char *buf, unsigned int len);
+	int (*wait)(void *priv);
+};
+
+extern int kernel_is_compressed(unsigned char *addr);
+extern int load_kernel_stream(struct image_info *image, unsigned int length,
+				image_read_function read,
+				struct image_read_async *async, void *priv);
+#endif
+
 static inline unsigned int swap_uint32(unsigned int data)
 {
 	volatile unsigned int a, b, c, d;
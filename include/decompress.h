@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __DECOMPRESS_H__
+#define __DECOMPRESS_H__
+
+#include "string.h"
+
+/*
+ * Decompressors for kernel payloads. They decode a whole compressed
+ * stream into "dst", which can hold "dst_max" bytes, and return the
+ * decompressed length, or a negative value if the stream is corrupted
+ * or does not fit.
+ */
+#define ERROR_DECOMP_FORMAT	-1	/* unknown or bad header */
+#define ERROR_DECOMP_DATA	-2	/* corrupted stream */
+#define ERROR_DECOMP_OVERFLOW	-3	/* output does not fit */
+#define ERROR_DECOMP_READ	-4	/* the media read failed */
+
+#define GZIP_MAGIC		0x8b1f
+#define LZ4_FRAME_MAGIC		0x184d2204
+#define LZ4_LEGACY_MAGIC	0x184c2102
+
+/*
+ * The compressed input is consumed chunk by chunk. When "buf" is used
+ * up, fill() is called to read the next chunk from the media, it
+ * returns the new "len", 0 at the end of the data, or a negative
+ * value on read error. A buffer already in memory has no fill().
+ */
+struct decomp_stream {
+	const unsigned char	*buf;
+	unsigned int		pos;
+	unsigned int		len;
+
+	int (*fill)(struct decomp_stream *stream);
+	void			*priv;
+};
+
+static inline int stream_refill(struct decomp_stream *stream)
+{
+	int ret;
+
+	if (!stream->fill)
+		return ERROR_DECOMP_DATA;
+
+	ret = stream->fill(stream);
+	if (ret < 0)
+		return ERROR_DECOMP_READ;
+	if (ret == 0)
+		return ERROR_DECOMP_DATA;
+
+	stream->pos = 0;
+	stream->len = ret;
+
+	return 0;
+}
+
+/* Next input byte, or a negative error */
+static inline int stream_byte(struct decomp_stream *stream)
+{
+	int ret;
+
+	if (stream->pos == stream->len) {
+		ret = stream_refill(stream);
+		if (ret)
+			return ret;
+	}
+
+	return stream->buf[stream->pos++];
+}
+
+/* Copy "len" input bytes to "dst", or skip them if "dst" is NULL */
+static inline int stream_copy(struct decomp_stream *stream,
+				unsigned char *dst, unsigned int len)
+{
+	unsigned int count;
+	int ret;
+
+	while (len) {
+		if (stream->pos == stream->len) {
+			ret = stream_refill(stream);
+			if (ret)
+				return ret;
+		}
+
+		count = stream->len - stream->pos;
+		if (count > len)
+			count = len;
+
+		if (dst) {
+			memcpy(dst, stream->buf + stream->pos, count);
+			dst += count;
+		}
+
+		stream->pos += count;
+		len -= count;
+	}
+
+	return 0;
+}
+
+extern int gunzip_stream(struct decomp_stream *stream,
+			unsigned char *dst, unsigned int dst_max);
+
+extern int lz4_stream(struct decomp_stream *stream,
+			unsigned char *dst, unsigned int dst_max);
+
+extern int gunzip(const unsigned char *src, unsigned int src_len,
+			unsigned char *dst, unsigned int dst_max);
+
+extern int lz4_decompress(const unsigned char *src, unsigned int src_len,
+			unsigned char *dst, unsigned int dst_max);
+
+#endif /* #ifndef __DECOMPRESS_H__ */
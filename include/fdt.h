@@ -30,8 +30,35 @@
 
 extern unsigned int of_get_dt_total_size(void *blob);
 extern int check_dt_blob_valid(void *blob);
-extern int fixup_chosen_node(void *blob, char *bootargs);
-extern int fixup_memory_node(void *blob,
-				unsigned int *mem_bank,
+extern int of_get_node_offset(void *blob, const char *name, int *offset);
+extern int of_get_subnode_offset(void *blob,
+				int nodeoffset,
+				const char *name,
+				int *offset);
+extern void *of_get_property(void *blob,
+				int nodeoffset,
+				const char *name,
+				int *len);
+
+/* the fixups are queued, then applied at once by of_fixup_apply() */
+extern int of_fixup_node(const char *path);
+extern int of_fixup_property(const char *path,
+				const char *name,
+				const void *value,
+				int len);
+extern int of_fixup_apply(void *blob);
+
+extern int of_overlay_apply(void *blob, void *overlay);
+
+extern int fixup_chosen_node(char *bootargs);
+extern int fixup_chosen_initrd(unsigned int start, unsigned int end);
+extern int fixup_chosen_boot_trace(unsigned int base, unsigned int size);
+extern int fixup_memory_node(unsigned int *mem_bank,
 				unsigned int *mem_size);
+extern int fixup_board_info(unsigned int sn, unsigned int rev);
+extern int fixup_mac_address(const char *path, const unsigned char *mac);
+extern int fixup_reserved_memory(void *blob,
+				const char *name,
+				unsigned int base,
+				unsigned int size);
 #endif /* #ifndef __FDT_H__ */
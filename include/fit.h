@@ -0,0 +1,61 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __FIT_H__
+#define __FIT_H__
+
+/* The compression types, with the codes of the uImage header */
+#define FIT_COMP_NONE		0
+#define FIT_COMP_GZIP		1
+#define FIT_COMP_LZ4		5
+
+struct fit_image {
+	unsigned int	data;	/* where the data is in the RAM */
+	unsigned int	size;
+	unsigned int	load;
+	unsigned int	entry;
+	unsigned int	comp;
+};
+
+/*
+ * Reads "len" bytes at "offset" from the start of the FIT image on the
+ * media to "dest", returns 0, or -1 on error.
+ */
+typedef int (*fit_read_function)(void *priv,
+				unsigned int offset,
+				unsigned int len,
+				unsigned char *dest);
+
+extern int fit_check_header(void *fit);
+extern int fit_load(struct image_info *image,
+			fit_read_function read,
+			void *priv);
+
+extern struct fit_image *fit_get_kernel(void);
+extern struct fit_image *fit_get_ramdisk(void);
+
+#endif /* #ifndef __FIT_H__ */
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __MANIFEST_H__
+#define __MANIFEST_H__
+
+#define MANIFEST_MAX_ENTRIES	4
+
+/*
+ * Reads "len" bytes at "offset" of the media to "dest", returns 0, or -1
+ * on error.
+ */
+typedef int (*manifest_read_function)(void *priv,
+				unsigned int offset,
+				unsigned int len,
+				unsigned char *dest);
+
+struct load_entry {
+	unsigned int	type;		/* KERNEL_IMAGE, DT_BLOB, ... */
+	void		*source;	/* the read priv, if not the default */
+	unsigned int	offset;		/* on the media */
+	unsigned char	*dest;
+	unsigned int	*length;	/* 0: given by the image header */
+	int		(*get_length)(unsigned char *header);
+	int		(*verify)(unsigned char *dest, unsigned int length);
+};
+
+struct load_manifest {
+	const char		*media;		/* for the messages */
+	int			count;
+	int			overflow;
+	struct load_entry	entries[MANIFEST_MAX_ENTRIES];
+};
+
+extern void manifest_init(struct load_manifest *manifest, const char *media);
+extern struct load_entry *manifest_add(struct load_manifest *manifest,
+					unsigned int type,
+					unsigned int offset,
+					unsigned char *dest,
+					unsigned int *length,
+					int (*get_length)(unsigned char *));
+extern int manifest_load(struct load_manifest *manifest,
+			manifest_read_function read,
+			void *priv,
+			unsigned int unit);
+
+/* The images loaded after the kernel: the DT blob, the initrd */
+struct image_info;
+extern int image_manifest_add(struct image_info *image,
+				struct load_manifest *manifest);
+
+#endif /* #ifndef __MANIFEST_H__ */
@@ -37,11 +37,13 @@
 #define SD_CMD_SEND_IF_COND		8
 #define SD_CMD_SEND_CSD			9
 #define SD_CMD_SEND_CID			10
+#define SD_CMD_VOLTAGE_SWITCH		11
 #define SD_CMD_STOP_TRANSMISSION	12
 #define SD_CMD_SEND_STATUS		13
 #define	SD_CMD_SET_BLOCKLEN		16
 #define SD_CMD_READ_SINGLE_BLOCK	17
 #define SD_CMD_READ_MULTIPLE_BLOCK	18
+#define SD_CMD_SEND_TUNING_BLOCK	19
 #define SD_CMD_SET_BLOCK_COUNT		23
 #define SD_CMD_APP_CMD			55
 
@@ -57,6 +59,7 @@
 #define MMC_CMD_SEND_EXT_CSD		8
 #define MMC_CMD_BUSTEST_R		14
 #define MMC_CMD_BUSTEST_W		19
+#define MMC_CMD_SEND_TUNING_BLOCK_HS200	21
 
 /* Card State */
 #define SD_STATE_INACTIVE		0
@@ -139,6 +142,18 @@ struct sd_command {
 	unsigned int resp[4];
 };
 
+/* Bus Timing */
+#define SD_TIMING_LEGACY	0
+#define SD_TIMING_HS		1
+#define SD_TIMING_SDR50		2
+#define SD_TIMING_SDR104	3
+#define MMC_TIMING_DDR52	4
+#define MMC_TIMING_HS200	5
+
+/* Signal Voltage */
+#define SD_SIGNAL_VOLTAGE_330	0
+#define SD_SIGNAL_VOLTAGE_180	1
+
 #define	SD_DATA_DIR_RD		0x11
 #define	SD_DATA_DIR_WR		0x22
 
@@ -147,6 +162,7 @@ struct sd_data {
 	unsigned int direction;
 	unsigned int blocks;
 	unsigned int blocksize;
+	unsigned int nowait;	/* leave the DMA running, see wait_data() */
 };
 
 struct sd_card;
@@ -156,12 +172,23 @@ struct host_ops {
 	int (*send_command)(struct sd_command *command, struct sd_data *data);
 	int (*set_clock)(struct sd_card *sdcard, unsigned int clock);
 	int (*set_bus_width)(struct sd_card *sdcard, unsigned int width);
+	int (*set_signal_voltage)(struct sd_card *sdcard, unsigned int voltage);
+	int (*set_timing)(struct sd_card *sdcard, unsigned int timing);
+	int (*execute_tuning)(struct sd_card *sdcard, unsigned int cmd);
+	/* complete the read which send_command() left to the DMA */
+	int (*wait_data)(struct sd_data *data);
 };
 
 #define	BUS_WIDTH_1_BIT		0x01
 #define	BUS_WIDTH_4_BIT		0x04
 #define	BUS_WIDTH_8_BIT		0x08
 
+#define	HOST_CAPS_1V8		0x01	/* 1.8V signalling */
+#define	HOST_CAPS_SDR50		0x02
+#define	HOST_CAPS_SDR104	0x04
+#define	HOST_CAPS_DDR50		0x08
+#define	HOST_CAPS_TUNE_SDR50	0x10	/* SDR50 needs tuning */
+
 struct sd_host {
 	const unsigned char *name;
 	struct host_ops *ops;
@@ -171,6 +198,8 @@ struct sd_host {
 	unsigned int caps_max_clock;
 	unsigned int caps_min_clock;
 	unsigned int caps_voltages;
+	unsigned int caps_max_blocks;	/* blocks per data command, 0: no limit */
+	unsigned int caps_uhs;
 };
 
 struct sdcard_register {
@@ -193,6 +222,11 @@ struct sd_card {
 	unsigned int	highspeed_card;
 	unsigned int	read_bl_len;
 
+	unsigned int	bus_width;
+	unsigned int	bus_timing;
+	unsigned int	signal_1v8;
+	unsigned int	clock;
+
 	struct sd_host	*host;
 
 	struct sdcard_register	*reg;
@@ -63,6 +63,8 @@ struct nand_info {
 
 	unsigned int	buswidth;	/* data bus width (8/16 bits) */
 
+	unsigned int	good_block;	/* last block found good, plus 1 */
+
 	void (*command)(unsigned char cmd);
 	void (*address)(unsigned char addr);
 
@@ -40,8 +40,45 @@ typedef struct at91_secure_header {
 	unsigned int		reserved[2];
 } at91_secure_header_t;
 
+/* the plain application follows it, see CONFIG_SECURE_DIGEST */
+typedef struct at91_secure_digest_header {
+	unsigned int		magic;
+	unsigned int		file_size;
+	unsigned int		reserved[2];
+	unsigned int		digest[8];	/* SHA-256 of the application */
+	unsigned int		cmac[4];	/* AES-CMAC of the above */
+} at91_secure_digest_header_t;
+
+/* in clear, the encrypted application follows it, see CONFIG_SECURE_GCM */
+typedef struct at91_secure_gcm_header {
+	unsigned int		magic;
+	unsigned int		file_size;
+	unsigned int		reserved[2];
+	unsigned int		iv[3];		/* 96-bit IV, once per key */
+	unsigned int		reserved2;
+	unsigned int		tag[4];		/* authenticates the above */
+} at91_secure_gcm_header_t;
+
+#if defined(CONFIG_SECURE_DIGEST)
+#define AT91_SECURE_HEADER_SIZE	sizeof(at91_secure_digest_header_t)
+#elif defined(CONFIG_SECURE_GCM)
+#define AT91_SECURE_HEADER_SIZE	sizeof(at91_secure_gcm_header_t)
+#else
+#define AT91_SECURE_HEADER_SIZE	sizeof(at91_secure_header_t)
+#endif
+
 
 int secure_decrypt(void *data, unsigned int data_length, int is_signed);
 int secure_check(void *data);
 
+#ifdef CONFIG_SECURE_STREAM
+/*
+ * Reads the application with its header to image->dest, and checks it
+ * (and decrypts it) chunk by chunk while the next chunk is read.
+ */
+int secure_load_stream(struct image_info *image,
+		       image_read_function read,
+		       void *priv);
+#endif
+
 #endif /* #ifdef __SECURE_H__ */
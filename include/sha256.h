@@ -0,0 +1,56 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __SHA256_H__
+#define __SHA256_H__
+
+#define SHA256_DIGEST_SIZE	32
+#define SHA256_BLOCK_SIZE	64
+
+struct sha256_ctx {
+	unsigned int	state[8];	/* the software hash only */
+	unsigned int	count;		/* bytes hashed */
+	unsigned int	used;		/* bytes in block[] */
+	int		error;
+	unsigned int	block[SHA256_BLOCK_SIZE / 4];
+};
+
+/*
+ * With the SHA peripheral (CONFIG_AT91_SHA) there is one hash at a time,
+ * it is finished before the next one is started. The DMA may still read
+ * the data of sha256_update() when it returns: the data is to stay in
+ * place until the next sha256_update() or sha256_finish().
+ */
+extern void sha256_starts(struct sha256_ctx *ctx);
+extern void sha256_update(struct sha256_ctx *ctx,
+			const void *data,
+			unsigned int len);
+
+/* Returns 0, or -1 if the hardware failed */
+extern int sha256_finish(struct sha256_ctx *ctx, unsigned char *digest);
+
+#endif /* #ifndef __SHA256_H__ */
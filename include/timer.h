@@ -36,4 +36,7 @@ extern void mdelay(unsigned int msec);
 extern int start_interval_timer(void);
 extern int wait_interval_timer(unsigned int usec);
 
+extern unsigned int timer_get_ticks(void);
+extern unsigned int timer_ticks_to_ms(unsigned int ticks);
+
 #endif /* #ifndef __PIT_TIMER_H__ */
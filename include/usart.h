@@ -36,4 +36,12 @@ extern void usart_init(unsigned int);
 extern void usart_puts(const char *ptr);
 extern char usart_getc(void);
 
+#ifdef CONFIG_USART_BUFFERED
+extern void usart_poll(void);
+extern void usart_flush(void);
+#else
+static inline void usart_poll(void) { }
+static inline void usart_flush(void) { }
+#endif
+
 #endif /* __USART_H__ */
@@ -0,0 +1,484 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "string.h"
+#include "aes.h"
+
+/*
+ * AES as in FIPS 197, for the parts without the AES peripheral, behind
+ * the API of driver/at91_aes.c. One 1 KB table per direction, its
+ * rotations give the three others: the ARM926 rotates for free in the
+ * data processing instructions. The tables are built by at91_aes_init()
+ * rather than stored in the image. The lookups depend on the key and
+ * data, but the bootstrap runs with the data cache off: each one costs
+ * the same SRAM access.
+ */
+#define AES_MAX_ROUNDS	14
+
+struct aes_sw_key {
+	unsigned int	rk[4 * (AES_MAX_ROUNDS + 1)];
+	unsigned int	rounds;
+};
+
+static unsigned char aes_sbox[256];
+static unsigned char aes_inv_sbox[256];
+static unsigned int aes_te[256];	/* S[x].{02, 01, 01, 03} */
+static unsigned int aes_td[256];	/* Si[x].{0e, 09, 0d, 0b} */
+static int aes_tables_done;
+
+#define ROR8(x)		(((x) >> 8) | ((x) << 24))
+#define ROR16(x)	(((x) >> 16) | ((x) << 16))
+#define ROR24(x)	(((x) >> 24) | ((x) << 8))
+
+#define TE0(x)		(aes_te[(x) & 0xff])
+#define TE1(x)		ROR8(aes_te[(x) & 0xff])
+#define TE2(x)		ROR16(aes_te[(x) & 0xff])
+#define TE3(x)		ROR24(aes_te[(x) & 0xff])
+
+#define TD0(x)		(aes_td[(x) & 0xff])
+#define TD1(x)		ROR8(aes_td[(x) & 0xff])
+#define TD2(x)		ROR16(aes_td[(x) & 0xff])
+#define TD3(x)		ROR24(aes_td[(x) & 0xff])
+
+#define GET_BE32(p)	(((unsigned int)(p)[0] << 24) \
+			| ((unsigned int)(p)[1] << 16) \
+			| ((unsigned int)(p)[2] << 8) \
+			| (unsigned int)(p)[3])
+
+#define PUT_BE32(p, v)	do { \
+				(p)[0] = (v) >> 24; \
+				(p)[1] = (v) >> 16; \
+				(p)[2] = (v) >> 8; \
+				(p)[3] = (v); \
+			} while (0)
+
+static unsigned int aes_xtime(unsigned int x)
+{
+	return ((x << 1) ^ ((x & 0x80) ? 0x1b : 0)) & 0xff;
+}
+
+static unsigned int aes_mul(unsigned int x, unsigned int y)
+{
+	unsigned int r = 0;
+
+	while (y) {
+		if (y & 1)
+			r ^= x;
+		x = aes_xtime(x);
+		y >>= 1;
+	}
+
+	return r;
+}
+
+static void aes_gen_tables(void)
+{
+	unsigned char pow[256], log[256];
+	unsigned int i, x, s;
+
+	/* the powers of 3 go through the whole GF(2^8)* */
+	for (i = 0, x = 1; i < 255; i++) {
+		pow[i] = x;
+		log[x] = i;
+		x ^= aes_xtime(x);
+	}
+
+	for (i = 0; i < 256; i++) {
+		/* the inverse, then the affine transform */
+		x = i ? pow[(255 - log[i]) % 255] : 0;
+		s = x ^ (x << 1) ^ (x << 2) ^ (x << 3) ^ (x << 4);
+		s = (s ^ (s >> 8) ^ 0x63) & 0xff;
+
+		aes_sbox[i] = s;
+		aes_inv_sbox[s] = i;
+	}
+
+	for (i = 0; i < 256; i++) {
+		s = aes_sbox[i];
+		aes_te[i] = (aes_mul(s, 2) << 24) | (s << 16) | (s << 8)
+				| aes_mul(s, 3);
+
+		s = aes_inv_sbox[i];
+		aes_td[i] = (aes_mul(s, 14) << 24) | (aes_mul(s, 9) << 16)
+				| (aes_mul(s, 13) << 8) | aes_mul(s, 11);
+	}
+
+	aes_tables_done = 1;
+}
+
+static int aes_set_encrypt_key(struct aes_sw_key *ctx,
+			       at91_aes_key_size_t key_size,
+			       const unsigned int *key)
+{
+	static const unsigned char rcon[10] = {
+		0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
+	};
+	const unsigned char *k = (const unsigned char *)key;
+	unsigned int *rk = ctx->rk;
+	unsigned int nk, i, t;
+
+	switch (key_size) {
+	case AT91_AES_KEY_SIZE_128:
+		nk = 4;
+		break;
+
+	case AT91_AES_KEY_SIZE_192:
+		nk = 6;
+		break;
+
+	case AT91_AES_KEY_SIZE_256:
+		nk = 8;
+		break;
+
+	default:
+		return -1;
+	}
+
+	ctx->rounds = nk + 6;
+
+	for (i = 0; i < nk; i++)
+		rk[i] = GET_BE32(k + 4 * i);
+
+	for (i = nk; i < 4 * (ctx->rounds + 1); i++) {
+		t = rk[i - 1];
+		if ((i % nk) == 0) {
+			t = ((unsigned int)aes_sbox[(t >> 16) & 0xff] << 24)
+				| ((unsigned int)aes_sbox[(t >> 8) & 0xff] << 16)
+				| ((unsigned int)aes_sbox[t & 0xff] << 8)
+				| aes_sbox[t >> 24];
+			t ^= (unsigned int)rcon[i / nk - 1] << 24;
+		} else if ((nk > 6) && ((i % nk) == 4)) {
+			t = ((unsigned int)aes_sbox[t >> 24] << 24)
+				| ((unsigned int)aes_sbox[(t >> 16) & 0xff] << 16)
+				| ((unsigned int)aes_sbox[(t >> 8) & 0xff] << 8)
+				| aes_sbox[t & 0xff];
+		}
+		rk[i] = rk[i - nk] ^ t;
+	}
+
+	return 0;
+}
+
+/* the equivalent inverse cipher: reversed rounds, InvMixColumns inside */
+static int aes_set_decrypt_key(struct aes_sw_key *ctx,
+			       at91_aes_key_size_t key_size,
+			       const unsigned int *key)
+{
+	unsigned int *rk = ctx->rk;
+	unsigned int i, j, t;
+
+	if (aes_set_encrypt_key(ctx, key_size, key))
+		return -1;
+
+	for (i = 0, j = 4 * ctx->rounds; i < j; i += 4, j -= 4) {
+		t = rk[i]; rk[i] = rk[j]; rk[j] = t;
+		t = rk[i + 1]; rk[i + 1] = rk[j + 1]; rk[j + 1] = t;
+		t = rk[i + 2]; rk[i + 2] = rk[j + 2]; rk[j + 2] = t;
+		t = rk[i + 3]; rk[i + 3] = rk[j + 3]; rk[j + 3] = t;
+	}
+
+	for (i = 4; i < 4 * ctx->rounds; i++) {
+		t = rk[i];
+		rk[i] = TD0(aes_sbox[t >> 24])
+			^ TD1(aes_sbox[(t >> 16) & 0xff])
+			^ TD2(aes_sbox[(t >> 8) & 0xff])
+			^ TD3(aes_sbox[t & 0xff]);
+	}
+
+	return 0;
+}
+
+static void aes_encrypt_block(const struct aes_sw_key *ctx,
+			      const unsigned char *in,
+			      unsigned char *out)
+{
+	const unsigned int *rk = ctx->rk;
+	unsigned int s0, s1, s2, s3, t0, t1, t2, t3;
+	unsigned int r;
+
+	s0 = GET_BE32(in) ^ rk[0];
+	s1 = GET_BE32(in + 4) ^ rk[1];
+	s2 = GET_BE32(in + 8) ^ rk[2];
+	s3 = GET_BE32(in + 12) ^ rk[3];
+
+	for (r = 1; r < ctx->rounds; r++) {
+		rk += 4;
+		t0 = TE0(s0 >> 24) ^ TE1(s1 >> 16) ^ TE2(s2 >> 8) ^ TE3(s3)
+			^ rk[0];
+		t1 = TE0(s1 >> 24) ^ TE1(s2 >> 16) ^ TE2(s3 >> 8) ^ TE3(s0)
+			^ rk[1];
+		t2 = TE0(s2 >> 24) ^ TE1(s3 >> 16) ^ TE2(s0 >> 8) ^ TE3(s1)
+			^ rk[2];
+		t3 = TE0(s3 >> 24) ^ TE1(s0 >> 16) ^ TE2(s1 >> 8) ^ TE3(s2)
+			^ rk[3];
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
+
+	/* no MixColumns in the last round */
+	rk += 4;
+#define SB(x, n)	((unsigned int)aes_sbox[((x) >> (n)) & 0xff] << (n))
+	t0 = SB(s0, 24) ^ SB(s1, 16) ^ SB(s2, 8) ^ SB(s3, 0) ^ rk[0];
+	t1 = SB(s1, 24) ^ SB(s2, 16) ^ SB(s3, 8) ^ SB(s0, 0) ^ rk[1];
+	t2 = SB(s2, 24) ^ SB(s3, 16) ^ SB(s0, 8) ^ SB(s1, 0) ^ rk[2];
+	t3 = SB(s3, 24) ^ SB(s0, 16) ^ SB(s1, 8) ^ SB(s2, 0) ^ rk[3];
+#undef SB
+
+	PUT_BE32(out, t0);
+	PUT_BE32(out + 4, t1);
+	PUT_BE32(out + 8, t2);
+	PUT_BE32(out + 12, t3);
+}
+
+static void aes_decrypt_block(const struct aes_sw_key *ctx,
+			      const unsigned char *in,
+			      unsigned char *out)
+{
+	const unsigned int *rk = ctx->rk;
+	unsigned int s0, s1, s2, s3, t0, t1, t2, t3;
+	unsigned int r;
+
+	s0 = GET_BE32(in) ^ rk[0];
+	s1 = GET_BE32(in + 4) ^ rk[1];
+	s2 = GET_BE32(in + 8) ^ rk[2];
+	s3 = GET_BE32(in + 12) ^ rk[3];
+
+	for (r = 1; r < ctx->rounds; r++) {
+		rk += 4;
+		t0 = TD0(s0 >> 24) ^ TD1(s3 >> 16) ^ TD2(s2 >> 8) ^ TD3(s1)
+			^ rk[0];
+		t1 = TD0(s1 >> 24) ^ TD1(s0 >> 16) ^ TD2(s3 >> 8) ^ TD3(s2)
+			^ rk[1];
+		t2 = TD0(s2 >> 24) ^ TD1(s1 >> 16) ^ TD2(s0 >> 8) ^ TD3(s3)
+			^ rk[2];
+		t3 = TD0(s3 >> 24) ^ TD1(s2 >> 16) ^ TD2(s1 >> 8) ^ TD3(s0)
+			^ rk[3];
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
+
+	rk += 4;
+#define SI(x, n)	((unsigned int)aes_inv_sbox[((x) >> (n)) & 0xff] << (n))
+	t0 = SI(s0, 24) ^ SI(s3, 16) ^ SI(s2, 8) ^ SI(s1, 0) ^ rk[0];
+	t1 = SI(s1, 24) ^ SI(s0, 16) ^ SI(s3, 8) ^ SI(s2, 0) ^ rk[1];
+	t2 = SI(s2, 24) ^ SI(s1, 16) ^ SI(s0, 8) ^ SI(s3, 0) ^ rk[2];
+	t3 = SI(s3, 24) ^ SI(s2, 16) ^ SI(s1, 8) ^ SI(s0, 0) ^ rk[3];
+#undef SI
+
+	PUT_BE32(out, t0);
+	PUT_BE32(out + 4, t1);
+	PUT_BE32(out + 8, t2);
+	PUT_BE32(out + 12, t3);
+}
+
+static void aes_xor_block(unsigned char *dst,
+			  const unsigned char *a,
+			  const unsigned char *b)
+{
+	unsigned int i;
+
+	for (i = 0; i < AT91_AES_BLOCK_SIZE_BYTE; i++)
+		dst[i] = a[i] ^ b[i];
+}
+
+void at91_aes_init(void)
+{
+	if (!aes_tables_done)
+		aes_gen_tables();
+}
+
+void at91_aes_cleanup(void)
+{
+}
+
+/* As the AES peripheral, whole blocks: the length is rounded up */
+int at91_aes_cbc(unsigned int data_length,
+		 const void *input,
+		 void *output,
+		 int encrypt,
+		 at91_aes_key_size_t key_size,
+		 const unsigned int *key,
+		 const unsigned int *iv)
+{
+	struct aes_sw_key ctx;
+	const unsigned char *in = input;
+	unsigned char *out = output;
+	unsigned char chain[AT91_AES_BLOCK_SIZE_BYTE];
+	unsigned char block[AT91_AES_BLOCK_SIZE_BYTE];
+	unsigned int n;
+
+	if (!data_length || !input || !output || !key || !iv)
+		return -1;
+
+	if (encrypt ? aes_set_encrypt_key(&ctx, key_size, key)
+		    : aes_set_decrypt_key(&ctx, key_size, key))
+		return -1;
+
+	memcpy(chain, iv, AT91_AES_BLOCK_SIZE_BYTE);
+
+	for (n = at91_aes_roundup(data_length) / AT91_AES_BLOCK_SIZE_BYTE;
+	     n; n--) {
+		if (encrypt) {
+			aes_xor_block(block, in, chain);
+			aes_encrypt_block(&ctx, block, out);
+			memcpy(chain, out, AT91_AES_BLOCK_SIZE_BYTE);
+		} else {
+			/* the output may be the input */
+			memcpy(block, in, AT91_AES_BLOCK_SIZE_BYTE);
+			aes_decrypt_block(&ctx, block, out);
+			aes_xor_block(out, out, chain);
+			memcpy(chain, block, AT91_AES_BLOCK_SIZE_BYTE);
+		}
+
+		in += AT91_AES_BLOCK_SIZE_BYTE;
+		out += AT91_AES_BLOCK_SIZE_BYTE;
+	}
+
+	memset(&ctx, 0, sizeof(ctx));
+
+	return 0;
+}
+
+int at91_aes_cbc_start(unsigned int data_length,
+		       const void *input,
+		       void *output,
+		       int encrypt,
+		       at91_aes_key_size_t key_size,
+		       const unsigned int *key,
+		       const unsigned int *iv)
+{
+	return at91_aes_cbc(data_length, input, output, encrypt,
+			    key_size, key, iv);
+}
+
+int at91_aes_wait(void)
+{
+	return 0;
+}
+
+int at91_aes_cbc_mac(unsigned int data_length,
+		     const void *data,
+		     unsigned int *mac,
+		     at91_aes_key_size_t key_size,
+		     const unsigned int *key)
+{
+	struct aes_sw_key ctx;
+	const unsigned char *in = data;
+	unsigned char *m = (unsigned char *)mac;
+	unsigned int n;
+
+	if (!data_length || !data || !mac || !key)
+		return -1;
+
+	if (aes_set_encrypt_key(&ctx, key_size, key))
+		return -1;
+
+	for (n = at91_aes_roundup(data_length) / AT91_AES_BLOCK_SIZE_BYTE;
+	     n; n--) {
+		aes_xor_block(m, m, in);
+		aes_encrypt_block(&ctx, m, m);
+		in += AT91_AES_BLOCK_SIZE_BYTE;
+	}
+
+	memset(&ctx, 0, sizeof(ctx));
+
+	return 0;
+}
+
+int at91_aes_cmac_finish(const void *last_block,
+			 unsigned int *mac,
+			 at91_aes_key_size_t key_size,
+			 const unsigned int *key)
+{
+	struct aes_sw_key ctx;
+	unsigned char subkey[AT91_AES_BLOCK_SIZE_BYTE];
+	unsigned char *m = (unsigned char *)mac;
+	unsigned char carry;
+	int i; /* MUST be signed for the subkey loop */
+
+	if (!last_block || !mac || !key)
+		return -1;
+
+	if (aes_set_encrypt_key(&ctx, key_size, key))
+		return -1;
+
+	/* Generate the subkey */
+	memset(subkey, 0, sizeof(subkey));
+	aes_encrypt_block(&ctx, subkey, subkey);
+
+	carry = 0;
+	for (i = AT91_AES_BLOCK_SIZE_BYTE-1; i >= 0; --i) {
+		unsigned char tmp, next_carry;
+
+		tmp = subkey[i];
+		next_carry = ((tmp & 0x80) != 0);
+		subkey[i] = (tmp << 1) | carry;
+		carry = next_carry;
+	}
+	carry = (0 - carry) & 0x87;
+	subkey[AT91_AES_BLOCK_SIZE_BYTE-1] ^= carry;
+
+	/* Process the last block */
+	aes_xor_block(m, m, last_block);
+	aes_xor_block(m, m, subkey);
+	aes_encrypt_block(&ctx, m, m);
+
+	memset(&ctx, 0, sizeof(ctx));
+	memset(subkey, 0, sizeof(subkey));
+
+	return 0;
+}
+
+int at91_aes_cmac(unsigned int data_length,
+		  const void *data,
+		  unsigned int *cmac,
+		  at91_aes_key_size_t key_size,
+		  const unsigned int *key)
+{
+	const unsigned char *input = data;
+	unsigned int num_blocks;
+
+	if (!data_length || !data || !cmac || !key)
+		return -1;
+
+	/* Process the n-1 first blocks */
+	memset(cmac, 0, AT91_AES_BLOCK_SIZE_BYTE);
+	num_blocks = at91_aes_roundup(data_length) / AT91_AES_BLOCK_SIZE_BYTE;
+	if ((num_blocks > 1)
+	    && at91_aes_cbc_mac(data_length - AT91_AES_BLOCK_SIZE_BYTE,
+				data, cmac, key_size, key))
+		return -1;
+
+	/* Process the last block */
+	return at91_aes_cmac_finish(input
+				+ (num_blocks-1) * AT91_AES_BLOCK_SIZE_BYTE,
+				cmac, key_size, key);
+}
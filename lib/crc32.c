@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "crc32.h"
+
+/* CRC-32 as in zlib and gzip, reflected polynomial 0xedb88320 */
+#define CRC32_POLY	0xedb88320
+
+#ifdef CONFIG_CRC32_SLICE8
+/*
+ * Slicing-by-8: crc32_table[k][n] is the CRC of the byte n followed by
+ * k zero bytes, so eight bytes are folded in with eight lookups.
+ */
+static unsigned int crc32_table[8][256];
+static int crc32_table_ready;
+
+static void crc32_make_table(void)
+{
+	unsigned int crc;
+	unsigned int i, j;
+
+	for (i = 0; i < 256; i++) {
+		crc = i;
+		for (j = 0; j < 8; j++)
+			crc = (crc >> 1) ^ (CRC32_POLY & (0 - (crc & 1)));
+		crc32_table[0][i] = crc;
+	}
+
+	for (i = 0; i < 256; i++) {
+		crc = crc32_table[0][i];
+		for (j = 1; j < 8; j++) {
+			crc = (crc >> 8) ^ crc32_table[0][crc & 0xff];
+			crc32_table[j][i] = crc;
+		}
+	}
+
+	crc32_table_ready = 1;
+}
+
+unsigned int crc32(unsigned int crc, const unsigned char *buf, unsigned int len)
+{
+	const unsigned int *p;
+	unsigned int one, two;
+
+	if (!crc32_table_ready)
+		crc32_make_table();
+
+	crc = ~crc;
+
+	while (len && ((unsigned int)buf & 3)) {
+		crc = (crc >> 8) ^ crc32_table[0][(crc ^ *buf++) & 0xff];
+		len--;
+	}
+
+	/* little endian words */
+	p = (const unsigned int *)buf;
+	for (; len >= 8; len -= 8) {
+		one = *p++ ^ crc;
+		two = *p++;
+		crc = crc32_table[7][one & 0xff]
+			^ crc32_table[6][(one >> 8) & 0xff]
+			^ crc32_table[5][(one >> 16) & 0xff]
+			^ crc32_table[4][one >> 24]
+			^ crc32_table[3][two & 0xff]
+			^ crc32_table[2][(two >> 8) & 0xff]
+			^ crc32_table[1][(two >> 16) & 0xff]
+			^ crc32_table[0][two >> 24];
+	}
+	buf = (const unsigned char *)p;
+
+	while (len--)
+		crc = (crc >> 8) ^ crc32_table[0][(crc ^ *buf++) & 0xff];
+
+	return ~crc;
+}
+#else
+static const unsigned int crc32_table[16] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+	0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+	0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+unsigned int crc32(unsigned int crc, const unsigned char *buf, unsigned int len)
+{
+	crc = ~crc;
+
+	while (len--) {
+		crc ^= *buf++;
+		crc = (crc >> 4) ^ crc32_table[crc & 0x0f];
+		crc = (crc >> 4) ^ crc32_table[crc & 0x0f];
+	}
+
+	return ~crc;
+}
+#endif
@@ -179,10 +179,7 @@ static int of_get_token_nextoffset(void *blob,
 	if (tag  == OF_DT_TOKEN_NODE_BEGIN) {
 		/* node name */
 		cell = (char *)of_dt_struct_offset(blob, offset);
-		do {
-			cell++;
-			offset++;
-		} while (*cell != '\0');
+		offset += strlen(cell) + 1;
 	} else if (tag == OF_DT_TOKEN_PROP) {
 		/* the property value size */
 		plen = (unsigned int *)of_dt_struct_offset(blob, offset);
@@ -246,7 +243,7 @@ static int of_get_nextnode_offset(void *blob,
 	return 0;
 }
 
-static int of_get_node_offset(void *blob, char *name, int *offset)
+int of_get_node_offset(void *blob, const char *name, int *offset)
 {
 	int start_offset = 0;
 	int nodeoffset = 0;
@@ -284,51 +281,48 @@ static int of_get_node_offset(void *blob, char *name, int *offset)
 	return 0;
 }
 
-/* -------------------------------------------------------- */
-
-static int of_blob_move_dt_struct(void *blob,
-					void *point,
-					int oldlen,
-					int newlen)
+/* The subnode "name" of the node at "nodeoffset", not its descendants */
+int of_get_subnode_offset(void *blob,
+			int nodeoffset,
+			const char *name,
+			int *offset)
 {
-	void *dest = point + newlen;
-	void *src = point + oldlen;
-	unsigned int len = (char *)blob + of_blob_data_size(blob)
-					- (char *)point - oldlen;
-
-	int delta = newlen - oldlen;
-	unsigned int structlen = of_get_dt_struct_len(blob) + delta;
-	unsigned int stringsoffset = of_get_offset_dt_strings(blob) + delta;
-
-	memmove(dest, src, len);
+	int startoffset = nodeoffset;
+	int nextoffset;
+	int depth = 0;
+	unsigned int token;
+	unsigned int namelen = strlen(name);
+	char *nodename;
+	int ret;
 
-	of_set_dt_struct_len(blob, structlen);
-	of_set_offset_dt_strings(blob, stringsoffset);
+	while (1) {
+		ret = of_get_token_nextoffset(blob, startoffset,
+						&nextoffset, &token);
+		if (ret)
+			return ret;
 
-	if (delta > 0)
-		of_set_dt_total_size(blob, of_get_dt_total_size(blob) + delta);
+		if (token == OF_DT_TOKEN_NODE_BEGIN) {
+			nodename = (char *)of_dt_struct_offset(blob,
+							startoffset + 4);
+			if ((depth == 0)
+				&& (memcmp(nodename, name, namelen) == 0)
+				&& (nodename[namelen] == '\0')) {
+				*offset = nextoffset;
+				return 0;
+			}
+			depth++;
+		} else if (token == OF_DT_TOKEN_NODE_END) {
+			if (depth == 0)
+				return -1; /* not found */
+			depth--;
+		} else if (token == OF_DT_END)
+			return -1;
 
-	return 0;
+		startoffset = nextoffset;
+	}
 }
 
-static int of_blob_move_dt_string(void *blob, int newlen)
-{
-	void *point = (void *)((unsigned int)blob
-				+ of_get_offset_dt_strings(blob)
-				+ of_get_dt_strings_len(blob));
-
-	void *dest = point + newlen;
-	unsigned int len = (char *)blob + of_blob_data_size(blob)
-					- (char *)point;
-	unsigned int stringslen = of_get_dt_strings_len(blob) + newlen;
-
-	memmove(dest, point, len);
-
-	of_set_dt_strings_len(blob, stringslen);
-	of_set_dt_total_size(blob, of_get_dt_total_size(blob) + newlen);
-
-	return 0;
-}
+/* -------------------------------------------------------- */
 
 static int of_get_next_property_offset(void *blob,
 				int startoffset,
@@ -350,9 +344,10 @@ static int of_get_next_property_offset(void *blob,
 			*nextproperty = nextoffset;
 			ret = 0;
 			break;
-		} else if (token == OF_DT_TOKEN_NOP)
+		} else if (token == OF_DT_TOKEN_NOP) {
+			startoffset = nextoffset;
 			continue;
-		else {
+		} else {
 			ret = -1;
 			break;
 		}
@@ -365,7 +360,7 @@ static int of_get_next_property_offset(void *blob,
 
 static int of_get_property_offset_by_name(void *blob,
 					unsigned int nodeoffset,
-					char *name,
+					const char *name,
 					int *offset)
 {
 	unsigned int nameoffset;
@@ -400,151 +395,633 @@ static int of_get_property_offset_by_name(void *blob,
 	return -1;
 }
 
-static int of_string_is_find_strings_blob(void *blob,
-				const char *string,
-				int *offset)
+/* The value of the property "name" of the node at "nodeoffset" */
+void *of_get_property(void *blob,
+			int nodeoffset,
+			const char *name,
+			int *len)
 {
-	char *dt_strings = (char *)blob + of_get_offset_dt_strings(blob);
-	int dt_stringslen = of_get_dt_strings_len(blob);
-	int len = strlen(string) + 1;
-	char *lastpoint = dt_strings + dt_stringslen - len;
-	char *p;
+	int property_offset;
+	unsigned int *p;
 
-	for (p = dt_strings; p <= lastpoint; p++) {
-		if (memcmp(p, string, len) == 0) {
-			*offset = p - dt_strings;
-			return 0;
-		}
+	if (of_get_property_offset_by_name(blob, nodeoffset,
+					name, &property_offset))
+		return NULL;
+
+	p = (unsigned int *)of_dt_struct_offset(blob, property_offset + 4);
+	if (len)
+		*len = swap_uint32(*p);
+
+	return (void *)of_dt_struct_offset(blob, property_offset + 12);
+}
+
+/* -------------------------------------------------------- */
+
+/*
+ * The fixups are queued, then of_fixup_apply() rebuilds the blob once:
+ * one walk of the structure block finds the queued nodes and properties,
+ * one walk of the strings block finds the property names, then each
+ * byte of the blob is moved once, straight to its new place, and the
+ * new properties, nodes and names are written in the gaps.
+ */
+#ifdef CONFIG_OF_OVERLAY
+#define OF_FIXUP_MAX_NODES	16
+#define OF_FIXUP_MAX_PROPS	32
+#else
+#define OF_FIXUP_MAX_NODES	8
+#define OF_FIXUP_MAX_PROPS	16
+#endif
+#define OF_FIXUP_MAX_EDITS	(OF_FIXUP_MAX_NODES + OF_FIXUP_MAX_PROPS + 1)
+#define OF_FIXUP_MAX_DEPTH	16
+#define OF_FIXUP_VALUE_SIZE	16
+#define OF_FIXUP_NAME_SIZE	32
+
+struct of_fixup_node {
+	char		name[OF_FIXUP_NAME_SIZE]; /* its path component */
+	int		namelen;
+	int		parent;		/* -1 for the root node */
+	int		props_offset;	/* -1 until found in the blob */
+	int		end_offset;
+};
+
+struct of_fixup_prop {
+	int		node;
+	const char	*name;
+	const void	*value;
+	int		len;
+	int		offset;		/* -1 until found in the blob */
+	int		oldsize;
+	int		nameoffset;	/* -1 until found in the strings */
+	unsigned int	data[OF_FIXUP_VALUE_SIZE / 4];
+};
+
+#define OF_EDIT_PROPS	0	/* the new properties of a node */
+#define OF_EDIT_NODE	1	/* a new node and its subnodes */
+#define OF_EDIT_PROP	2	/* an updated property */
+#define OF_EDIT_STRINGS	3	/* the new names */
+
+struct of_fixup_edit {
+	int		type;
+	int		index;
+	unsigned int	offset;		/* in the blob */
+	unsigned int	oldsize;
+	unsigned int	newsize;
+	int		shift;		/* of the data after this edit */
+};
+
+static struct of_fixup_node of_fixup_nodes[OF_FIXUP_MAX_NODES];
+static struct of_fixup_prop of_fixup_props[OF_FIXUP_MAX_PROPS];
+static struct of_fixup_edit of_fixup_edits[OF_FIXUP_MAX_EDITS];
+static int of_fixup_num_nodes;
+static int of_fixup_num_props;
+static int of_fixup_num_edits;
+
+static int of_fixup_get_node(int parent, const char *name, int namelen)
+{
+	struct of_fixup_node *node;
+	int i;
+
+	for (i = 0; i < of_fixup_num_nodes; i++) {
+		node = &of_fixup_nodes[i];
+		if ((node->parent == parent) && (node->namelen == namelen)
+			&& (memcmp(node->name, name, namelen) == 0))
+			return i;
 	}
 
-	return -1;
+	if (of_fixup_num_nodes == OF_FIXUP_MAX_NODES) {
+		dbg_info("DT: too many fixup nodes\n");
+		return -1;
+	}
+
+	if (namelen >= OF_FIXUP_NAME_SIZE) {
+		dbg_info("DT: the node name is too long\n");
+		return -1;
+	}
+
+	node = &of_fixup_nodes[of_fixup_num_nodes];
+	memcpy(node->name, name, namelen);
+	node->namelen = namelen;
+	node->parent = parent;
+	node->props_offset = -1;
+	node->end_offset = -1;
+
+	return of_fixup_num_nodes++;
 }
 
-static int of_add_string_strings_blob(void *blob,
-			const char *string,
-			int *name_offset)
+/* The index of the node "path", queued with its parents if need be */
+static int of_fixup_path(const char *path)
 {
-	char *dt_strings = (char *)blob + of_get_offset_dt_strings(blob);
-	int dt_stringslen = of_get_dt_strings_len(blob);
-	char *new_string;
-	int len = strlen(string) + 1;
-	int ret;
+	const char *name;
+	int node;
 
-	new_string = dt_strings + dt_stringslen;
-	ret = of_blob_move_dt_string(blob, len);
-	if (ret)
-		return ret;
+	if (*path != '/')
+		return -1;
 
-	memcpy(new_string, string, len);
+	node = of_fixup_get_node(-1, path, 0);
+	while (node >= 0) {
+		while (*path == '/')
+			path++;
+		if (*path == '\0')
+			break;
+
+		for (name = path; (*path != '\0') && (*path != '/'); path++)
+			;
+		node = of_fixup_get_node(node, name, path - name);
+	}
 
-	*name_offset = new_string - dt_strings;
+	return node;
+}
+
+/* The node "path" is added to the blob if it is missing */
+int of_fixup_node(const char *path)
+{
+	return (of_fixup_path(path) < 0) ? -1 : 0;
+}
+
+/*
+ * The property "name" of the node "path" is set to "value", the node is
+ * added if it is missing. The path and the values up to 16 bytes are
+ * copied, the name and the longer values must stay until
+ * of_fixup_apply().
+ */
+int of_fixup_property(const char *path,
+			const char *name,
+			const void *value,
+			int len)
+{
+	struct of_fixup_prop *prop;
+	int node;
+	int i;
+
+	node = of_fixup_path(path);
+	if (node < 0)
+		return -1;
+
+	/* the last value wins */
+	for (i = 0; i < of_fixup_num_props; i++) {
+		prop = &of_fixup_props[i];
+		if ((prop->node == node) && (strcmp(prop->name, name) == 0))
+			break;
+	}
+
+	if (i == OF_FIXUP_MAX_PROPS) {
+		dbg_info("DT: too many fixup properties\n");
+		return -1;
+	}
+
+	prop = &of_fixup_props[i];
+	if (i == of_fixup_num_props)
+		of_fixup_num_props++;
+
+	prop->node = node;
+	prop->name = name;
+	prop->len = len;
+	if (len <= OF_FIXUP_VALUE_SIZE) {
+		memcpy(prop->data, value, len);
+		prop->value = prop->data;
+	} else
+		prop->value = value;
 
 	return 0;
 }
 
-static int of_add_property(void *blob,
-				int nextoffset,
-				const char *property_name,
-				const void *value,
-				int valuelen)
+/*
+ * The blob node name matches the path component with or without its
+ * unit address: "memory" matches "memory@20000000".
+ */
+static int of_fixup_match_node(int parent, const char *nodename)
 {
-	int string_offset;
-	unsigned int *p;
-	unsigned int addr;
-	int len;
-	int ret;
+	struct of_fixup_node *node;
+	int i;
 
-	/* check if the property name in the dt_strings,
-	 * else add the string in dt strings
+	for (i = 0; i < of_fixup_num_nodes; i++) {
+		node = &of_fixup_nodes[i];
+		if ((node->parent != parent)
+			|| memcmp(nodename, node->name, node->namelen))
+			continue;
+
+		if (nodename[node->namelen] == '\0')
+			return i;
+
+		if ((nodename[node->namelen] == '@')
+			&& !memchr(node->name, '@', node->namelen))
+			return i;
+	}
+
+	return -1;
+}
+
+static void of_fixup_match_prop(void *blob, int node,
+				int offset, int nextoffset)
+{
+	struct of_fixup_prop *prop;
+	unsigned int nameoffset;
+	char *name;
+	int i;
+
+	nameoffset = swap_uint32(*(unsigned int *)of_dt_struct_offset(blob,
+							offset + 8));
+	name = of_get_string_by_offset(blob, nameoffset);
+
+	for (i = 0; i < of_fixup_num_props; i++) {
+		prop = &of_fixup_props[i];
+		if ((prop->node == node) && (strcmp(prop->name, name) == 0)) {
+			prop->offset = offset;
+			prop->oldsize = nextoffset - offset;
+			prop->nameoffset = nameoffset;
+		}
+	}
+}
+
+/* Finds the queued nodes and properties in one walk */
+static int of_fixup_scan_struct(void *blob)
+{
+	int stack[OF_FIXUP_MAX_DEPTH];
+	int depth = -1;
+	int offset = 0;
+	int nextoffset;
+	unsigned int token;
+	int node;
+
+	while (1) {
+		if (of_get_token_nextoffset(blob, offset, &nextoffset, &token))
+			return -1;
+
+		if (token == OF_DT_TOKEN_NODE_BEGIN) {
+			depth++;
+			if (depth >= OF_FIXUP_MAX_DEPTH) {
+				offset = nextoffset;
+				continue;
+			}
+
+			node = -1;
+			if ((depth == 0) || (stack[depth - 1] >= 0))
+				node = of_fixup_match_node(
+					depth ? stack[depth - 1] : -1,
+					(char *)of_dt_struct_offset(blob,
+								offset + 4));
+			stack[depth] = node;
+			if (node >= 0)
+				of_fixup_nodes[node].props_offset = nextoffset;
+		} else if (token == OF_DT_TOKEN_NODE_END) {
+			if (depth < 0)
+				return -1;
+			if ((depth < OF_FIXUP_MAX_DEPTH) && (stack[depth] >= 0))
+				of_fixup_nodes[stack[depth]].end_offset = offset;
+			depth--;
+		} else if (token == OF_DT_TOKEN_PROP) {
+			if ((depth >= 0) && (depth < OF_FIXUP_MAX_DEPTH)
+				&& (stack[depth] >= 0))
+				of_fixup_match_prop(blob, stack[depth],
+							offset, nextoffset);
+		} else if (token == OF_DT_END) {
+			break;
+		}
+
+		offset = nextoffset;
+	}
+
+	return (depth == -1) ? 0 : -1;
+}
+
+/* Finds the names of the new properties in one walk, returns their size */
+static unsigned int of_fixup_scan_strings(void *blob)
+{
+	char *strings = (char *)blob + of_get_offset_dt_strings(blob);
+	unsigned int stringslen = of_get_dt_strings_len(blob);
+	unsigned int offset, added = 0;
+	struct of_fixup_prop *prop;
+	int i, j;
+
+	for (offset = 0; offset < stringslen;
+	     offset += strlen(strings + offset) + 1) {
+		for (i = 0; i < of_fixup_num_props; i++) {
+			prop = &of_fixup_props[i];
+			if ((prop->nameoffset < 0)
+				&& (strcmp(prop->name, strings + offset) == 0))
+				prop->nameoffset = offset;
+		}
+	}
+
+	/* the missing names are added once */
+	for (i = 0; i < of_fixup_num_props; i++) {
+		prop = &of_fixup_props[i];
+		if (prop->nameoffset >= 0)
+			continue;
+
+		for (j = 0; j < i; j++) {
+			if (strcmp(of_fixup_props[j].name, prop->name) == 0) {
+				prop->nameoffset = of_fixup_props[j].nameoffset;
+				break;
+			}
+		}
+
+		if (j == i) {
+			prop->nameoffset = stringslen + added;
+			added += strlen(prop->name) + 1;
+		}
+	}
+
+	return added;
+}
+
+static unsigned int of_fixup_prop_size(const struct of_fixup_prop *prop)
+{
+	return 12 + OF_ALIGN(prop->len);
+}
+
+/* The new properties of the node, or all of them for a new node */
+static unsigned int of_fixup_props_size(int node, int all)
+{
+	unsigned int size = 0;
+	int i;
+
+	for (i = 0; i < of_fixup_num_props; i++) {
+		if ((of_fixup_props[i].node == node)
+			&& (all || (of_fixup_props[i].offset < 0)))
+			size += of_fixup_prop_size(&of_fixup_props[i]);
+	}
+
+	return size;
+}
+
+static unsigned int of_fixup_node_size(int node)
+{
+	unsigned int size;
+	int i;
+
+	/* begin token, name, properties, subnodes, end token */
+	size = 4 + OF_ALIGN(of_fixup_nodes[node].namelen + 1)
+		+ of_fixup_props_size(node, 1) + 4;
+
+	for (i = 0; i < of_fixup_num_nodes; i++) {
+		if (of_fixup_nodes[i].parent == node)
+			size += of_fixup_node_size(i);
+	}
+
+	return size;
+}
+
+static int of_fixup_add_edit(int type, int index, unsigned int offset,
+				unsigned int oldsize, unsigned int newsize)
+{
+	struct of_fixup_edit *edit;
+	int i;
+
+	if (of_fixup_num_edits == OF_FIXUP_MAX_EDITS)
+		return -1;
+
+	/*
+	 * Sorted by offset: at the same offset, the insertions go first,
+	 * the new properties of a node before its new subnodes.
 	 */
-	ret = of_string_is_find_strings_blob(blob,
-				property_name, &string_offset);
-	if (ret) {
-		ret = of_add_string_strings_blob(blob,
-				property_name, &string_offset);
-		if (ret)
-			return ret;
+	for (i = of_fixup_num_edits; i > 0; i--) {
+		edit = &of_fixup_edits[i - 1];
+		if ((edit->offset < offset)
+			|| ((edit->offset == offset) && (edit->type <= type)))
+			break;
+		of_fixup_edits[i] = *edit;
 	}
 
-	/* add the property node in dt struct */
-	len = 12 + OF_ALIGN(valuelen);
-	addr = of_dt_struct_offset(blob, nextoffset);
-	ret = of_blob_move_dt_struct(blob, (void *)addr, 0, len);
-	if (ret)
-		return ret;
+	edit = &of_fixup_edits[i];
+	edit->type = type;
+	edit->index = index;
+	edit->offset = offset;
+	edit->oldsize = oldsize;
+	edit->newsize = newsize;
+	of_fixup_num_edits++;
+
+	return 0;
+}
+
+static int of_fixup_build_edits(void *blob, unsigned int added)
+{
+	unsigned int base = of_get_offset_dt_struct(blob);
+	struct of_fixup_node *node;
+	struct of_fixup_prop *prop;
+	unsigned int size;
+	int i;
+
+	of_fixup_num_edits = 0;
+
+	for (i = 0; i < of_fixup_num_nodes; i++) {
+		node = &of_fixup_nodes[i];
+		if (node->props_offset >= 0) {
+			size = of_fixup_props_size(i, 0);
+			if (size && of_fixup_add_edit(OF_EDIT_PROPS, i,
+					base + node->props_offset, 0, size))
+				return -1;
+		} else if (node->parent < 0) {
+			dbg_info("DT: no root node\n");
+			return -1;
+		} else if (of_fixup_nodes[node->parent].props_offset >= 0) {
+			if (of_fixup_add_edit(OF_EDIT_NODE, i,
+				base + of_fixup_nodes[node->parent].end_offset,
+				0, of_fixup_node_size(i)))
+				return -1;
+		}
+	}
 
-	p = (unsigned int *)addr;
+	for (i = 0; i < of_fixup_num_props; i++) {
+		prop = &of_fixup_props[i];
+		if ((prop->offset >= 0) && of_fixup_add_edit(OF_EDIT_PROP, i,
+				base + prop->offset, prop->oldsize,
+				of_fixup_prop_size(prop)))
+			return -1;
+	}
 
-	/* set property node: token, value size, name offset, value */
-	*p++ = swap_uint32(OF_DT_TOKEN_PROP);
-	*p++ = swap_uint32(valuelen);
-	*p++ = swap_uint32(string_offset);
-	memcpy((unsigned char *)p, value, valuelen);
+	if (added && of_fixup_add_edit(OF_EDIT_STRINGS, 0,
+			of_get_offset_dt_strings(blob)
+				+ of_get_dt_strings_len(blob), 0, added))
+		return -1;
 
 	return 0;
 }
 
-static int of_update_property_value(void *blob,
-				int property_offset,
-				const void *value,
-				int valuelen)
+static unsigned char *of_fixup_put_prop(unsigned char *p,
+					const struct of_fixup_prop *prop)
 {
-	int oldlen;
-	unsigned int *plen;
-	unsigned char *pvalue;
-	void *point;
-	int ret;
+	unsigned int *cell = (unsigned int *)p;
+	unsigned int len = prop->len;
 
-	plen = (unsigned int *)of_dt_struct_offset(blob, property_offset + 4);
-	pvalue = (unsigned char *)of_dt_struct_offset(blob,
-						property_offset + 12);
-	point = (void *)pvalue;
+	cell[0] = swap_uint32(OF_DT_TOKEN_PROP);
+	cell[1] = swap_uint32(len);
+	cell[2] = swap_uint32(prop->nameoffset);
+	p += 12;
 
-	/* get the old len of value */
-	oldlen = swap_uint32(*plen);
+	memcpy(p, prop->value, len);
+	memset(p + len, 0, OF_ALIGN(len) - len);
 
-	ret = of_blob_move_dt_struct(blob, point,
-			OF_ALIGN(oldlen), OF_ALIGN(valuelen));
-	if (ret)
-		return ret;
+	return p + OF_ALIGN(len);
+}
 
-	/* set the new len and value */
-	*plen = swap_uint32(valuelen);
-	memcpy(pvalue, value, valuelen);
+static unsigned char *of_fixup_put_props(unsigned char *p, int node, int all)
+{
+	int i;
 
-	return 0;
+	for (i = 0; i < of_fixup_num_props; i++) {
+		if ((of_fixup_props[i].node == node)
+			&& (all || (of_fixup_props[i].offset < 0)))
+			p = of_fixup_put_prop(p, &of_fixup_props[i]);
+	}
+
+	return p;
 }
 
-static int of_set_property(void *blob,
-				int nodeoffset,
-				char *property_name,
-				void *value,
-				int valuelen)
+static unsigned char *of_fixup_put_node(unsigned char *p, int node)
 {
-	int property_offset;
-	int ret;
+	struct of_fixup_node *n = &of_fixup_nodes[node];
+	int i;
 
-	/* If find the property name in the dt blob, update its value,
-	 * else to add this property
-	 */
-	ret = of_get_property_offset_by_name(blob, nodeoffset,
-					property_name, &property_offset);
-	if (ret) {
-		ret = of_add_property(blob, nodeoffset,
-				property_name, value, valuelen);
-		if (ret)
-			dbg_info("DT: fail to add property\n");
+	*(unsigned int *)p = swap_uint32(OF_DT_TOKEN_NODE_BEGIN);
+	p += 4;
+	memcpy(p, n->name, n->namelen);
+	memset(p + n->namelen, 0, OF_ALIGN(n->namelen + 1) - n->namelen);
+	p += OF_ALIGN(n->namelen + 1);
+
+	p = of_fixup_put_props(p, node, 1);
+
+	for (i = 0; i < of_fixup_num_nodes; i++) {
+		if (of_fixup_nodes[i].parent == node)
+			p = of_fixup_put_node(p, i);
+	}
+
+	*(unsigned int *)p = swap_uint32(OF_DT_TOKEN_NODE_END);
+
+	return p + 4;
+}
+
+static void of_fixup_put_strings(unsigned char *p, unsigned int stringslen)
+{
+	struct of_fixup_prop *prop;
+	int i;
+
+	for (i = 0; i < of_fixup_num_props; i++) {
+		prop = &of_fixup_props[i];
+		if (prop->nameoffset >= (int)stringslen)
+			memcpy(p + prop->nameoffset - stringslen,
+				prop->name, strlen(prop->name) + 1);
+	}
+}
+
+/*
+ * Each stretch of the blob between two edits moves by the size change
+ * of the edits before it. The stretches moving down are moved first,
+ * from the start, then the ones moving up, from the end: none of them
+ * is overwritten before it is moved.
+ */
+static void of_fixup_move(void *blob, unsigned int datasize)
+{
+	struct of_fixup_edit *edit;
+	unsigned int start, end;
+	int shift = 0;
+	int i;
+
+	for (i = 0; i < of_fixup_num_edits; i++) {
+		edit = &of_fixup_edits[i];
+		shift += (int)edit->newsize - (int)edit->oldsize;
+		edit->shift = shift;
+	}
+
+	for (i = 0; i < of_fixup_num_edits; i++) {
+		edit = &of_fixup_edits[i];
+		start = edit->offset + edit->oldsize;
+		end = (i + 1 < of_fixup_num_edits) ?
+				of_fixup_edits[i + 1].offset : datasize;
+		if (edit->shift < 0)
+			memmove((char *)blob + start + edit->shift,
+				(char *)blob + start, end - start);
+	}
+
+	for (i = of_fixup_num_edits - 1; i >= 0; i--) {
+		edit = &of_fixup_edits[i];
+		start = edit->offset + edit->oldsize;
+		end = (i + 1 < of_fixup_num_edits) ?
+				of_fixup_edits[i + 1].offset : datasize;
+		if (edit->shift > 0)
+			memmove((char *)blob + start + edit->shift,
+				(char *)blob + start, end - start);
+	}
+}
+
+static void of_fixup_reset(void)
+{
+	of_fixup_num_nodes = 0;
+	of_fixup_num_props = 0;
+	of_fixup_num_edits = 0;
+}
+
+/* Applies the queued fixups to the blob, which may grow in place */
+int of_fixup_apply(void *blob)
+{
+	unsigned int datasize = of_blob_data_size(blob);
+	unsigned int stringsoffset = of_get_offset_dt_strings(blob);
+	unsigned int stringslen = of_get_dt_strings_len(blob);
+	struct of_fixup_edit *edit;
+	unsigned char *p;
+	unsigned int added;
+	int structdelta = 0;
+	int i;
+
+	for (i = 0; i < of_fixup_num_props; i++) {
+		of_fixup_props[i].offset = -1;
+		of_fixup_props[i].nameoffset = -1;
+	}
+
+	if (of_fixup_scan_struct(blob)) {
+		dbg_info("DT: bad structure block\n");
+		goto fail;
+	}
+
+	added = of_fixup_scan_strings(blob);
 
-		return ret;
+	if (of_fixup_build_edits(blob, added)) {
+		dbg_info("DT: too many fixups\n");
+		goto fail;
 	}
 
-	ret = of_update_property_value(blob, property_offset, value, valuelen);
-	if (ret) {
-		dbg_info("DT: fail to update property\n");
-		return ret;
+	of_fixup_move(blob, datasize);
+
+	for (i = 0; i < of_fixup_num_edits; i++) {
+		edit = &of_fixup_edits[i];
+		p = (unsigned char *)blob + edit->offset + edit->shift
+			- ((int)edit->newsize - (int)edit->oldsize);
+
+		switch (edit->type) {
+		case OF_EDIT_PROPS:
+			of_fixup_put_props(p, edit->index, 0);
+			break;
+		case OF_EDIT_NODE:
+			of_fixup_put_node(p, edit->index);
+			break;
+		case OF_EDIT_PROP:
+			of_fixup_put_prop(p, &of_fixup_props[edit->index]);
+			break;
+		default:
+			of_fixup_put_strings(p, stringslen);
+			continue;
+		}
+
+		structdelta += (int)edit->newsize - (int)edit->oldsize;
 	}
 
+	/* the strings block follows the structure block */
+	of_set_dt_struct_len(blob, of_get_dt_struct_len(blob) + structdelta);
+	of_set_offset_dt_strings(blob, stringsoffset + structdelta);
+	of_set_dt_strings_len(blob, stringslen + added);
+
+	datasize = of_blob_data_size(blob);
+	if (datasize > of_get_dt_total_size(blob))
+		of_set_dt_total_size(blob, datasize);
+
+	of_fixup_reset();
+
 	return 0;
+
+fail:
+	of_fixup_reset();
+
+	return -1;
 }
 
 /* ---------------------------------------------------- */
@@ -559,30 +1036,43 @@ int check_dt_blob_valid(void *blob)
  * property "bootargs": This zero-terminated string is passed
  * as the kernel command line.
  */
-int fixup_chosen_node(void *blob, char *bootargs)
+int fixup_chosen_node(char *bootargs)
 {
-	int nodeoffset;
-	char *value = bootargs;
-	int valuelen = strlen(value) + 1;
-	int ret;
+	return of_fixup_property("/chosen", "bootargs",
+				bootargs, strlen(bootargs) + 1);
+}
 
-	ret = of_get_node_offset(blob, "chosen", &nodeoffset);
-	if (ret) {
-		dbg_info("DT: doesn't support add node\n");
-		return ret;
-	}
+/* The /chosen node
+ * properties "linux,initrd-start" and "linux,initrd-end": the physical
+ * addresses of the initrd loaded by the bootloader.
+ */
+int fixup_chosen_initrd(unsigned int start, unsigned int end)
+{
+	unsigned int value;
 
-	/*
-	 * if the property doesn't exit, add it
-	 * if the property exists, update it.
-	 */
-	ret = of_set_property(blob, nodeoffset, "bootargs", value, valuelen);
-	if (ret) {
-		dbg_info("fail to set bootargs property\n");
-		return ret;
-	}
+	value = swap_uint32(start);
+	if (of_fixup_property("/chosen", "linux,initrd-start",
+				&value, sizeof(value)))
+		return -1;
 
-	return 0;
+	value = swap_uint32(end);
+	return of_fixup_property("/chosen", "linux,initrd-end",
+				&value, sizeof(value));
+}
+
+/* The /chosen node
+ * property "atmel,boot-trace": the base and the size of the boot trace
+ * the bootloader leaves in the memory, one cell each.
+ */
+int fixup_chosen_boot_trace(unsigned int base, unsigned int size)
+{
+	unsigned int data[2];
+
+	data[0] = swap_uint32(base);
+	data[1] = swap_uint32(size);
+
+	return of_fixup_property("/chosen", "atmel,boot-trace",
+				data, sizeof(data));
 }
 
 /* The /memory node
@@ -590,43 +1080,609 @@ int fixup_chosen_node(void *blob, char *bootargs)
  * - device_type: has to be "memory".
  * - reg: this property contains all the physical memory ranges of your boards.
  */
-int fixup_memory_node(void *blob,
-			unsigned int *mem_bank,
-			unsigned int *mem_size)
+int fixup_memory_node(unsigned int *mem_bank, unsigned int *mem_size)
 {
-	int nodeoffset;
 	unsigned int data[2];
-	int valuelen;
-	int ret;
 
-	ret = of_get_node_offset(blob, "memory", &nodeoffset);
-	if (ret) {
-		dbg_info("DT: doesn't support add node\n");
-		return ret;
+	if (of_fixup_property("/memory", "device_type",
+				"memory", sizeof("memory")))
+		return -1;
+
+	data[0] = swap_uint32(*mem_bank);
+	data[1] = swap_uint32(*mem_size);
+
+	return of_fixup_property("/memory", "reg", data, sizeof(data));
+}
+
+/* Writes the value in hexadecimal, with "digits" digits at least */
+static char *of_put_hex(char *p, unsigned int value, int digits)
+{
+	int shift;
+
+	for (shift = 28; shift >= 0; shift -= 4) {
+		if ((shift >= digits * 4) && !(value >> shift))
+			continue;
+
+		*p++ = "0123456789abcdef"[(value >> shift) & 0xf];
+		digits = 8;
 	}
+	*p = '\0';
 
-	/*
-	 * if the property doesn't exit, add it
-	 * if the property exists, update it.
-	 */
-	/* set "device_type" property */
-	ret = of_set_property(blob, nodeoffset,
-			"device_type", "memory", sizeof("memory"));
-	if (ret) {
-		dbg_info("DT: could not set device_type property\n");
-		return ret;
+	return p;
+}
+
+/* The root node
+ * property "serial-number": the serial number of the board, as a
+ * string, the way Linux shows the ATAG one in /proc/cpuinfo.
+ * property "atmel,board-revision": the revision of the board.
+ */
+int fixup_board_info(unsigned int sn, unsigned int rev)
+{
+	static char serial[17];
+	unsigned int value;
+
+	of_put_hex(of_put_hex(serial, 0, 8), sn, 8);
+	if (of_fixup_property("/", "serial-number", serial, sizeof(serial)))
+		return -1;
+
+	value = swap_uint32(rev);
+	return of_fixup_property("/", "atmel,board-revision",
+				&value, sizeof(value));
+}
+
+/* The ethernet node
+ * property "local-mac-address": the MAC address the bootloader gives.
+ */
+int fixup_mac_address(const char *path, const unsigned char *mac)
+{
+	return of_fixup_property(path, "local-mac-address", mac, 6);
+}
+
+/* The value of the "#address-cells" or "#size-cells" property of a node */
+static unsigned int of_get_cells(void *blob, int node,
+				const char *name, unsigned int def)
+{
+	unsigned int *p;
+	int len;
+
+	p = of_get_property(blob, node, name, &len);
+	if (!p || (len != 4))
+		return def;
+
+	return swap_uint32(*p);
+}
+
+/* The /reserved-memory node
+ * A "no-map" subnode "name@base" keeps the region out of the kernel.
+ * The node the blob has keeps its cells and ranges, the reg of the
+ * subnode is encoded with them. Otherwise the node is created, with the
+ * addresses and the sizes one cell each.
+ */
+int fixup_reserved_memory(void *blob,
+			const char *name,
+			unsigned int base,
+			unsigned int size)
+{
+	char path[OF_FIXUP_NAME_SIZE + sizeof("/reserved-memory/")];
+	unsigned int address_cells = 1, size_cells = 1;
+	unsigned int cell, data[4];
+	unsigned int len = 0;
+	int node;
+	char *p;
+
+	if (strlen(name) + 10 > OF_FIXUP_NAME_SIZE)
+		return -1;
+
+	p = path;
+	memcpy(p, "/reserved-memory/", sizeof("/reserved-memory/") - 1);
+	p += sizeof("/reserved-memory/") - 1;
+	memcpy(p, name, strlen(name));
+	p += strlen(name);
+	*p++ = '@';
+	of_put_hex(p, base, 1);
+
+	if (of_get_node_offset(blob, "reserved-memory", &node) == 0) {
+		/* the defaults of the specification */
+		address_cells = of_get_cells(blob, node, "#address-cells", 2);
+		size_cells = of_get_cells(blob, node, "#size-cells", 1);
+		if ((address_cells < 1) || (address_cells > 2)
+			|| (size_cells < 1) || (size_cells > 2)) {
+			dbg_info("DT: /reserved-memory cells not supported\n");
+			return -1;
+		}
+	} else {
+		cell = swap_uint32(1);
+		if (of_fixup_property("/reserved-memory", "#address-cells",
+					&cell, sizeof(cell))
+			|| of_fixup_property("/reserved-memory", "#size-cells",
+					&cell, sizeof(cell))
+			|| of_fixup_property("/reserved-memory", "ranges", 0, 0))
+			return -1;
 	}
 
-	/* set "reg" property */
-	valuelen = 8;
-	data[0] = swap_uint32(*mem_bank);
-	data[1] = swap_uint32(*mem_size);
+	/* the high cells are zero, the addresses are 32-bit */
+	if (address_cells == 2)
+		data[len++] = 0;
+	data[len++] = swap_uint32(base);
+	if (size_cells == 2)
+		data[len++] = 0;
+	data[len++] = swap_uint32(size);
+
+	if (of_fixup_property(path, "reg", data, len * sizeof(data[0])))
+		return -1;
+
+	return of_fixup_property(path, "no-map", 0, 0);
+}
+
+#ifdef CONFIG_OF_OVERLAY
+
+/* -------------------------------------------------------- */
+
+/*
+ * The device tree overlays, as "dtc -@" builds them from a "/plugin/;"
+ * source: fragments with a target and an "__overlay__" node, the
+ * "__fixups__" of the references to the labels of the base blob, and
+ * the "__local_fixups__" of the references inside the overlay. The base
+ * blob needs the "__symbols__" node "dtc -@" adds for its labels.
+ *
+ * The overlay is fixed up in place, then merged into the base blob
+ * through the fixup queue, which is applied whenever it may be full.
+ */
+#define OF_OVERLAY_PATH_SIZE	128
+
+static unsigned int of_get_cell(const unsigned char *p)
+{
+	return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static void of_set_cell(unsigned char *p, unsigned int value)
+{
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+/* The name, the value and the length of the property at "offset" */
+static char *of_get_property_at(void *blob, int offset,
+				unsigned char **value, int *len)
+{
+	unsigned int *p = (unsigned int *)of_dt_struct_offset(blob, offset);
+
+	*len = swap_uint32(p[1]);
+	*value = (unsigned char *)&p[3];
+
+	return of_get_string_by_offset(blob, swap_uint32(p[2]));
+}
+
+static int of_is_phandle(const char *name)
+{
+	return (strcmp(name, "phandle") == 0)
+		|| (strcmp(name, "linux,phandle") == 0);
+}
+
+static int of_get_root_offset(void *blob, int *offset)
+{
+	unsigned int token;
+
+	if (of_get_token_nextoffset(blob, 0, offset, &token)
+		|| (token != OF_DT_TOKEN_NODE_BEGIN))
+		return -1;
+
+	return 0;
+}
 
-	ret = of_set_property(blob, nodeoffset, "reg", data, valuelen);
-	if (ret) {
-		dbg_info("DT: could not set reg property\n");
-		return ret;
+/* The node of a full path, as "/ahb/apb/i2c@f0014000" */
+static int of_get_path_offset(void *blob, const char *path, int *offset)
+{
+	char name[OF_FIXUP_NAME_SIZE];
+	const char *p;
+	int node;
+
+	if ((*path != '/') || of_get_root_offset(blob, &node))
+		return -1;
+
+	while (1) {
+		while (*path == '/')
+			path++;
+		if (*path == '\0')
+			break;
+
+		for (p = path; (*p != '\0') && (*p != '/'); p++)
+			;
+		if (p - path >= OF_FIXUP_NAME_SIZE)
+			return -1;
+
+		memcpy(name, path, p - path);
+		name[p - path] = '\0';
+		if (of_get_subnode_offset(blob, node, name, &node))
+			return -1;
+
+		path = p;
 	}
 
+	*offset = node;
+
 	return 0;
 }
+
+/* Adds "delta" to each phandle, returns the largest one */
+static unsigned int of_shift_phandles(void *blob, unsigned int delta)
+{
+	unsigned int token, phandle, max = 0;
+	unsigned char *value;
+	int offset = 0;
+	int nextoffset;
+	int len;
+
+	while (of_get_token_nextoffset(blob, offset, &nextoffset, &token) == 0) {
+		if (token == OF_DT_END)
+			break;
+
+		if ((token == OF_DT_TOKEN_PROP)
+			&& of_is_phandle(of_get_property_at(blob, offset,
+							&value, &len))
+			&& (len == 4)) {
+			phandle = of_get_cell(value) + delta;
+			of_set_cell(value, phandle);
+			if (phandle > max)
+				max = phandle;
+		}
+
+		offset = nextoffset;
+	}
+
+	return max;
+}
+
+/* The path of the node with this phandle */
+static int of_get_phandle_path(void *blob, unsigned int phandle,
+				char *path, int size)
+{
+	char *names[OF_FIXUP_MAX_DEPTH];
+	unsigned int token;
+	unsigned char *value;
+	int depth = -1;
+	int offset = 0;
+	int nextoffset;
+	int len, i;
+
+	while (of_get_token_nextoffset(blob, offset, &nextoffset, &token) == 0) {
+		if (token == OF_DT_END)
+			break;
+
+		if (token == OF_DT_TOKEN_NODE_BEGIN) {
+			if (++depth >= OF_FIXUP_MAX_DEPTH)
+				return -1;
+			names[depth] = (char *)of_dt_struct_offset(blob,
+								offset + 4);
+		} else if (token == OF_DT_TOKEN_NODE_END) {
+			depth--;
+		} else if ((token == OF_DT_TOKEN_PROP)
+			&& of_is_phandle(of_get_property_at(blob, offset,
+							&value, &len))
+			&& (len == 4) && (of_get_cell(value) == phandle)) {
+			strcpy(path, "/");
+			for (i = 1; i <= depth; i++) {
+				if (strlen(path) + strlen(names[i]) + 2 > size)
+					return -1;
+				if (i > 1)
+					strcat(path, "/");
+				strcat(path, names[i]);
+			}
+			return 0;
+		}
+
+		offset = nextoffset;
+	}
+
+	return -1;
+}
+
+/*
+ * The "__local_fixups__" node mirrors the overlay: each of its
+ * properties lists the offsets of the phandle cells in the property of
+ * the same name of the overlay node.
+ */
+static int of_overlay_local_fixups(void *overlay, int fixups,
+				int node, unsigned int delta)
+{
+	unsigned char *offsets, *value;
+	unsigned int token;
+	char *name;
+	int nextoffset;
+	int depth = 0;
+	int subnode;
+	int len, count, i;
+
+	while (1) {
+		if (of_get_token_nextoffset(overlay, fixups,
+						&nextoffset, &token))
+			return -1;
+
+		if (token == OF_DT_TOKEN_NODE_BEGIN) {
+			name = (char *)of_dt_struct_offset(overlay, fixups + 4);
+			if ((depth == 0)
+				&& (of_get_subnode_offset(overlay, node,
+							name, &subnode)
+				|| of_overlay_local_fixups(overlay, nextoffset,
+							subnode, delta)))
+				return -1;
+			depth++;
+		} else if (token == OF_DT_TOKEN_NODE_END) {
+			if (depth == 0)
+				return 0;
+			depth--;
+		} else if ((token == OF_DT_TOKEN_PROP) && (depth == 0)) {
+			name = of_get_property_at(overlay, fixups,
+							&offsets, &count);
+			value = of_get_property(overlay, node, name, &len);
+			if (!value)
+				return -1;
+
+			for (i = 0; i + 4 <= count; i += 4) {
+				if (of_get_cell(offsets + i) + 4 > len)
+					return -1;
+				value += of_get_cell(offsets + i);
+				of_set_cell(value, of_get_cell(value) + delta);
+				value -= of_get_cell(offsets + i);
+			}
+		} else if (token == OF_DT_END) {
+			return -1;
+		}
+
+		fixups = nextoffset;
+	}
+}
+
+/*
+ * Each property of the "__fixups__" node is a label of the base blob,
+ * with the list of the "path:property:offset" cells to set to the
+ * phandle of its node.
+ */
+static int of_overlay_fixups(void *blob, void *overlay, int fixups)
+{
+	char path[OF_OVERLAY_PATH_SIZE];
+	char prop[OF_FIXUP_NAME_SIZE];
+	unsigned char *list, *value;
+	unsigned int phandle, token;
+	char *label, *target, *p, *end;
+	int symbols, node;
+	int nextoffset;
+	int len, count;
+	unsigned int offset;
+
+	if (of_get_path_offset(blob, "/__symbols__", &symbols)) {
+		dbg_info("DT: overlay: The base blob has no __symbols__\n");
+		return -1;
+	}
+
+	while (1) {
+		if (of_get_token_nextoffset(overlay, fixups,
+						&nextoffset, &token))
+			return -1;
+
+		if (token != OF_DT_TOKEN_PROP)
+			break;
+
+		label = of_get_property_at(overlay, fixups, &list, &count);
+
+		target = of_get_property(blob, symbols, label, NULL);
+		if (!target || of_get_path_offset(blob, target, &node)) {
+			dbg_info("DT: overlay: No symbol %s\n", label);
+			return -1;
+		}
+
+		value = of_get_property(blob, node, "phandle", &len);
+		if (!value)
+			value = of_get_property(blob, node,
+						"linux,phandle", &len);
+		if (!value || (len != 4)) {
+			dbg_info("DT: overlay: %s has no phandle\n", label);
+			return -1;
+		}
+		phandle = of_get_cell(value);
+
+		for (p = (char *)list; p < (char *)list + count;
+		     p += strlen(p) + 1) {
+			/* path:property:offset */
+			end = strchr(p, ':');
+			if (!end || (end - p >= OF_OVERLAY_PATH_SIZE))
+				return -1;
+			memcpy(path, p, end - p);
+			path[end - p] = '\0';
+
+			p = end + 1;
+			end = strchr(p, ':');
+			if (!end || (end - p >= OF_FIXUP_NAME_SIZE))
+				return -1;
+			memcpy(prop, p, end - p);
+			prop[end - p] = '\0';
+
+			for (offset = 0, p = end + 1;
+			     (*p >= '0') && (*p <= '9'); p++)
+				offset = offset * 10 + (*p - '0');
+
+			if (of_get_path_offset(overlay, path, &node))
+				return -1;
+
+			value = of_get_property(overlay, node, prop, &len);
+			if (!value || (offset + 4 > len))
+				return -1;
+
+			of_set_cell(value + offset, phandle);
+		}
+
+		fixups = nextoffset;
+	}
+
+	return (token == OF_DT_TOKEN_NODE_END) ? 0 : -1;
+}
+
+/* Queues a node or a property, the queue is applied if it may be full */
+static int of_overlay_queue(void *blob, const char *path,
+				const char *name, const void *value, int len)
+{
+	int depth = 1;
+	const char *p;
+
+	for (p = path; *p != '\0'; p++) {
+		if (*p == '/')
+			depth++;
+	}
+
+	if ((of_fixup_num_nodes + depth > OF_FIXUP_MAX_NODES)
+		|| (of_fixup_num_props == OF_FIXUP_MAX_PROPS)) {
+		if (of_fixup_apply(blob))
+			return -1;
+	}
+
+	if (!name)
+		return of_fixup_node(path);
+
+	return of_fixup_property(path, name, value, len);
+}
+
+/* Merges the overlay node at "node" into the node "path" of the blob */
+static int of_overlay_merge(void *blob, void *overlay, int node,
+				char *path, int pathlen)
+{
+	unsigned char *value;
+	unsigned int token;
+	char *name;
+	int nextoffset;
+	int depth = 0;
+	int len;
+
+	while (1) {
+		if (of_get_token_nextoffset(overlay, node,
+						&nextoffset, &token))
+			return -1;
+
+		if (token == OF_DT_TOKEN_NODE_BEGIN) {
+			if (depth == 0) {
+				name = (char *)of_dt_struct_offset(overlay,
+								node + 4);
+				len = pathlen;
+				if (len + strlen(name) + 2 > OF_OVERLAY_PATH_SIZE)
+					return -1;
+				if (len > 1)
+					path[len++] = '/';
+				strcpy(path + len, name);
+
+				if (of_overlay_queue(blob, path, NULL, NULL, 0)
+					|| of_overlay_merge(blob, overlay,
+						nextoffset, path,
+						len + strlen(name)))
+					return -1;
+
+				path[pathlen] = '\0';
+			}
+			depth++;
+		} else if (token == OF_DT_TOKEN_NODE_END) {
+			if (depth == 0)
+				return 0;
+			depth--;
+		} else if ((token == OF_DT_TOKEN_PROP) && (depth == 0)) {
+			name = of_get_property_at(overlay, node, &value, &len);
+			if (of_overlay_queue(blob, path, name, value, len))
+				return -1;
+		} else if (token == OF_DT_END) {
+			return -1;
+		}
+
+		node = nextoffset;
+	}
+}
+
+/*
+ * Applies the overlay to the blob, which grows in place by about the
+ * size of the overlay. The overlay is changed too. On error, a part of
+ * the overlay may have been applied.
+ */
+int of_overlay_apply(void *blob, void *overlay)
+{
+	char path[OF_OVERLAY_PATH_SIZE];
+	unsigned char *value;
+	unsigned int token, delta;
+	char *name, *target;
+	int root, node, fixups, fragment;
+	int nextoffset;
+	int depth = 0;
+	int len;
+
+	if (check_dt_blob_valid(overlay)
+		|| of_get_root_offset(overlay, &root)) {
+		dbg_info("DT: overlay: Not a valid fdt\n");
+		return -1;
+	}
+
+	/* the phandles of the overlay go after the ones of the blob */
+	delta = of_shift_phandles(blob, 0);
+	of_shift_phandles(overlay, delta);
+
+	if ((of_get_subnode_offset(overlay, root, "__local_fixups__",
+							&fixups) == 0)
+		&& of_overlay_local_fixups(overlay, fixups, root, delta)) {
+		dbg_info("DT: overlay: Bad __local_fixups__\n");
+		return -1;
+	}
+
+	if ((of_get_subnode_offset(overlay, root, "__fixups__", &fixups) == 0)
+		&& of_overlay_fixups(blob, overlay, fixups)) {
+		dbg_info("DT: overlay: Bad __fixups__\n");
+		return -1;
+	}
+
+	/* the fragments */
+	for (node = root; ; node = nextoffset) {
+		if (of_get_token_nextoffset(overlay, node,
+						&nextoffset, &token))
+			return -1;
+
+		if (token == OF_DT_TOKEN_NODE_END) {
+			if (depth-- == 0)
+				break;
+			continue;
+		}
+
+		if (token != OF_DT_TOKEN_NODE_BEGIN)
+			continue;
+
+		if (depth++ != 0)
+			continue;
+
+		name = (char *)of_dt_struct_offset(overlay, node + 4);
+		if ((memcmp(name, "__", 2) == 0)
+			|| of_get_subnode_offset(overlay, nextoffset,
+						"__overlay__", &fragment))
+			continue;
+
+		target = of_get_property(overlay, nextoffset,
+						"target-path", &len);
+		if (target) {
+			if (len > OF_OVERLAY_PATH_SIZE)
+				return -1;
+			strcpy(path, target);
+		} else {
+			value = of_get_property(overlay, nextoffset,
+						"target", &len);
+			if (!value || (len != 4)
+				|| of_get_phandle_path(blob, of_get_cell(value),
+						path, sizeof(path))) {
+				dbg_info("DT: overlay: %s: No target\n", name);
+				return -1;
+			}
+		}
+
+		if (of_overlay_merge(blob, overlay, fragment,
+					path, strlen(path))) {
+			dbg_info("DT: overlay: %s: Failed to apply\n", name);
+			of_fixup_reset();
+			return -1;
+		}
+	}
+
+	return of_fixup_apply(blob);
+}
+#endif /* #ifdef CONFIG_OF_OVERLAY */
@@ -0,0 +1,648 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "common.h"
+#include "board.h"
+#include "string.h"
+#include "fdt.h"
+#include "fit.h"
+#include "debug.h"
+
+#ifdef CONFIG_FIT_VERIFY
+#include "crc32.h"
+#include "sha256.h"
+#endif
+
+#ifdef CONFIG_LOAD_HW_INFO
+#include "board_hw_info.h"
+#endif
+
+/*
+ * A FIT (Flattened Image Tree) image is a device tree blob which holds
+ * the kernel, the DT blobs and the ramdisk in its "/images" node, and
+ * the sets of them to boot together in its "/configurations" node. The
+ * image data is either inside the blob ("data"), or follows it on the
+ * media ("data-offset" or "data-position", mkimage -E).
+ */
+#define FIT_KERNEL		0
+#define FIT_FDT			1
+#define FIT_RAMDISK		2
+#define FIT_IMAGE_COUNT		3
+
+#ifdef CONFIG_OF_OVERLAY
+/* the overlays follow the images, the DT blob has room to grow */
+#define FIT_OVERLAY		FIT_IMAGE_COUNT
+#define FIT_MAX_OVERLAYS	4
+#define FIT_PART_COUNT		(FIT_IMAGE_COUNT + FIT_MAX_OVERLAYS)
+#define FIT_FDT_SPACE		0x1000
+#else
+#define FIT_PART_COUNT		FIT_IMAGE_COUNT
+#endif
+
+#define FIT_HASH_NONE		0
+#define FIT_HASH_CRC32		1
+#define FIT_HASH_SHA256		2
+
+static const char *fit_image_types[FIT_IMAGE_COUNT] = {
+	"kernel", "fdt", "ramdisk",
+};
+
+struct fit_part {
+	struct fit_image	image;
+	const char		*name;	/* the image type */
+	int			used;
+	int			has_load;
+	int			external;
+	unsigned int		offset;	/* external data, from the FIT start */
+	unsigned int		dest;
+#ifdef CONFIG_FIT_VERIFY
+	int			hash;
+	unsigned int		crc;
+	unsigned char		sha256[SHA256_DIGEST_SIZE];
+#endif
+};
+
+static struct fit_image fit_kernel;
+static struct fit_image fit_ramdisk;
+
+#ifdef CONFIG_FIT_VERIFY
+static struct sha256_ctx fit_sha256;
+#endif
+
+static int fit_get_u32(void *fit, int node,
+			const char *name, unsigned int *value)
+{
+	unsigned int *p;
+	int len;
+
+	p = of_get_property(fit, node, name, &len);
+	if (!p || (len < 4))
+		return -1;
+
+	/* the last cell, the addresses may have two */
+	*value = swap_uint32(p[len / 4 - 1]);
+
+	return 0;
+}
+
+static int fit_get_comp(void *fit, int node, unsigned int *comp)
+{
+	char *p;
+
+	p = of_get_property(fit, node, "compression", NULL);
+	if (!p || (strcmp(p, "none") == 0))
+		*comp = FIT_COMP_NONE;
+	else if (strcmp(p, "gzip") == 0)
+		*comp = FIT_COMP_GZIP;
+	else if (strcmp(p, "lz4") == 0)
+		*comp = FIT_COMP_LZ4;
+	else {
+		dbg_info("FIT: Compression %s not supported\n", p);
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_FIT_VERIFY
+static void fit_parse_hash(void *fit, int node, struct fit_part *part)
+{
+	int hash;
+	char *algo;
+	unsigned int *value;
+	int len;
+
+	if (of_get_subnode_offset(fit, node, "hash-1", &hash)
+		&& of_get_subnode_offset(fit, node, "hash@1", &hash))
+		return;
+
+	algo = of_get_property(fit, hash, "algo", NULL);
+	value = of_get_property(fit, hash, "value", &len);
+	if (!algo || !value)
+		return;
+
+	if ((strcmp(algo, "crc32") == 0) && (len == 4)) {
+		part->hash = FIT_HASH_CRC32;
+		part->crc = swap_uint32(*value);
+	} else if ((strcmp(algo, "sha256") == 0)
+			&& (len == SHA256_DIGEST_SIZE)) {
+		part->hash = FIT_HASH_SHA256;
+		memcpy(part->sha256, value, SHA256_DIGEST_SIZE);
+	} else {
+		dbg_info("FIT: %s: %s hash not supported\n", part->name, algo);
+	}
+}
+
+/*
+ * On the SAMA5 parts, the sha256 hash runs on the SHA peripheral, fed by
+ * the DMA where it can, and goes on in the background until the check.
+ * There is one at a time.
+ */
+static void fit_hash_start(struct fit_part *part)
+{
+	if (part->hash == FIT_HASH_SHA256) {
+		sha256_starts(&fit_sha256);
+		sha256_update(&fit_sha256, (void *)part->image.data,
+						part->image.size);
+	}
+}
+
+static int fit_hash_check(struct fit_part *part)
+{
+	unsigned char digest[SHA256_DIGEST_SIZE];
+	unsigned int crc;
+
+	if (part->hash == FIT_HASH_CRC32) {
+		crc = crc32(0, (unsigned char *)part->image.data,
+						part->image.size);
+		if (crc != part->crc) {
+			dbg_info("FIT: %s: Bad crc32: %d, expected: %d\n",
+					part->name, crc, part->crc);
+			return -1;
+		}
+	} else if (part->hash == FIT_HASH_SHA256) {
+		if (sha256_finish(&fit_sha256, digest)
+			|| memcmp(digest, part->sha256, SHA256_DIGEST_SIZE)) {
+			dbg_info("FIT: %s: Bad sha256\n", part->name);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+/*
+ * The configuration named after the DT blob of the board, as in
+ * "sama5d36ek", else the default one.
+ */
+static int fit_select_conf(void *fit, int *conf)
+{
+	int confs;
+	char *name;
+#ifdef CONFIG_LOAD_HW_INFO
+	char board_name[FILENAME_BUF_LEN];
+	unsigned int len;
+#endif
+
+	if (of_get_node_offset(fit, "configurations", &confs)) {
+		dbg_info("FIT: No configurations\n");
+		return -1;
+	}
+
+#ifdef CONFIG_LOAD_HW_INFO
+	memset(board_name, 0, sizeof(board_name));
+	at91_board_set_dtb_name(board_name);
+
+	len = strlen(board_name);
+	if ((len > 4) && (strcmp(board_name + len - 4, ".dtb") == 0))
+		board_name[len - 4] = '\0';
+
+	if (of_get_subnode_offset(fit, confs, board_name, conf) == 0) {
+		dbg_info("FIT: Using configuration %s\n", board_name);
+		return 0;
+	}
+#endif
+
+	name = of_get_property(fit, confs, "default", NULL);
+	if (!name || of_get_subnode_offset(fit, confs, name, conf)) {
+		dbg_info("FIT: No default configuration\n");
+		return -1;
+	}
+
+	dbg_info("FIT: Using configuration %s\n", name);
+
+	return 0;
+}
+
+static int fit_parse_image(void *fit, unsigned int fit_size, int images,
+				char *node_name, struct fit_part *part)
+{
+	unsigned int *data;
+	unsigned int value;
+	int node;
+	int len;
+
+	if (of_get_subnode_offset(fit, images, node_name, &node)) {
+		dbg_info("FIT: Image %s not found\n", node_name);
+		return -1;
+	}
+
+	data = of_get_property(fit, node, "data", &len);
+	if (data) {
+		part->image.data = (unsigned int)data;
+		part->image.size = len;
+	} else {
+		if (fit_get_u32(fit, node, "data-size", &part->image.size)) {
+			dbg_info("FIT: %s: No data\n", part->name);
+			return -1;
+		}
+
+		if (fit_get_u32(fit, node, "data-position", &value) == 0)
+			part->offset = value;
+		else if (fit_get_u32(fit, node, "data-offset", &value) == 0)
+			part->offset = OF_ALIGN(fit_size) + value;
+		else {
+			dbg_info("FIT: %s: No data offset\n", part->name);
+			return -1;
+		}
+
+		part->external = 1;
+	}
+
+	if (fit_get_u32(fit, node, "load", &part->image.load) == 0)
+		part->has_load = 1;
+
+	if (fit_get_u32(fit, node, "entry", &part->image.entry))
+		part->image.entry = part->image.load;
+
+	if (fit_get_comp(fit, node, &part->image.comp))
+		return -1;
+
+#ifdef CONFIG_FIT_VERIFY
+	fit_parse_hash(fit, node, part);
+#endif
+	part->used = 1;
+
+	return 0;
+}
+
+#ifdef CONFIG_OF_OVERLAY
+static int fit_add_overlay(void *fit, unsigned int fit_size, int images,
+				char *node_name, struct fit_part *parts)
+{
+	struct fit_part *part;
+	int i;
+
+	for (i = FIT_OVERLAY; i < FIT_PART_COUNT; i++) {
+		part = &parts[i];
+		if (!part->used)
+			break;
+	}
+
+	if (i == FIT_PART_COUNT) {
+		dbg_info("FIT: Too many overlays\n");
+		return -1;
+	}
+
+	dbg_info("FIT: Overlay %s\n", node_name);
+
+	part->name = "overlay";
+
+	return fit_parse_image(fit, fit_size, images, node_name, part);
+}
+
+/*
+ * The overlays are the DT blobs after the first one in the "fdt" list of
+ * the configuration, then the ones named after the detected boards, in
+ * lower case, as "sama5d3x-dm".
+ */
+static int fit_parse_overlays(void *fit, unsigned int fit_size,
+				int images, int conf, struct fit_part *parts)
+{
+	char *list;
+	int len;
+	int i;
+#ifdef CONFIG_LOAD_HW_INFO
+	char name[FILENAME_BUF_LEN];
+	char *boards[3];
+	int node;
+	int j;
+#endif
+
+	list = of_get_property(fit, conf, "fdt", &len);
+	for (i = strlen(list) + 1; i < len; i += strlen(list + i) + 1) {
+		if (fit_add_overlay(fit, fit_size, images, list + i, parts))
+			return -1;
+	}
+
+#ifdef CONFIG_LOAD_HW_INFO
+	boards[0] = get_cm_name();
+	boards[1] = get_dm_name();
+	boards[2] = get_ek_name();
+
+	for (i = 0; i < 3; i++) {
+		if (!boards[i] || (strlen(boards[i]) >= sizeof(name)))
+			continue;
+
+		for (j = 0; boards[i][j] != '\0'; j++) {
+			name[j] = boards[i][j];
+			if ((name[j] >= 'A') && (name[j] <= 'Z'))
+				name[j] += 'a' - 'A';
+		}
+		name[j] = '\0';
+
+		if (of_get_subnode_offset(fit, images, name, &node))
+			continue;
+
+		/* not twice, if the configuration lists it already */
+		for (j = strlen(list) + 1; j < len; j += strlen(list + j) + 1) {
+			if (strcmp(list + j, name) == 0)
+				break;
+		}
+
+		if ((j >= len)
+			&& fit_add_overlay(fit, fit_size, images, name, parts))
+			return -1;
+	}
+#endif
+
+	return 0;
+}
+
+/* Behind the DT blob, which grows in place by about their sizes */
+static int fit_place_overlays(struct fit_part *parts)
+{
+	struct fit_part *fdt = &parts[FIT_FDT];
+	unsigned int dest;
+	int i;
+
+	dest = fdt->dest + OF_ALIGN(fdt->image.size) + FIT_FDT_SPACE;
+	for (i = FIT_OVERLAY; i < FIT_PART_COUNT; i++) {
+		if (parts[i].used)
+			dest += OF_ALIGN(parts[i].image.size);
+	}
+
+	for (i = FIT_OVERLAY; i < FIT_PART_COUNT; i++) {
+		if (!parts[i].used)
+			continue;
+
+		if (parts[i].image.comp != FIT_COMP_NONE) {
+			dbg_info("FIT: overlay: Compression not supported\n");
+			return -1;
+		}
+
+		if (parts[i].has_load) {
+			parts[i].dest = parts[i].image.load;
+		} else {
+			parts[i].dest = dest;
+			dest += OF_ALIGN(parts[i].image.size);
+		}
+	}
+
+	return 0;
+}
+#endif
+
+static int fit_overlap(unsigned int a, unsigned int a_size,
+			unsigned int b, unsigned int b_size)
+{
+	return (a < b + b_size) && (b < a + a_size);
+}
+
+/* Where each image goes, none of them may overwrite another */
+static int fit_place(struct image_info *image, void *fit,
+			unsigned int fit_size, struct fit_part *parts)
+{
+	struct fit_part *kernel = &parts[FIT_KERNEL];
+	struct fit_part *fdt = &parts[FIT_FDT];
+	struct fit_part *ramdisk = &parts[FIT_RAMDISK];
+	int i, j;
+
+	if (kernel->image.comp == FIT_COMP_NONE) {
+		if (!kernel->has_load) {
+			dbg_info("FIT: kernel: No load address\n");
+			return -1;
+		}
+		kernel->dest = kernel->image.load;
+	} else {
+		/* decompressed from behind the blob, or in the blob */
+		if (kernel->external)
+			kernel->dest = (unsigned int)fit + OF_ALIGN(fit_size);
+		else
+			kernel->dest = kernel->image.data;
+	}
+
+	if (fdt->image.comp != FIT_COMP_NONE) {
+		dbg_info("FIT: fdt: Compression not supported\n");
+		return -1;
+	}
+	fdt->dest = fdt->has_load ? fdt->image.load
+				: (unsigned int)image->of_dest;
+
+#ifdef CONFIG_OF_OVERLAY
+	if (fit_place_overlays(parts))
+		return -1;
+#endif
+
+	if (ramdisk->used) {
+		if (!ramdisk->has_load
+			|| (ramdisk->image.comp != FIT_COMP_NONE)) {
+			dbg_info("FIT: ramdisk: Needs a load address, "
+					"and no compression\n");
+			return -1;
+		}
+		ramdisk->dest = ramdisk->image.load;
+	}
+
+	for (i = 0; i < FIT_PART_COUNT; i++) {
+		if (!parts[i].used)
+			continue;
+
+		/* the data in the blob is copied before the blob goes */
+		if (!parts[i].external
+			&& (parts[i].dest != parts[i].image.data)
+			&& fit_overlap(parts[i].dest, parts[i].image.size,
+					(unsigned int)fit, fit_size)) {
+			dbg_info("FIT: %s: Overlaps the FIT image\n",
+							parts[i].name);
+			return -1;
+		}
+
+		for (j = i + 1; j < FIT_PART_COUNT; j++) {
+			if (parts[j].used
+				&& fit_overlap(parts[i].dest,
+						parts[i].image.size,
+						parts[j].dest,
+						parts[j].image.size)) {
+				dbg_info("FIT: %s overlaps %s\n",
+					parts[i].name, parts[j].name);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* Only the header may be there yet, a FIT image is a DT blob */
+int fit_check_header(void *fit)
+{
+	return check_dt_blob_valid(fit) ? -1 : 0;
+}
+
+/*
+ * The first page of the FIT image is at image->dest. The images of the
+ * selected configuration are read to their load addresses, the ones
+ * behind the blob in the order they are on the media.
+ */
+int fit_load(struct image_info *image, fit_read_function read, void *priv)
+{
+	void *fit = image->dest;
+	unsigned int fit_size = of_get_dt_total_size(fit);
+	struct fit_part parts[FIT_PART_COUNT];
+	struct fit_part *order[FIT_PART_COUNT];
+	struct fit_part *part;
+#ifdef CONFIG_FIT_VERIFY
+	struct fit_part *hashing = NULL;
+#endif
+	char *node_name;
+	int count = 0;
+	int images, conf;
+	int i, j;
+
+	dbg_info("FIT: Read %d bytes of FIT image to %d\n",
+			fit_size, (unsigned int)fit);
+
+	if (read(priv, 0, fit_size, fit))
+		return -1;
+
+	if (fit_select_conf(fit, &conf))
+		return -1;
+
+	if (of_get_node_offset(fit, "images", &images))
+		return -1;
+
+	memset(parts, 0, sizeof(parts));
+
+	for (i = 0; i < FIT_IMAGE_COUNT; i++) {
+		parts[i].name = fit_image_types[i];
+
+		/* the first one of a list, the others are overlays */
+		node_name = of_get_property(fit, conf, parts[i].name, NULL);
+		if (!node_name) {
+			if (i == FIT_RAMDISK)
+				continue;
+
+			dbg_info("FIT: No %s in the configuration\n",
+							parts[i].name);
+			return -1;
+		}
+
+		if (fit_parse_image(fit, fit_size, images,
+					node_name, &parts[i]))
+			return -1;
+	}
+
+#ifdef CONFIG_OF_OVERLAY
+	if (fit_parse_overlays(fit, fit_size, images, conf, parts))
+		return -1;
+#endif
+
+	if (fit_place(image, fit, fit_size, parts))
+		return -1;
+
+	/* the data in the blob first, then sweep the media once */
+	for (i = 0; i < FIT_PART_COUNT; i++) {
+		part = &parts[i];
+		if (!part->used)
+			continue;
+
+		if (part->external) {
+			for (j = count; (j > 0)
+				&& (order[j - 1]->offset > part->offset); j--)
+				order[j] = order[j - 1];
+			order[j] = part;
+			count++;
+			continue;
+		}
+
+		if (part->dest != part->image.data) {
+			dbg_info("FIT: %s: Copy %d bytes to %d\n",
+				part->name, part->image.size, part->dest);
+
+			memcpy((void *)part->dest,
+				(void *)part->image.data, part->image.size);
+			part->image.data = part->dest;
+		}
+
+#ifdef CONFIG_FIT_VERIFY
+		fit_hash_start(part);
+		if (fit_hash_check(part))
+			return -1;
+#endif
+	}
+
+	for (i = 0; i < count; i++) {
+		part = order[i];
+
+		dbg_info("FIT: %s: Read %d bytes from %d to %d\n",
+			part->name, part->image.size,
+			part->offset, part->dest);
+
+		if (read(priv, part->offset, part->image.size,
+					(unsigned char *)part->dest))
+			return -1;
+
+		part->image.data = part->dest;
+
+#ifdef CONFIG_FIT_VERIFY
+		/* the previous one was hashed while this one was read */
+		if (hashing && fit_hash_check(hashing))
+			return -1;
+
+		fit_hash_start(part);
+		hashing = part;
+#endif
+	}
+
+#ifdef CONFIG_FIT_VERIFY
+	if (hashing && fit_hash_check(hashing))
+		return -1;
+#endif
+
+#ifdef CONFIG_OF_OVERLAY
+	for (i = FIT_OVERLAY; i < FIT_PART_COUNT; i++) {
+		if (!parts[i].used)
+			continue;
+
+		dbg_info("FIT: Apply the overlay at %d\n", parts[i].image.data);
+
+		if (of_overlay_apply((void *)parts[FIT_FDT].image.data,
+					(void *)parts[i].image.data))
+			return -1;
+	}
+#endif
+
+	fit_kernel = parts[FIT_KERNEL].image;
+	if (parts[FIT_RAMDISK].used)
+		fit_ramdisk = parts[FIT_RAMDISK].image;
+
+	image->of_dest = (unsigned char *)parts[FIT_FDT].image.data;
+
+	return 0;
+}
+
+struct fit_image *fit_get_kernel(void)
+{
+	return fit_kernel.size ? &fit_kernel : NULL;
+}
+
+struct fit_image *fit_get_ramdisk(void)
+{
+	return fit_ramdisk.size ? &fit_ramdisk : NULL;
+}
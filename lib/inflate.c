@@ -0,0 +1,523 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "decompress.h"
+
+/*
+ * Deflate (RFC 1951) decoder in the gzip (RFC 1952) container.
+ * The input comes chunk by chunk from a stream, the whole output
+ * buffer is in memory, so the back references are copied straight
+ * from the output buffer and no sliding window is needed.
+ */
+#define MAXBITS		15	/* maximum bits in a code */
+#define MAXLCODES	286	/* maximum number of literal/length codes */
+#define MAXDCODES	30	/* maximum number of distance codes */
+#define MAXCODES	(MAXLCODES + MAXDCODES)
+#define FIXLCODES	288	/* number of fixed literal/length codes */
+
+struct inflate_state {
+	struct decomp_stream	*in;
+	unsigned int		bitbuf;
+	unsigned int		bitcnt;
+
+	unsigned char		*out;
+	unsigned int		out_max;
+	unsigned int		out_pos;
+};
+
+struct huffman {
+	unsigned short	count[MAXBITS + 1];	/* codes of each length */
+	unsigned short	symbol[FIXLCODES];	/* symbols by code order */
+};
+
+static struct huffman lencode;
+static struct huffman distcode;
+
+static const unsigned short length_base[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const unsigned char length_extra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const unsigned short dist_base[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577
+};
+
+static const unsigned char dist_extra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* order of the code length code lengths */
+static const unsigned char clen_order[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static int getbits(struct inflate_state *s, unsigned int need)
+{
+	unsigned int val = s->bitbuf;
+	int byte;
+
+	while (s->bitcnt < need) {
+		byte = stream_byte(s->in);
+		if (byte < 0)
+			return byte;
+
+		val |= (unsigned int)byte << s->bitcnt;
+		s->bitcnt += 8;
+	}
+
+	s->bitbuf = val >> need;
+	s->bitcnt -= need;
+
+	return (int)(val & ((1UL << need) - 1));
+}
+
+static int stored(struct inflate_state *s)
+{
+	unsigned int len, nlen;
+	int ret;
+
+	/* discard the leftover bits up to the byte boundary */
+	s->bitbuf = 0;
+	s->bitcnt = 0;
+
+	ret = getbits(s, 16);
+	if (ret < 0)
+		return ret;
+	len = ret;
+
+	ret = getbits(s, 16);
+	if (ret < 0)
+		return ret;
+	nlen = ret;
+
+	if (len != (~nlen & 0xffff))
+		return ERROR_DECOMP_DATA;
+
+	if (s->out_pos + len > s->out_max)
+		return ERROR_DECOMP_OVERFLOW;
+
+	ret = stream_copy(s->in, s->out + s->out_pos, len);
+	if (ret)
+		return ret;
+
+	s->out_pos += len;
+
+	return 0;
+}
+
+/* Decode one symbol, reading the code one bit at a time */
+static int decode(struct inflate_state *s, const struct huffman *h)
+{
+	int code = 0;	/* bits read so far */
+	int first = 0;	/* first code of the current length */
+	int index = 0;	/* index of the first code of the length */
+	unsigned int len;
+	int count;
+	int bit;
+
+	for (len = 1; len <= MAXBITS; len++) {
+		bit = getbits(s, 1);
+		if (bit < 0)
+			return bit;
+
+		code |= bit;
+		count = h->count[len];
+		if (code - count < first)
+			return h->symbol[index + (code - first)];
+
+		index += count;
+		first += count;
+		first <<= 1;
+		code <<= 1;
+	}
+
+	return ERROR_DECOMP_DATA;
+}
+
+/*
+ * Build the canonical code from the code lengths. Incomplete codes
+ * are accepted, as zlib does for a single distance code.
+ */
+static int construct(struct huffman *h, const unsigned char *length,
+			unsigned int n)
+{
+	unsigned short offs[MAXBITS + 1];
+	unsigned int symbol;
+	unsigned int len;
+	int left;
+
+	for (len = 0; len <= MAXBITS; len++)
+		h->count[len] = 0;
+
+	for (symbol = 0; symbol < n; symbol++)
+		h->count[length[symbol]]++;
+
+	if (h->count[0] == n)
+		return 0;
+
+	left = 1;
+	for (len = 1; len <= MAXBITS; len++) {
+		left <<= 1;
+		left -= h->count[len];
+		if (left < 0)
+			return ERROR_DECOMP_DATA;	/* over-subscribed */
+	}
+
+	offs[1] = 0;
+	for (len = 1; len < MAXBITS; len++)
+		offs[len + 1] = offs[len] + h->count[len];
+
+	for (symbol = 0; symbol < n; symbol++)
+		if (length[symbol] != 0)
+			h->symbol[offs[length[symbol]]++] = symbol;
+
+	return left;
+}
+
+static int codes(struct inflate_state *s)
+{
+	unsigned int len, dist;
+	unsigned char *from;
+	int symbol;
+	int ret;
+
+	do {
+		symbol = decode(s, &lencode);
+		if (symbol < 0)
+			return symbol;
+
+		if (symbol < 256) {
+			if (s->out_pos >= s->out_max)
+				return ERROR_DECOMP_OVERFLOW;
+
+			s->out[s->out_pos++] = symbol;
+
+		} else if (symbol > 256) {
+			symbol -= 257;
+			if (symbol >= 29)
+				return ERROR_DECOMP_DATA;
+
+			ret = getbits(s, length_extra[symbol]);
+			if (ret < 0)
+				return ret;
+			len = length_base[symbol] + ret;
+
+			symbol = decode(s, &distcode);
+			if (symbol < 0)
+				return symbol;
+			if (symbol >= 30)
+				return ERROR_DECOMP_DATA;
+
+			ret = getbits(s, dist_extra[symbol]);
+			if (ret < 0)
+				return ret;
+			dist = dist_base[symbol] + ret;
+
+			if (dist > s->out_pos)
+				return ERROR_DECOMP_DATA;
+
+			if (s->out_pos + len > s->out_max)
+				return ERROR_DECOMP_OVERFLOW;
+
+			/* the areas may overlap, copy byte by byte */
+			from = s->out + s->out_pos - dist;
+			while (len--)
+				s->out[s->out_pos++] = *from++;
+		}
+	} while (symbol != 256);
+
+	return 0;
+}
+
+static int fixed(struct inflate_state *s)
+{
+	unsigned char lengths[FIXLCODES];
+	unsigned int symbol;
+
+	for (symbol = 0; symbol < 144; symbol++)
+		lengths[symbol] = 8;
+	for (; symbol < 256; symbol++)
+		lengths[symbol] = 9;
+	for (; symbol < 280; symbol++)
+		lengths[symbol] = 7;
+	for (; symbol < FIXLCODES; symbol++)
+		lengths[symbol] = 8;
+	construct(&lencode, lengths, FIXLCODES);
+
+	for (symbol = 0; symbol < MAXDCODES; symbol++)
+		lengths[symbol] = 5;
+	construct(&distcode, lengths, MAXDCODES);
+
+	return codes(s);
+}
+
+static int dynamic(struct inflate_state *s)
+{
+	unsigned char lengths[MAXCODES];
+	unsigned int nlen, ndist, ncode;
+	unsigned int index;
+	unsigned int len;
+	int symbol;
+	int ret;
+
+	ret = getbits(s, 5);
+	if (ret < 0)
+		return ret;
+	nlen = ret + 257;
+
+	ret = getbits(s, 5);
+	if (ret < 0)
+		return ret;
+	ndist = ret + 1;
+
+	ret = getbits(s, 4);
+	if (ret < 0)
+		return ret;
+	ncode = ret + 4;
+
+	if ((nlen > MAXLCODES) || (ndist > MAXDCODES))
+		return ERROR_DECOMP_DATA;
+
+	for (index = 0; index < ncode; index++) {
+		ret = getbits(s, 3);
+		if (ret < 0)
+			return ret;
+		lengths[clen_order[index]] = ret;
+	}
+	for (; index < 19; index++)
+		lengths[clen_order[index]] = 0;
+
+	/* the code length code must be complete */
+	if (construct(&lencode, lengths, 19) != 0)
+		return ERROR_DECOMP_DATA;
+
+	index = 0;
+	while (index < nlen + ndist) {
+		symbol = decode(s, &lencode);
+		if (symbol < 0)
+			return symbol;
+
+		if (symbol < 16) {
+			lengths[index++] = symbol;
+			continue;
+		}
+
+		len = 0;
+		if (symbol == 16) {
+			if (index == 0)
+				return ERROR_DECOMP_DATA;
+			len = lengths[index - 1];
+			ret = getbits(s, 2);
+			symbol = 3 + ret;
+		} else if (symbol == 17) {
+			ret = getbits(s, 3);
+			symbol = 3 + ret;
+		} else {
+			ret = getbits(s, 7);
+			symbol = 11 + ret;
+		}
+		if (ret < 0)
+			return ret;
+
+		if (index + symbol > nlen + ndist)
+			return ERROR_DECOMP_DATA;
+
+		while (symbol--)
+			lengths[index++] = len;
+	}
+
+	if (lengths[256] == 0)
+		return ERROR_DECOMP_DATA;
+
+	/* incomplete codes are only allowed for a single length */
+	ret = construct(&lencode, lengths, nlen);
+	if ((ret < 0) || ((ret > 0) && (nlen - lencode.count[0] != 1)))
+		return ERROR_DECOMP_DATA;
+
+	ret = construct(&distcode, lengths + nlen, ndist);
+	if ((ret < 0) || ((ret > 0) && (ndist - distcode.count[0] != 1)))
+		return ERROR_DECOMP_DATA;
+
+	return codes(s);
+}
+
+static int inflate(struct inflate_state *s)
+{
+	int last, type;
+	int ret;
+
+	do {
+		last = getbits(s, 1);
+		if (last < 0)
+			return last;
+
+		type = getbits(s, 2);
+		if (type < 0)
+			return type;
+
+		if (type == 0)
+			ret = stored(s);
+		else if (type == 1)
+			ret = fixed(s);
+		else if (type == 2)
+			ret = dynamic(s);
+		else
+			ret = ERROR_DECOMP_DATA;
+
+		if (ret)
+			return ret;
+	} while (!last);
+
+	return 0;
+}
+
+/* gzip header flags */
+#define GZIP_METHOD_DEFLATE	8
+#define GZIP_FLAG_FHCRC		0x02
+#define GZIP_FLAG_FEXTRA	0x04
+#define GZIP_FLAG_FNAME		0x08
+#define GZIP_FLAG_FCOMMENT	0x10
+#define GZIP_HEADER_SIZE	10
+
+static int gzip_skip_string(struct decomp_stream *stream)
+{
+	int byte;
+
+	do {
+		byte = stream_byte(stream);
+		if (byte < 0)
+			return byte;
+	} while (byte);
+
+	return 0;
+}
+
+static int gzip_le(struct decomp_stream *stream, unsigned int bytes,
+			unsigned int *val)
+{
+	unsigned int shift;
+	int byte;
+
+	*val = 0;
+	for (shift = 0; shift < bytes * 8; shift += 8) {
+		byte = stream_byte(stream);
+		if (byte < 0)
+			return byte;
+		*val |= (unsigned int)byte << shift;
+	}
+
+	return 0;
+}
+
+int gunzip_stream(struct decomp_stream *stream,
+			unsigned char *dst, unsigned int dst_max)
+{
+	struct inflate_state state;
+	unsigned char header[GZIP_HEADER_SIZE];
+	unsigned int val;
+	int ret;
+
+	ret = stream_copy(stream, header, GZIP_HEADER_SIZE);
+	if (ret)
+		return ERROR_DECOMP_FORMAT;
+
+	if (((header[0] | (header[1] << 8)) != GZIP_MAGIC)
+		|| (header[2] != GZIP_METHOD_DEFLATE))
+		return ERROR_DECOMP_FORMAT;
+
+	if (header[3] & GZIP_FLAG_FEXTRA) {
+		ret = gzip_le(stream, 2, &val);
+		if (ret == 0)
+			ret = stream_copy(stream, 0, val);
+		if (ret)
+			return ret;
+	}
+
+	if (header[3] & GZIP_FLAG_FNAME) {
+		ret = gzip_skip_string(stream);
+		if (ret)
+			return ret;
+	}
+
+	if (header[3] & GZIP_FLAG_FCOMMENT) {
+		ret = gzip_skip_string(stream);
+		if (ret)
+			return ret;
+	}
+
+	if (header[3] & GZIP_FLAG_FHCRC) {
+		ret = stream_copy(stream, 0, 2);
+		if (ret)
+			return ret;
+	}
+
+	state.in = stream;
+	state.bitbuf = 0;
+	state.bitcnt = 0;
+	state.out = dst;
+	state.out_max = dst_max;
+	state.out_pos = 0;
+
+	ret = inflate(&state);
+	if (ret)
+		return ret;
+
+	/*
+	 * The trailer follows the last byte of the deflate stream,
+	 * it holds the CRC32 and the size modulo 2^32.
+	 */
+	ret = gzip_le(stream, 4, &val);
+	if (ret == 0)
+		ret = gzip_le(stream, 4, &val);
+	if (ret)
+		return ret;
+
+	if (val != state.out_pos)
+		return ERROR_DECOMP_DATA;
+
+	return (int)state.out_pos;
+}
+
+int gunzip(const unsigned char *src, unsigned int src_len,
+		unsigned char *dst, unsigned int dst_max)
+{
+	struct decomp_stream stream;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.buf = src;
+	stream.len = src_len;
+
+	return gunzip_stream(&stream, dst, dst_max);
+}
@@ -8,4 +8,10 @@ COBJS-y		+= $(LIB)/eabi_utils.o
 COBJS-y		+= $(LIB)/div.o
 
 COBJS-$(CONFIG_CRC32)	+= $(LIB)/crc32.o
+COBJS-$(CONFIG_SHA256_SW)	+= $(LIB)/sha256.o
+COBJS-$(CONFIG_AES_SW)	+= $(LIB)/aes.o
 COBJS-$(CONFIG_OF_LIBFDT) += $(LIB)/fdt.o
+COBJS-$(CONFIG_FIT) += $(LIB)/fit.o
+COBJS-$(CONFIG_LOAD_MANIFEST) += $(LIB)/manifest.o
+COBJS-$(CONFIG_KERNEL_GZIP) += $(LIB)/inflate.o
+COBJS-$(CONFIG_KERNEL_LZ4) += $(LIB)/lz4.o
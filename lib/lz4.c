@@ -0,0 +1,338 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "decompress.h"
+
+/*
+ * LZ4 decoder for both the frame format (lz4, U-Boot's mkimage -C lz4)
+ * and the legacy format used by the Linux kernel (lz4 -l). The input
+ * comes chunk by chunk from a stream, the output is one contiguous
+ * buffer, so the matches of dependent blocks can reach back into the
+ * previous blocks.
+ */
+#define LZ4_MIN_MATCH		4
+#define LZ4_SKIPPABLE_MAGIC	0x184d2a50	/* 0x184d2a50 - 0x184d2a5f */
+
+/* frame descriptor FLG byte */
+#define LZ4_FLG_VERSION_MASK	0xc0
+#define LZ4_FLG_VERSION		0x40
+#define LZ4_FLG_BLOCK_CHECKSUM	0x10
+#define LZ4_FLG_CONTENT_SIZE	0x08
+#define LZ4_FLG_CONTENT_CHECKSUM	0x04
+#define LZ4_FLG_DICT_ID		0x01
+
+#define LZ4_BLOCK_UNCOMPRESSED	0x80000000
+
+/* Little endian word, 1 if the stream ended before it, or an error */
+static int get_le32(struct decomp_stream *stream, unsigned int *val)
+{
+	unsigned int shift;
+	int byte;
+
+	*val = 0;
+	for (shift = 0; shift < 32; shift += 8) {
+		if ((shift == 0) && (stream->pos == stream->len)) {
+			if (!stream->fill)
+				return 1;
+
+			byte = stream_refill(stream);
+			if (byte == ERROR_DECOMP_READ)
+				return byte;
+			if (byte)
+				return 1;
+		}
+
+		byte = stream_byte(stream);
+		if (byte < 0)
+			return byte;
+		*val |= (unsigned int)byte << shift;
+	}
+
+	return 0;
+}
+
+/* Literal or match length extension, "left" counts the block bytes */
+static int lz4_length(struct decomp_stream *stream, unsigned int *len,
+			unsigned int *left)
+{
+	int byte;
+
+	do {
+		if (*left == 0)
+			return ERROR_DECOMP_DATA;
+
+		byte = stream_byte(stream);
+		if (byte < 0)
+			return byte;
+		(*left)--;
+
+		*len += byte;
+	} while (byte == 255);
+
+	return 0;
+}
+
+static int lz4_block(struct decomp_stream *stream, unsigned int left,
+			unsigned char *dst, unsigned int dst_pos,
+			unsigned int dst_max)
+{
+	unsigned char *op = dst + dst_pos;
+	unsigned char *oend = dst + dst_max;
+	unsigned char *match;
+	unsigned int token;
+	unsigned int len;
+	unsigned int offset;
+	int byte;
+	int ret;
+
+	while (left) {
+		byte = stream_byte(stream);
+		if (byte < 0)
+			return byte;
+		left--;
+		token = byte;
+
+		len = token >> 4;
+		if (len == 15) {
+			ret = lz4_length(stream, &len, &left);
+			if (ret)
+				return ret;
+		}
+
+		if (len > left)
+			return ERROR_DECOMP_DATA;
+		if (len > (unsigned int)(oend - op))
+			return ERROR_DECOMP_OVERFLOW;
+
+		ret = stream_copy(stream, op, len);
+		if (ret)
+			return ret;
+		op += len;
+		left -= len;
+
+		/* the last sequence has literals only */
+		if (left == 0)
+			break;
+
+		if (left < 2)
+			return ERROR_DECOMP_DATA;
+
+		byte = stream_byte(stream);
+		if (byte < 0)
+			return byte;
+		offset = byte;
+
+		byte = stream_byte(stream);
+		if (byte < 0)
+			return byte;
+		offset |= byte << 8;
+		left -= 2;
+
+		if ((offset == 0) || (offset > (unsigned int)(op - dst)))
+			return ERROR_DECOMP_DATA;
+
+		len = token & 0x0f;
+		if (len == 15) {
+			ret = lz4_length(stream, &len, &left);
+			if (ret)
+				return ret;
+		}
+		len += LZ4_MIN_MATCH;
+
+		if (len > (unsigned int)(oend - op))
+			return ERROR_DECOMP_OVERFLOW;
+
+		/* the match may overlap the output, copy byte by byte */
+		match = op - offset;
+		while (len--)
+			*op++ = *match++;
+	}
+
+	return op - (dst + dst_pos);
+}
+
+static int lz4_legacy(struct decomp_stream *stream,
+			unsigned char *dst, unsigned int dst_max)
+{
+	unsigned int out = 0;
+	unsigned int size;
+	int ret;
+
+	for (;;) {
+		ret = get_le32(stream, &size);
+		if (ret < 0)
+			return ret;
+		if (ret)
+			break;
+
+		/* concatenated streams repeat the magic */
+		if (size == LZ4_LEGACY_MAGIC)
+			continue;
+
+		/*
+		 * The legacy format has no end mark, the kernel build
+		 * appends the decompressed size to the stream.
+		 */
+		if (size == out)
+			break;
+
+		ret = lz4_block(stream, size, dst, out, dst_max);
+		if (ret < 0)
+			return ret;
+
+		out += ret;
+	}
+
+	return (int)out;
+}
+
+/* "magic" is the already read magic word of the first frame */
+static int lz4_frame(struct decomp_stream *stream, unsigned int magic,
+			unsigned char *dst, unsigned int dst_max)
+{
+	unsigned int out = 0;
+	unsigned int frames = 0;
+	unsigned int size;
+	int flg;
+	int ret;
+
+	for (;;) {
+		if (frames) {
+			ret = get_le32(stream, &magic);
+			if (ret < 0)
+				return ret;
+			if (ret)
+				break;
+		}
+
+		if ((magic & 0xfffffff0) == LZ4_SKIPPABLE_MAGIC) {
+			ret = get_le32(stream, &size);
+			if (ret == 0)
+				ret = stream_copy(stream, 0, size);
+			if (ret)
+				return ERROR_DECOMP_FORMAT;
+			frames++;
+			continue;
+		}
+
+		/* whatever follows the last frame is not part of the stream */
+		if (magic != LZ4_FRAME_MAGIC) {
+			if (frames)
+				break;
+			return ERROR_DECOMP_FORMAT;
+		}
+
+		flg = stream_byte(stream);
+		if (flg < 0)
+			return flg;
+
+		if (((flg & LZ4_FLG_VERSION_MASK) != LZ4_FLG_VERSION)
+			|| (flg & LZ4_FLG_DICT_ID))
+			return ERROR_DECOMP_FORMAT;
+
+		/* BD, optional content size, HC */
+		ret = stream_copy(stream, 0,
+			(flg & LZ4_FLG_CONTENT_SIZE) ? 10 : 2);
+		if (ret)
+			return ret;
+
+		for (;;) {
+			ret = get_le32(stream, &size);
+			if (ret)
+				return (ret < 0) ? ret : ERROR_DECOMP_DATA;
+
+			/* EndMark */
+			if (size == 0)
+				break;
+
+			if (size & LZ4_BLOCK_UNCOMPRESSED) {
+				size &= ~LZ4_BLOCK_UNCOMPRESSED;
+				if (size > dst_max - out)
+					return ERROR_DECOMP_OVERFLOW;
+
+				ret = stream_copy(stream, dst + out, size);
+				if (ret)
+					return ret;
+				ret = size;
+			} else {
+				ret = lz4_block(stream, size,
+						dst, out, dst_max);
+				if (ret < 0)
+					return ret;
+			}
+
+			out += ret;
+
+			if (flg & LZ4_FLG_BLOCK_CHECKSUM) {
+				ret = stream_copy(stream, 0, 4);
+				if (ret)
+					return ret;
+			}
+		}
+
+		if (flg & LZ4_FLG_CONTENT_CHECKSUM) {
+			ret = stream_copy(stream, 0, 4);
+			if (ret)
+				return ret;
+		}
+
+		frames++;
+	}
+
+	return (int)out;
+}
+
+int lz4_stream(struct decomp_stream *stream,
+		unsigned char *dst, unsigned int dst_max)
+{
+	unsigned int magic;
+	int ret;
+
+	ret = get_le32(stream, &magic);
+	if (ret)
+		return ERROR_DECOMP_FORMAT;
+
+	if (magic == LZ4_LEGACY_MAGIC)
+		return lz4_legacy(stream, dst, dst_max);
+
+	if (magic == LZ4_FRAME_MAGIC)
+		return lz4_frame(stream, magic, dst, dst_max);
+
+	return ERROR_DECOMP_FORMAT;
+}
+
+int lz4_decompress(const unsigned char *src, unsigned int src_len,
+			unsigned char *dst, unsigned int dst_max)
+{
+	struct decomp_stream stream;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.buf = src;
+	stream.len = src_len;
+
+	return lz4_stream(&stream, dst, dst_max);
+}
@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "common.h"
+#include "string.h"
+#include "manifest.h"
+#include "profile.h"
+#include "debug.h"
+
+static const char *image_names[] = {
+	"image", "dt blob", "initrd",
+};
+
+/*
+ * A manifest lists the images a media loads, each one from its offset
+ * to its RAM address. They are read in the order of their offsets, the
+ * media is swept once whatever the order they are added in.
+ */
+void manifest_init(struct load_manifest *manifest, const char *media)
+{
+	memset(manifest, 0, sizeof(*manifest));
+	manifest->media = media;
+}
+
+/*
+ * Returns the entry, for its source or verify step to be set, or NULL
+ * if the manifest is full, which fails manifest_load().
+ */
+struct load_entry *manifest_add(struct load_manifest *manifest,
+				unsigned int type,
+				unsigned int offset,
+				unsigned char *dest,
+				unsigned int *length,
+				int (*get_length)(unsigned char *))
+{
+	struct load_entry *entry;
+
+	if (manifest->count == MANIFEST_MAX_ENTRIES) {
+		dbg_info("%s: %s: Too many images to load\n",
+				manifest->media, image_names[type]);
+		manifest->overflow = 1;
+		return NULL;
+	}
+
+	entry = &manifest->entries[manifest->count++];
+	entry->type = type;
+	entry->offset = offset;
+	entry->dest = dest;
+	entry->length = length;
+	entry->get_length = get_length;
+
+	return entry;
+}
+
+/*
+ * An image without a length is read a "unit" first, the media read
+ * size, for its header to tell the length, then the rest after it.
+ */
+static int manifest_load_entry(struct load_manifest *manifest,
+				struct load_entry *entry,
+				manifest_read_function read,
+				void *priv,
+				unsigned int unit)
+{
+	unsigned int length = *entry->length;
+	unsigned int head = 0;
+	int ret;
+
+	if (entry->source)
+		priv = entry->source;
+
+	if ((length == 0) && entry->get_length) {
+		if (read(priv, entry->offset, unit, entry->dest))
+			return -1;
+
+		ret = entry->get_length(entry->dest);
+		if (ret < 0)
+			return -1;
+
+		length = ret;
+		*entry->length = length;
+
+		head = (unit < length) ? unit : length;
+	}
+
+	dbg_info("%s: %s: Copy %d bytes from %d to %d\n",
+			manifest->media, image_names[entry->type], length,
+			entry->offset, (unsigned int)entry->dest);
+
+	if ((length > head) && read(priv, entry->offset + head,
+					length - head, entry->dest + head))
+		return -1;
+
+	if (entry->verify && entry->verify(entry->dest, length))
+		return -1;
+
+	profile_mark(image_names[entry->type]);
+
+	return 0;
+}
+
+int manifest_load(struct load_manifest *manifest,
+		manifest_read_function read,
+		void *priv,
+		unsigned int unit)
+{
+	struct load_entry *order[MANIFEST_MAX_ENTRIES];
+	struct load_entry *entry;
+	int i, j;
+
+	if (manifest->overflow)
+		return -1;
+
+	for (i = 0; i < manifest->count; i++) {
+		entry = &manifest->entries[i];
+
+		for (j = i; (j > 0) && (order[j - 1]->offset > entry->offset);
+									j--)
+			order[j] = order[j - 1];
+		order[j] = entry;
+	}
+
+	for (i = 0; i < manifest->count; i++) {
+		entry = order[i];
+
+		if (manifest_load_entry(manifest, entry, read, priv, unit)) {
+			dbg_info("%s: %s: Read error\n", manifest->media,
+						image_names[entry->type]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
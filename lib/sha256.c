@@ -0,0 +1,179 @@
+/* ----------------------------------------------------------------------------
+ *         ATMEL Microcontroller Software Support
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "string.h"
+#include "sha256.h"
+
+/* SHA-256 as in FIPS 180-4, for the parts without the SHA peripheral */
+static const unsigned int sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROR(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+#define S0(x)		(ROR(x, 2) ^ ROR(x, 13) ^ ROR(x, 22))
+#define S1(x)		(ROR(x, 6) ^ ROR(x, 11) ^ ROR(x, 25))
+#define s0(x)		(ROR(x, 7) ^ ROR(x, 18) ^ ((x) >> 3))
+#define s1(x)		(ROR(x, 17) ^ ROR(x, 19) ^ ((x) >> 10))
+
+static void sha256_block(unsigned int *state, const unsigned char *p)
+{
+	unsigned int w[16];
+	unsigned int a, b, c, d, e, f, g, h;
+	unsigned int t1, t2;
+	unsigned int i;
+
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+	e = state[4];
+	f = state[5];
+	g = state[6];
+	h = state[7];
+
+	for (i = 0; i < 64; i++) {
+		/* the message schedule, in a ring of 16 words */
+		if (i < 16) {
+			w[i] = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+			p += 4;
+		} else {
+			w[i & 15] += s1(w[(i - 2) & 15]) + w[(i - 7) & 15]
+					+ s0(w[(i - 15) & 15]);
+		}
+
+		t1 = h + S1(e) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i & 15];
+		t2 = S0(a) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+void sha256_starts(struct sha256_ctx *ctx)
+{
+	ctx->state[0] = 0x6a09e667;
+	ctx->state[1] = 0xbb67ae85;
+	ctx->state[2] = 0x3c6ef372;
+	ctx->state[3] = 0xa54ff53a;
+	ctx->state[4] = 0x510e527f;
+	ctx->state[5] = 0x9b05688c;
+	ctx->state[6] = 0x1f83d9ab;
+	ctx->state[7] = 0x5be0cd19;
+	ctx->count = 0;
+	ctx->used = 0;
+	ctx->error = 0;
+}
+
+void sha256_update(struct sha256_ctx *ctx, const void *data, unsigned int len)
+{
+	unsigned char *block = (unsigned char *)ctx->block;
+	const unsigned char *p = data;
+	unsigned int n;
+
+	ctx->count += len;
+
+	if (ctx->used) {
+		n = SHA256_BLOCK_SIZE - ctx->used;
+		if (n > len)
+			n = len;
+		memcpy(block + ctx->used, p, n);
+		ctx->used += n;
+		p += n;
+		len -= n;
+
+		if (ctx->used < SHA256_BLOCK_SIZE)
+			return;
+
+		sha256_block(ctx->state, block);
+		ctx->used = 0;
+	}
+
+	for (; len >= SHA256_BLOCK_SIZE; len -= SHA256_BLOCK_SIZE) {
+		sha256_block(ctx->state, p);
+		p += SHA256_BLOCK_SIZE;
+	}
+
+	memcpy(block, p, len);
+	ctx->used = len;
+}
+
+int sha256_finish(struct sha256_ctx *ctx, unsigned char *digest)
+{
+	unsigned char *block = (unsigned char *)ctx->block;
+	unsigned int bits_hi = ctx->count >> 29;
+	unsigned int bits_lo = ctx->count << 3;
+	unsigned int i;
+
+	/* 0x80, zeroes, then the big endian bit count */
+	block[ctx->used++] = 0x80;
+	if (ctx->used > SHA256_BLOCK_SIZE - 8) {
+		memset(block + ctx->used, 0, SHA256_BLOCK_SIZE - ctx->used);
+		sha256_block(ctx->state, block);
+		ctx->used = 0;
+	}
+	memset(block + ctx->used, 0, SHA256_BLOCK_SIZE - 8 - ctx->used);
+
+	for (i = 0; i < 4; i++) {
+		block[56 + i] = bits_hi >> (24 - i * 8);
+		block[60 + i] = bits_lo >> (24 - i * 8);
+	}
+	sha256_block(ctx->state, block);
+
+	for (i = 0; i < SHA256_DIGEST_SIZE; i++)
+		digest[i] = ctx->state[i / 4] >> (24 - (i % 4) * 8);
+
+	return 0;
+}
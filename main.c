@@ -35,6 +35,8 @@
 #include "act8865.h"
 #include "secure.h"
 #include "sfr_aicredir.h"
+#include "profile.h"
+#include "boot_trace.h"
 
 #ifdef CONFIG_HW_DISPLAY_BANNER
 static void display_banner (void)
@@ -48,8 +50,12 @@ int main(void)
 	struct image_info image;
 	int ret;
 
+	profile_mark("start");
+
 #ifdef CONFIG_HW_INIT
 	hw_init();
+
+	profile_mark("hw init");
 #endif
 
 #if defined(CONFIG_SCLK)
@@ -81,15 +87,19 @@ int main(void)
 	init_load_image(&image);
 
 #if defined(CONFIG_SECURE)
-	image.dest -= sizeof(at91_secure_header_t);
+	image.dest -= AT91_SECURE_HEADER_SIZE;
 #endif
 
 	ret = (*load_image)(&image);
 
 #if defined(CONFIG_SECURE)
+#ifndef CONFIG_SECURE_STREAM
 	if (!ret)
 		ret = secure_check(image.dest);
-	image.dest += sizeof(at91_secure_header_t);
+
+	profile_mark("decrypt");
+#endif
+	image.dest += AT91_SECURE_HEADER_SIZE;
 #endif
 
 	load_image_done(ret);
@@ -98,6 +108,11 @@ int main(void)
 	slowclk_switch_osc32();
 #endif
 
+	profile_mark("jump");
+	profile_show();
+	boot_trace_save();
+	usart_flush();
+
 #if defined(CONFIG_ENTER_NWD)
 	switch_normal_world();
 
@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+
+# Builds an application image for CONFIG_SECURE_GCM:
+#
+#   secure_gcm_image.py .config u-boot.bin u-boot.bin.gcm
+#
+# The cipher key is read from the configuration of at91bootstrap. The
+# image is the header (magic, size, IV and tag), in clear, followed by the
+# application encrypted with AES-GCM. The header but its tag is the
+# additional authenticated data. A new random IV is drawn for each image.
+#
+# Needs the python "cryptography" package.
+
+import os, struct, sys
+
+from cryptography.hazmat.primitives.ciphers.aead import AESGCM
+
+SECURE_MAGIC = 0x0000aa55
+
+def read_key(config):
+	'''
+	the cipher key words from a .config, the AES writes them as they are
+	in the little endian memory.
+	'''
+	values = {}
+	fd = open(config, "r")
+	for line in fd:
+		line = line.strip()
+		if line.startswith("CONFIG_") and "=" in line:
+			name, value = line.split("=", 1)
+			values[name] = value.strip('"')
+	fd.close()
+
+	if values.get("CONFIG_AES_KEY_SIZE_128") == "y":
+		num_words = 4
+	elif values.get("CONFIG_AES_KEY_SIZE_192") == "y":
+		num_words = 6
+	elif values.get("CONFIG_AES_KEY_SIZE_256") == "y":
+		num_words = 8
+	else:
+		sys.exit("No AES key size in %s" % config)
+
+	words = []
+	for i in range(0, num_words):
+		name = "CONFIG_AES_CIPHER_KEY_WORD%d" % i
+		if name not in values:
+			sys.exit("No %s in %s" % (name, config))
+		words.append(int(values[name], 16))
+
+	return struct.pack("<%dI" % num_words, *words)
+
+def gcm_image(key, data, iv):
+	# magic, file_size, reserved[2], iv[3], reserved2
+	aad = struct.pack("<II8x", SECURE_MAGIC, len(data)) + iv + struct.pack("<4x")
+
+	sealed = AESGCM(key).encrypt(iv, data, aad)
+
+	# the tag is at the end of the sealed data, it goes in the header
+	return aad + sealed[-16:] + sealed[:-16]
+
+if len(sys.argv) != 4:
+	sys.exit("usage: %s <.config> <application> <image>" % sys.argv[0])
+
+key = read_key(sys.argv[1])
+
+fd = open(sys.argv[2], "rb")
+data = fd.read()
+fd.close()
+
+if not data:
+	sys.exit("Empty application")
+
+fd = open(sys.argv[3], "wb")
+fd.write(gcm_image(key, data, os.urandom(12)))
+fd.close()
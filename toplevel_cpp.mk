@@ -19,6 +19,23 @@ ifeq ($(CONFIG_DEBUG),y)
 CPPFLAGS += -DCONFIG_DEBUG
 endif
 
+ifeq ($(CONFIG_USART_BUFFERED),y)
+CPPFLAGS += -DCONFIG_USART_BUFFERED
+CPPFLAGS += -DUSART_BUFFER_SIZE=$(CONFIG_USART_BUFFER_SIZE)
+endif
+
+ifeq ($(CONFIG_BOOT_PROFILE),y)
+CPPFLAGS += -DCONFIG_BOOT_PROFILE
+endif
+
+BOOT_TRACE_ADDR := $(strip $(subst ",,$(CONFIG_BOOT_TRACE_ADDR)))
+ifeq ($(CONFIG_BOOT_TRACE),y)
+CPPFLAGS += -DCONFIG_BOOT_TRACE
+ifneq ($(BOOT_TRACE_ADDR),)
+CPPFLAGS += -DBOOT_TRACE_ADDR=$(BOOT_TRACE_ADDR)
+endif
+endif
+
 ifeq ($(CONFIG_HW_DISPLAY_BANNER),y)
 BANNER:="$(CONFIG_HW_BANNER)"
 CPPFLAGS += -DBANNER="$(BANNER)"